@@ -0,0 +1,30 @@
+#pragma once
+
+#ifndef MU_CPU_H
+#define MU_CPU_H
+
+
+/**
+ * @class MU_Cpu
+ * @brief The vector instruction sets of the CPU the program runs on.
+ *
+ * Found once, the first time level() is asked.  AVX and AVX2 are only
+ * reported if the operating system also saves the ymm registers.  The code
+ * with vector kernels (MU_CharSet, MU_Tolerance) starts from this level and
+ * keeps its own choice, so one of them can be held lower to compare speeds
+ * without changing the others.
+ */
+class MU_Cpu
+{
+public:
+   //! instruction sets, each one has all of those before it
+   enum Level { LEVEL_SCALAR, LEVEL_SSE2, LEVEL_AVX, LEVEL_AVX2 };
+
+   //! the best instruction set the CPU has
+   static Level level();
+
+   //! name of an instruction set: "scalar", "SSE2", "AVX" or "AVX2"
+   static const char* levelName(Level aLevel);
+};
+
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#ifndef MU_HASH_H
+#define MU_HASH_H
+
+
+#include <stddef.h>
+#include <ctype.h>
+
+
+/**
+ * @class MU_Hash
+ * @brief Small, fast 64-bit hashes for hash tables and fingerprints.
+ *
+ * Characters are hashed with FNV-1a, one byte at a time, so a hash can be
+ * built up piece by piece (and folded to lower case as it goes) without
+ * copying the characters anywhere first.  Mix() stirs all 64 bits of a value
+ * and is used to combine hashes.  These are not cryptographic hashes.
+ */
+class MU_Hash
+{
+public:
+   //! hash of no characters, to start from
+   static const unsigned long long Start = 14695981039346656037ULL;
+
+   //! add one character to the hash
+   static unsigned long long AddByte(unsigned long long hash, unsigned char c)
+   {
+      return (hash ^ c) * 1099511628211ULL;
+   }
+
+   //! add n characters to the hash
+   static unsigned long long AddChars(unsigned long long hash, const char* p, size_t n)
+   {
+      for (size_t i = 0; i < n; ++i)
+         hash = AddByte(hash, static_cast<unsigned char>(p[i]));
+      return hash;
+   }
+
+   //! add the characters of a null-terminated string to the hash, folded to lower case
+   static unsigned long long AddLower(unsigned long long hash, const char* p)
+   {
+      for (; *p; ++p)
+         hash = AddByte(hash, static_cast<unsigned char>(tolower(static_cast<unsigned char>(*p))));
+      return hash;
+   }
+
+   //! hash of a null-terminated string
+   static unsigned long long String(const char* p)
+   {
+      unsigned long long hash = Start;
+      for (; *p; ++p)
+         hash = AddByte(hash, static_cast<unsigned char>(*p));
+      return hash;
+   }
+
+   //! stir all 64 bits of h (the splitmix64 finalizer)
+   static unsigned long long Mix(unsigned long long h)
+   {
+      h ^= h >> 30;
+      h *= 0xBF58476D1CE4E5B9ULL;
+      h ^= h >> 27;
+      h *= 0x94D049BB133111EBULL;
+      h ^= h >> 31;
+      return h;
+   }
+};
+
+#endif
@@ -0,0 +1,97 @@
+#pragma once
+
+#ifndef MU_RUN_STATS_H
+#define MU_RUN_STATS_H
+
+
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+/**
+ * @class MU_RunStats
+ * @brief Where a run spent its time and memory, for the --stats report.
+ *
+ * A program adds the wall clock and CPU time of each phase of its work
+ * (load, parse, compare, ...), counts of what it did, and the counts of the
+ * memory pools of its documents.  write() reports them with the totals for the
+ * whole run and the peak resident memory of the process, as text lines or as
+ * one JSON object.
+ *
+ * The CPU time is that of the whole process, so a phase run on several threads
+ * shows more CPU than wall time.  Phases added from more than one thread at
+ * once (--batch --jobs) overlap, and their sum can be more than the total.
+ * All of the add functions may be called from any thread.
+ */
+class MU_RunStats
+{
+public:
+   //! the wall clock and process CPU time at one moment, in seconds
+   struct Times
+   {
+      double wall;
+      double cpu;
+   };
+
+   //! the times now
+   static Times now();
+
+   //! the most memory the process has had resident so far, in bytes (0 if not known)
+   static unsigned long long peakResidentBytes();
+
+   //! the run starts now
+   MU_RunStats();
+
+   //! add the time from 'start' until now to a phase.  Returns the times now, to start the next phase from
+   Times addPhase(const char* name, const Times& start);
+
+   //! add to a count.  With 'ratePhase' the count is also given per second of that phase ("" for the whole run)
+   void addCount(const char* name, unsigned long long n, const char* ratePhase = 0);
+
+   //! add a memory pool of one more document: the watermarks are the largest of the documents, the rest are added up
+   void addPool(const char* name, int itemSize, int watermark, int blocks, int blockItems, int allocs);
+
+   //! write the report, as text or as one JSON object
+   void write(std::ostream& out, bool json) const;
+
+private:
+   struct Phase
+   {
+      std::string name;
+      double wall;
+      double cpu;
+   };
+   struct Count
+   {
+      std::string name;
+      unsigned long long value;
+      std::string ratePhase;
+      bool rate;
+   };
+   struct Pool
+   {
+      std::string name;
+      unsigned int documents;
+      int itemSize;
+      int watermark;
+      unsigned long long blocks;
+      unsigned long long blockBytes;
+      unsigned long long allocs;
+   };
+
+   MU_RunStats(const MU_RunStats&);        // not supported
+   void operator=(const MU_RunStats&);     // not supported
+
+   //! seconds of wall clock time of a phase, or of the whole run for ""
+   double phaseWall(const std::string& name, const Times& end) const;
+
+   Times mStart;
+   mutable std::mutex mLock;
+   std::vector<Phase> mPhases;
+   std::vector<Count> mCounts;
+   std::vector<Pool> mPools;
+};
+
+#endif
@@ -27,6 +27,21 @@ class MU_StringUtil
 {
 public:
 
+   //! status returned by the number parsing functions
+   enum NumberStatus
+   {
+      NUMBER_OK,              //!< a number was read
+      NUMBER_INVALID,         //!< the text does not start with a number
+      NUMBER_OUT_OF_RANGE     //!< the number is too large to fit in a double
+   };
+
+   //! result of FromChars(): where the number ended and if it could be read
+   struct NumberResult
+   {
+      const char*  ptr;       //!< first character after the number (first if no number)
+      NumberStatus status;
+   };
+
    MU_StringUtil();
    ~MU_StringUtil();
 
@@ -92,6 +107,30 @@ public:
    static double      ToDouble(const std::string& aString);
    //! Like ToDouble() except it throws a BadConversion exception if aString is not a valid number
    static double      ToDoubleEx(const std::string& aString);
+   //! Like ToDoubleEx() except it returns false instead of throwing if aString is not a valid number
+   /**
+    * Leading white space is skipped and anything after the number is ignored, the
+    * same as reading the number with an input stream.  Nothing is allocated.
+    * @return true if a number was read into aValue
+    */
+   static bool        TryToDouble(const char* aString, double& aValue);
+   static bool        TryToDouble(const std::string& aString, double& aValue)
+      { return TryToDouble(aString.data(), aString.data() + aString.size(), aValue); }
+   //! Like TryToDouble() but reads the characters [first,last), which need not be null terminated
+   static bool        TryToDouble(const char* first, const char* last, double& aValue);
+   //! Read a decimal number from the start of the characters [first,last) in the style of std::from_chars
+   /**
+    * Reads an optional sign, digits with an optional decimal point, and an optional
+    * exponent ('e' or 'E', optional sign, digits).  White space is not skipped and
+    * hex, "inf" and "nan" are not numbers.  Does not throw or allocate memory.
+    * Numbers with up to 19 significant digits and a small exponent are converted
+    * exactly with one multiply or divide; anything else is handed to strtod().
+    * @param first start of the characters to read
+    * @param last one past the end of the characters to read
+    * @param aValue the number read, unchanged if the status is NUMBER_INVALID
+    * @return where the number ended and NUMBER_OK, NUMBER_INVALID or NUMBER_OUT_OF_RANGE
+    */
+   static NumberResult FromChars(const char* first, const char* last, double& aValue);
    static int         ToInt(const std::string& aString);
 
 
@@ -0,0 +1,198 @@
+#pragma once
+
+#ifndef MU_STRING_VIEW_H
+#define MU_STRING_VIEW_H
+
+
+#include <string>
+#include <stddef.h>
+#include <ctype.h>
+#include <string.h>
+
+
+/**
+ * @class MU_StringView
+ * @brief A pointer and length into characters owned by someone else.
+ *
+ * Used to pass around pieces of a larger string (such as the tokens of an
+ * attribute value in a tinyxml2 buffer) without copying them.  The characters
+ * must stay in place as long as the view is used.  The view is not null
+ * terminated.
+ */
+class MU_StringView
+{
+public:
+   MU_StringView() : mData(""), mSize(0) {}
+   MU_StringView(const char* aData, size_t aSize) : mData(aData), mSize(aSize) {}
+
+   const char* data() const { return mData; }
+   size_t      size() const { return mSize; }
+   bool        empty() const { return mSize == 0; }
+   const char* begin() const { return mData; }
+   const char* end() const { return mData + mSize; }
+
+   //! copy of the characters as a std::string
+   std::string str() const { return std::string(mData, mSize); }
+
+   //! case-sensitive compare, true if equal
+   bool equals(const MU_StringView& p) const
+   {
+      return mSize == p.mSize && memcmp(mData, p.mData, mSize) == 0;
+   }
+
+   //! case-insensitive compare, true if equal
+   bool equalsNoCase(const MU_StringView& p) const
+   {
+      if (mSize != p.mSize)
+         return false;
+      for (size_t i = 0; i < mSize; ++i)
+      {
+         if (tolower(static_cast<unsigned char>(mData[i])) != tolower(static_cast<unsigned char>(p.mData[i])))
+            return false;
+      }
+      return true;
+   }
+
+private:
+   const char* mData;
+   size_t      mSize;
+};
+
+
+
+/**
+ * @class MU_CharSet
+ * @brief A set of characters that can be checked with one table lookup.
+ *
+ * Built once from a string of characters (such as the delimiters to split
+ * text on) and then used for every character tested.
+ *
+ * classify() tests a block of up to 64 characters at once and returns a bit
+ * mask of the ones in the set.  When the set has at most MaxVectorChars
+ * characters it compares 16 (SSE2) or 32 (AVX2) bytes per instruction, using
+ * the best instruction set the CPU has (see MU_Cpu).  Otherwise, or on other
+ * CPUs, it uses the table.
+ */
+class MU_CharSet
+{
+public:
+   //! instruction sets classify() can use
+   enum ScanLevel { SCAN_SCALAR, SCAN_SSE2, SCAN_AVX2 };
+
+   //! largest set that is searched with vector instructions
+   static const size_t MaxVectorChars = 16;
+
+   MU_CharSet() : mCount(0) { memset(mTable, 0, sizeof(mTable)); }
+
+   //! set holding each of the characters in aChars
+   MU_CharSet(const std::string& aChars);
+
+   bool contains(char c) const { return mTable[static_cast<unsigned char>(c)]; }
+
+   //! bit i of the result is set if p[i] is in the set, for i < n (n at most 64).
+   //! Bits n and above are set as well, as if the block ended with the set's characters
+   unsigned long long classify(const char* p, size_t n) const;
+
+   //! the instruction set currently used by classify()
+   static ScanLevel scanLevel();
+   //! use a lower instruction set than the CPU supports (e.g. to compare speeds).
+   //! Returns the level actually set, which is never above what the CPU has.
+   //! Only classify() is changed, MU_Tolerance has a level of its own
+   static ScanLevel setScanLevel(ScanLevel aLevel);
+   //! name of an instruction set: "scalar", "SSE2" or "AVX2"
+   static const char* scanLevelName(ScanLevel aLevel);
+
+private:
+   bool   mTable[256];
+   char   mChars[MaxVectorChars];  //!< the distinct characters, if there are no more than MaxVectorChars
+   size_t mCount;                  //!< number of distinct characters
+};
+
+
+
+/**
+ * @class MU_Tokenizer
+ * @brief Splits a string into tokens without copying it.
+ *
+ * Gives the same tokens as MU_StringUtil::Tokenize(): delimiters at the start,
+ * at the end, and several in a row are all skipped.  Each token is a view into
+ * the original string, so nothing is allocated.  The delimiter set is not
+ * copied and must outlive the tokenizer.
+ *
+ * The string is looked at 64 characters at a time: MU_CharSet::classify() gives
+ * a bit mask of the delimiters in the block, and the start and end of each
+ * token are found from the mask with bit operations.
+ * Example:
+ *    MU_CharSet delims(", ");
+ *    MU_Tokenizer tok(text, delims);
+ *    MU_StringView token;
+ *    while (tok.next(token)) ...
+ */
+class MU_Tokenizer
+{
+public:
+   //! tokenize a null-terminated string
+   MU_Tokenizer(const char* aStr, const MU_CharSet& aDelimiters)
+      : mEnd((aStr ? aStr : "") + (aStr ? strlen(aStr) : 0)), mDelimiters(aDelimiters),
+        mBlock(aStr ? aStr : ""), mMask(0), mLength(0), mIndex(0) {}
+   //! tokenize the characters [first,last)
+   MU_Tokenizer(const char* first, const char* last, const MU_CharSet& aDelimiters)
+      : mEnd(last), mDelimiters(aDelimiters), mBlock(first), mMask(0), mLength(0), mIndex(0) {}
+
+   //! get the next token.  Returns false when there are no more
+   bool next(MU_StringView& token);
+
+   //! count the tokens that are left (uses them up)
+   unsigned int countRemaining()
+   {
+      unsigned int count = 0;
+      MU_StringView token;
+      while (next(token))
+         ++count;
+      return count;
+   }
+
+private:
+   //! move on to the next block of characters.  Returns false at the end of the string
+   bool nextBlock();
+
+   const char*        mEnd;
+   const MU_CharSet&  mDelimiters;
+   const char*        mBlock;     //!< start of the block being looked at
+   unsigned long long mMask;      //!< delimiter bits of the block, from MU_CharSet::classify()
+   size_t             mLength;    //!< number of characters in the block (at most 64)
+   size_t             mIndex;     //!< next character in the block to look at
+};
+
+
+
+/**
+ * @class MU_LineWrapper
+ * @brief Breaks text into lines of at most a given width without copying it.
+ *
+ * Gives the same lines as MU_StringUtil::WrapTextHard(): a line ends at the
+ * last space that fits (the space itself is dropped), and a word longer than
+ * the width is cut at the width.  Each line is a view into the text, so the
+ * caller can write it wherever it likes without a list of copies.
+ * Example:
+ *    MU_LineWrapper wrap(text.data(), text.size(), 80);
+ *    MU_StringView line;
+ *    while (wrap.next(line)) ...
+ */
+class MU_LineWrapper
+{
+public:
+   //! wrap the characters [aText,aText+aSize) to lines of at most aWidth (at least 1)
+   MU_LineWrapper(const char* aText, size_t aSize, size_t aWidth)
+      : mNext(aText), mEnd(aText + aSize), mWidth(aWidth > 0 ? aWidth : 1) {}
+
+   //! get the next line.  Returns false when there are no more
+   bool next(MU_StringView& line);
+
+private:
+   const char* mNext;     //!< start of the next line
+   const char* mEnd;
+   size_t      mWidth;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+#ifndef MU_TOLERANCE_H
+#define MU_TOLERANCE_H
+
+
+#include <stddef.h>
+
+#include "MU_Cpu.h"
+
+
+/**
+ * @class MU_Tolerance
+ * @brief Decides if two numbers are close enough to be called the same.
+ *
+ * Two numbers a and b are the same if any one of these holds:
+ *  - absolute: |a-b| <= absolute
+ *  - relative: |a-b| <= relative * max(|a|,|b|)
+ *  - ULP:      there are no more than 'ulps' doubles between a and b
+ * A tolerance of 0 turns that test off (except absolute 0, which still lets
+ * equal numbers through).
+ *
+ * compare() checks whole arrays at once.  The absolute and relative tests are
+ * done 2 (SSE2) or 4 (AVX) numbers at a time, using the best instruction set
+ * the CPU has (see MU_Cpu) unless setLevel() asks for a lower one; the ULP test
+ * is only needed for the few pairs that fail both and is done one at a time.
+ */
+class MU_Tolerance
+{
+public:
+   MU_Tolerance(double aAbsolute = 0.0, double aRelative = 0.0, unsigned long long aUlps = 0)
+      : absolute(aAbsolute), relative(aRelative), ulps(aUlps) {}
+
+   //! true if a and b are not within the tolerance
+   bool differ(double a, double b) const;
+
+   //! compare a[i] with b[i] for i < n
+   /**
+    * @param a first array of numbers
+    * @param b second array of numbers
+    * @param n number of pairs
+    * @param differIndex gets the index of each pair that differs, in order (room for n entries)
+    * @return the number of pairs that differ
+    */
+   size_t compare(const double* a, const double* b, size_t n, size_t* differIndex) const;
+
+   //! number of doubles between a and b (0 if equal, counting +0 and -0 as equal)
+   static unsigned long long ulpDistance(double a, double b);
+
+   //! the instruction set currently used by compare(): scalar, SSE2 or AVX
+   static MU_Cpu::Level level();
+   //! use a lower instruction set than the CPU supports (e.g. to compare speeds).
+   //! Returns the level actually set, which is never above what the CPU has or AVX
+   static MU_Cpu::Level setLevel(MU_Cpu::Level aLevel);
+
+   double             absolute;    //!< largest absolute difference that is the same
+   double             relative;    //!< largest difference relative to the larger magnitude
+   unsigned long long ulps;        //!< largest distance in units in the last place
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include "MU_Cpu.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MU_CPU_X86 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+
+namespace
+{
+   MU_Cpu::Level DetectLevel()
+   {
+#ifdef MU_CPU_X86
+      unsigned long long xcr0 = 0;
+#ifdef _MSC_VER
+      int info[4] = { 0, 0, 0, 0 };
+      __cpuid(info, 0);
+      const int maxLeaf = info[0];
+      __cpuid(info, 1);
+      const bool sse2 = (info[3] & (1 << 26)) != 0;
+      const bool osxsave = (info[2] & (1 << 27)) != 0;
+      const bool avx = (info[2] & (1 << 28)) != 0;
+      if (osxsave)
+         xcr0 = _xgetbv(0);
+      bool avx2 = false;
+      if (maxLeaf >= 7)
+      {
+         __cpuidex(info, 7, 0);
+         avx2 = (info[1] & (1 << 5)) != 0;
+      }
+#else
+      unsigned int a, b, c, d;
+      __cpuid(1, a, b, c, d);
+      const bool sse2 = (d & (1 << 26)) != 0;
+      const bool osxsave = (c & (1 << 27)) != 0;
+      const bool avx = (c & (1 << 28)) != 0;
+      if (osxsave)
+      {
+         unsigned int lo, hi;
+         __asm__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+         xcr0 = (static_cast<unsigned long long>(hi) << 32) | lo;
+      }
+      bool avx2 = false;
+      if (__get_cpuid_max(0, 0) >= 7)
+      {
+         __cpuid_count(7, 0, a, b, c, d);
+         avx2 = (b & (1 << 5)) != 0;
+      }
+#endif
+      // the AVX sets also need the operating system to save the ymm registers
+      const bool ymm = osxsave && (xcr0 & 6) == 6;
+      if (avx && avx2 && ymm)
+         return MU_Cpu::LEVEL_AVX2;
+      if (avx && ymm)
+         return MU_Cpu::LEVEL_AVX;
+      if (sse2)
+         return MU_Cpu::LEVEL_SSE2;
+#endif
+      return MU_Cpu::LEVEL_SCALAR;
+   }
+}
+
+
+
+
+// static
+MU_Cpu::Level MU_Cpu::level()
+{
+   static const Level cpuLevel = DetectLevel();
+   return cpuLevel;
+}
+
+
+
+
+// static
+const char* MU_Cpu::levelName(Level aLevel)
+{
+   switch (aLevel)
+   {
+   case LEVEL_AVX2: return "AVX2";
+   case LEVEL_AVX:  return "AVX";
+   case LEVEL_SSE2: return "SSE2";
+   default:         return "scalar";
+   }
+}
@@ -0,0 +1,271 @@
+#include "MU_RunStats.h"
+
+#include <chrono>
+#include <iomanip>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+
+namespace
+{
+   const std::chrono::steady_clock::time_point ClockStart = std::chrono::steady_clock::now();
+
+#ifdef _WIN32
+   // a FILETIME of 100 ns ticks in seconds
+   double FileTimeSeconds(const FILETIME& t)
+   {
+      ULARGE_INTEGER ticks;
+      ticks.LowPart = t.dwLowDateTime;
+      ticks.HighPart = t.dwHighDateTime;
+      return ticks.QuadPart * 1.0e-7;
+   }
+#endif
+
+
+   // the seconds as a number with a fixed number of decimals
+   void WriteSeconds(std::ostream& out, double seconds, int width)
+   {
+      out << std::setw(width) << std::fixed << std::setprecision(3) << seconds;
+   }
+}
+
+
+
+
+MU_RunStats::Times MU_RunStats::now()
+{
+   Times times;
+   times.wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - ClockStart).count();
+   times.cpu = 0.0;
+#ifdef _WIN32
+   FILETIME created, exited, kernel, user;
+   if (GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+      times.cpu = FileTimeSeconds(kernel) + FileTimeSeconds(user);
+#else
+   struct rusage usage;
+   if (getrusage(RUSAGE_SELF, &usage) == 0)
+   {
+      times.cpu = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1.0e-6;
+   }
+#endif
+   return times;
+}
+
+
+
+
+unsigned long long MU_RunStats::peakResidentBytes()
+{
+#ifdef _WIN32
+   PROCESS_MEMORY_COUNTERS counters;
+   if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+      return counters.PeakWorkingSetSize;
+   return 0;
+#else
+   struct rusage usage;
+   if (getrusage(RUSAGE_SELF, &usage) != 0)
+      return 0;
+#ifdef __APPLE__
+   return static_cast<unsigned long long>(usage.ru_maxrss);          // bytes
+#else
+   return static_cast<unsigned long long>(usage.ru_maxrss) * 1024;   // kilobytes
+#endif
+#endif
+}
+
+
+
+
+MU_RunStats::MU_RunStats()
+   : mStart(now()), mLock(), mPhases(), mCounts(), mPools()
+{
+}
+
+
+
+
+MU_RunStats::Times MU_RunStats::addPhase(const char* name, const Times& start)
+{
+   const Times end = now();
+   std::lock_guard<std::mutex> guard(mLock);
+   size_t i = 0;
+   while (i < mPhases.size() && mPhases[i].name != name)
+      ++i;
+   if (i == mPhases.size())
+   {
+      Phase phase;
+      phase.name = name;
+      phase.wall = 0.0;
+      phase.cpu = 0.0;
+      mPhases.push_back(phase);
+   }
+   mPhases[i].wall += end.wall - start.wall;
+   mPhases[i].cpu += end.cpu - start.cpu;
+   return end;
+}
+
+
+
+
+void MU_RunStats::addCount(const char* name, unsigned long long n, const char* ratePhase)
+{
+   std::lock_guard<std::mutex> guard(mLock);
+   size_t i = 0;
+   while (i < mCounts.size() && mCounts[i].name != name)
+      ++i;
+   if (i == mCounts.size())
+   {
+      Count count;
+      count.name = name;
+      count.value = 0;
+      count.ratePhase = (ratePhase ? ratePhase : "");
+      count.rate = (ratePhase != 0);
+      mCounts.push_back(count);
+   }
+   mCounts[i].value += n;
+}
+
+
+
+
+void MU_RunStats::addPool(const char* name, int itemSize, int watermark, int blocks, int blockItems, int allocs)
+{
+   std::lock_guard<std::mutex> guard(mLock);
+   size_t i = 0;
+   while (i < mPools.size() && mPools[i].name != name)
+      ++i;
+   if (i == mPools.size())
+   {
+      Pool pool;
+      pool.name = name;
+      pool.documents = 0;
+      pool.itemSize = itemSize;
+      pool.watermark = 0;
+      pool.blocks = 0;
+      pool.blockBytes = 0;
+      pool.allocs = 0;
+      mPools.push_back(pool);
+   }
+   Pool& pool = mPools[i];
+   ++pool.documents;
+   if (watermark > pool.watermark)
+      pool.watermark = watermark;
+   pool.blocks += blocks;
+   pool.blockBytes += static_cast<unsigned long long>(blocks) * blockItems * itemSize;
+   pool.allocs += allocs;
+}
+
+
+
+
+double MU_RunStats::phaseWall(const std::string& name, const Times& end) const
+{
+   if (name.empty())
+      return end.wall - mStart.wall;
+   for (size_t i = 0; i < mPhases.size(); ++i)
+   {
+      if (mPhases[i].name == name)
+         return mPhases[i].wall;
+   }
+   return 0.0;
+}
+
+
+
+
+void MU_RunStats::write(std::ostream& out, bool json) const
+{
+   const Times end = now();
+   const unsigned long long peak = peakResidentBytes();
+   std::lock_guard<std::mutex> guard(mLock);
+
+   const std::ios::fmtflags flags = out.flags();
+   const std::streamsize precision = out.precision();
+
+   if (json)
+   {
+      // one object on one line, so a file of runs can be read a line at a time
+      out << std::fixed << std::setprecision(6) << "{\"phases\":[";
+      for (size_t i = 0; i < mPhases.size(); ++i)
+      {
+         out << (i ? "," : "") << "{\"name\":\"" << mPhases[i].name << "\",\"wall\":" << mPhases[i].wall
+            << ",\"cpu\":" << mPhases[i].cpu << "}";
+      }
+      out << "],\"total\":{\"wall\":" << end.wall - mStart.wall << ",\"cpu\":" << end.cpu - mStart.cpu << "},\"counts\":[";
+      for (size_t i = 0; i < mCounts.size(); ++i)
+      {
+         out << (i ? "," : "") << "{\"name\":\"" << mCounts[i].name << "\",\"value\":" << mCounts[i].value;
+         const double seconds = phaseWall(mCounts[i].ratePhase, end);
+         if (mCounts[i].rate && seconds > 0.0)
+            out << ",\"per_second\":" << mCounts[i].value / seconds;
+         out << "}";
+      }
+      out << "],\"pools\":[";
+      for (size_t i = 0; i < mPools.size(); ++i)
+      {
+         const Pool& pool = mPools[i];
+         out << (i ? "," : "") << "{\"name\":\"" << pool.name << "\",\"documents\":" << pool.documents
+            << ",\"item_size\":" << pool.itemSize << ",\"watermark\":" << pool.watermark << ",\"blocks\":" << pool.blocks
+            << ",\"block_bytes\":" << pool.blockBytes << ",\"allocs\":" << pool.allocs << "}";
+      }
+      out << "],\"peak_rss\":" << peak << "}\n";
+   }
+   else
+   {
+      out << "Run statistics:\n"
+         << "   phase               wall (s)     cpu (s)\n";
+      for (size_t i = 0; i < mPhases.size(); ++i)
+      {
+         out << "   " << std::left << std::setw(16) << mPhases[i].name << std::right;
+         WriteSeconds(out, mPhases[i].wall, 12);
+         WriteSeconds(out, mPhases[i].cpu, 12);
+         out << "\n";
+      }
+      out << "   " << std::left << std::setw(16) << "total" << std::right;
+      WriteSeconds(out, end.wall - mStart.wall, 12);
+      WriteSeconds(out, end.cpu - mStart.cpu, 12);
+      out << "\n";
+
+      if (!mCounts.empty())
+         out << "   count                        value      per second\n";
+      for (size_t i = 0; i < mCounts.size(); ++i)
+      {
+         out << "   " << std::left << std::setw(20) << mCounts[i].name << std::right << std::setw(14) << mCounts[i].value;
+         const double seconds = phaseWall(mCounts[i].ratePhase, end);
+         if (mCounts[i].rate && seconds > 0.0)
+            out << std::setw(16) << std::fixed << std::setprecision(0) << mCounts[i].value / seconds;
+         out << "\n";
+      }
+
+      if (!mPools.empty())
+         out << "   pool           docs  item  watermark   watermark KB    blocks   block KB      allocs\n";
+      for (size_t i = 0; i < mPools.size(); ++i)
+      {
+         const Pool& pool = mPools[i];
+         out << "   " << std::left << std::setw(12) << pool.name << std::right << std::setw(7) << pool.documents
+            << std::setw(6) << pool.itemSize << std::setw(11) << pool.watermark
+            << std::setw(15) << static_cast<unsigned long long>(pool.watermark) * pool.itemSize / 1024
+            << std::setw(10) << pool.blocks << std::setw(11) << pool.blockBytes / 1024 << std::setw(12) << pool.allocs << "\n";
+      }
+
+      if (peak > 0)
+         out << "   peak resident memory " << std::fixed << std::setprecision(1) << peak / (1024.0 * 1024.0) << " MB\n";
+   }
+
+   out.flags(flags);
+   out.precision(precision);
+}
@@ -1,6 +1,9 @@
 
 #include "MU_StringUtil.h"
 #include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
 #include <algorithm>
 #include <strstream>
 
@@ -358,13 +361,162 @@ double MU_StringUtil::ToDouble(const std::string& aString)
 double MU_StringUtil::ToDoubleEx(const std::string& aString)
 {
    double value = 0.0;
-   istrstream iss(aString.c_str());
-   // iss >> value;
-   if (!(iss >> value))
+   if (!TryToDouble(aString, value))
       throw BadConversion("ToDouble(\"" + aString + "\")");
    return value;
 }
 
+// static
+bool MU_StringUtil::TryToDouble(const char* aString, double& aValue)
+{
+   return TryToDouble(aString, aString + strlen(aString), aValue);
+}
+
+// static
+bool MU_StringUtil::TryToDouble(const char* first, const char* last, double& aValue)
+{
+   const char* p = first;
+   while (p != last && isspace(static_cast<unsigned char>(*p)))
+      ++p;
+
+   double value = 0.0;
+   if (FromChars(p, last, value).status != NUMBER_OK)
+      return false;
+   aValue = value;
+   return true;
+}
+
+namespace
+{
+   inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+   // powers of ten that are exact in a double
+   const double ExactPow10[] =
+   {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+      1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+   };
+   const int MaxExactPow10 = 22;
+   const unsigned long long MaxExactMantissa = 1ULL << 53;
+   const int MaxMantissaDigits = 19;
+}
+
+// static
+MU_StringUtil::NumberResult MU_StringUtil::FromChars(const char* first, const char* last, double& aValue)
+{
+   NumberResult result = { first, NUMBER_INVALID };
+   const char* p = first;
+
+   bool negative = false;
+   if (p != last && (*p == '-' || *p == '+'))
+   {
+      negative = (*p == '-');
+      ++p;
+   }
+
+   // collect up to MaxMantissaDigits significant digits, any more only move the exponent
+   unsigned long long mantissa = 0;
+   int nDigits = 0;              // significant digits in mantissa
+   int exponent = 0;             // value is mantissa * 10^exponent
+   bool anyDigits = false;
+   bool inexact = false;         // non-zero digits were dropped from mantissa
+   for (; p != last && IsDigit(*p); ++p)
+   {
+      anyDigits = true;
+      if (nDigits < MaxMantissaDigits)
+      {
+         mantissa = mantissa * 10 + (*p - '0');
+         if (mantissa)
+            ++nDigits;
+      }
+      else
+      {
+         ++exponent;
+         inexact |= (*p != '0');
+      }
+   }
+   if (p != last && *p == '.')
+   {
+      for (++p; p != last && IsDigit(*p); ++p)
+      {
+         anyDigits = true;
+         if (nDigits < MaxMantissaDigits)
+         {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa)
+               ++nDigits;
+            --exponent;
+         }
+         else
+         {
+            inexact |= (*p != '0');
+         }
+      }
+   }
+   if (!anyDigits)
+      return result;
+
+   // the exponent only counts if it has digits, otherwise the number ends before the 'e'
+   if (p != last && (*p == 'e' || *p == 'E'))
+   {
+      const char* e = p + 1;
+      bool expNegative = false;
+      if (e != last && (*e == '-' || *e == '+'))
+      {
+         expNegative = (*e == '-');
+         ++e;
+      }
+      if (e != last && IsDigit(*e))
+      {
+         int expValue = 0;
+         for (; e != last && IsDigit(*e); ++e)
+         {
+            if (expValue < 100000)
+               expValue = expValue * 10 + (*e - '0');
+         }
+         exponent += (expNegative ? -expValue : expValue);
+         p = e;
+      }
+   }
+   result.ptr = p;
+   result.status = NUMBER_OK;
+
+   // fast path: mantissa and power of ten are both exact so one operation rounds correctly
+   if (!inexact && mantissa <= MaxExactMantissa && exponent >= -MaxExactPow10 && exponent <= MaxExactPow10)
+   {
+      double value = static_cast<double>(mantissa);
+      if (exponent < 0)
+         value /= ExactPow10[-exponent];
+      else
+         value *= ExactPow10[exponent];
+      aValue = (negative ? -value : value);
+      return result;
+   }
+
+   // slow path: strtod needs a terminated copy of just the number
+   char buffer[128];
+   std::string longNumber;
+   const char* text = buffer;
+   size_t length = p - first;
+   if (length < sizeof(buffer))
+   {
+      memcpy(buffer, first, length);
+      buffer[length] = 0;
+   }
+   else
+   {
+      longNumber.assign(first, length);
+      text = longNumber.c_str();
+   }
+
+   errno = 0;
+   double value = strtod(text, nullptr);
+   if (errno == ERANGE && (value == HUGE_VAL || value == -HUGE_VAL))
+      result.status = NUMBER_OUT_OF_RANGE;
+   aValue = value;
+   return result;
+}
+
 int MU_StringUtil::ToInt(const std::string& aString)
 {
    int value = 0;
@@ -0,0 +1,278 @@
+#include "MU_StringView.h"
+#include "MU_Cpu.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MU_CHARSET_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// gcc and clang only allow the intrinsics in functions built for that instruction set,
+// Visual Studio allows them anywhere
+#if defined(MU_CHARSET_X86) && !defined(_MSC_VER)
+#define MU_TARGET_SSE2 __attribute__((target("sse2")))
+#define MU_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MU_TARGET_SSE2
+#define MU_TARGET_AVX2
+#endif
+
+
+namespace
+{
+   // what the CPU can do, found when the program starts
+   MU_CharSet::ScanLevel DetectScanLevel()
+   {
+      const MU_Cpu::Level level = MU_Cpu::level();
+      if (level >= MU_Cpu::LEVEL_AVX2)
+         return MU_CharSet::SCAN_AVX2;
+      if (level >= MU_Cpu::LEVEL_SSE2)
+         return MU_CharSet::SCAN_SSE2;
+      return MU_CharSet::SCAN_SCALAR;
+   }
+
+   const MU_CharSet::ScanLevel CpuScanLevel = DetectScanLevel();
+   MU_CharSet::ScanLevel CurrentScanLevel = CpuScanLevel;
+
+
+   // index of the lowest set bit, mask must not be 0
+   inline unsigned int LowestBit(unsigned long long mask)
+   {
+#if defined(_MSC_VER) && defined(_M_X64)
+      unsigned long index;
+      _BitScanForward64(&index, mask);
+      return index;
+#elif defined(_MSC_VER)
+      unsigned long index;
+      if (_BitScanForward(&index, static_cast<unsigned long>(mask)))
+         return index;
+      _BitScanForward(&index, static_cast<unsigned long>(mask >> 32));
+      return index + 32;
+#else
+      return __builtin_ctzll(mask);
+#endif
+   }
+
+
+   unsigned long long ClassifyScalar(const bool* table, const char* p, size_t n)
+   {
+      unsigned long long mask = (n < 64 ? ~0ULL << n : 0);
+      for (size_t i = 0; i < n; ++i)
+      {
+         if (table[static_cast<unsigned char>(p[i])])
+            mask |= 1ULL << i;
+      }
+      return mask;
+   }
+
+
+#ifdef MU_CHARSET_X86
+   // compare 16 bytes at a time against every character in the set, for a full block of 64
+   MU_TARGET_SSE2
+   unsigned long long ClassifySse2(const char* chars, size_t count, const char* p)
+   {
+      __m128i pattern[MU_CharSet::MaxVectorChars];
+      for (size_t i = 0; i < count; ++i)
+         pattern[i] = _mm_set1_epi8(chars[i]);
+
+      unsigned long long mask = 0;
+      for (int part = 0; part < 4; ++part)
+      {
+         __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * part));
+         __m128i hit = _mm_setzero_si128();
+         for (size_t i = 0; i < count; ++i)
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(block, pattern[i]));
+         mask |= static_cast<unsigned long long>(static_cast<unsigned int>(_mm_movemask_epi8(hit))) << (16 * part);
+      }
+      return mask;
+   }
+
+
+   // same as ClassifySse2() with 32 bytes at a time
+   MU_TARGET_AVX2
+   unsigned long long ClassifyAvx2(const char* chars, size_t count, const char* p)
+   {
+      __m256i pattern[MU_CharSet::MaxVectorChars];
+      for (size_t i = 0; i < count; ++i)
+         pattern[i] = _mm256_set1_epi8(chars[i]);
+
+      __m256i block0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+      __m256i block1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+      __m256i hit0 = _mm256_setzero_si256();
+      __m256i hit1 = _mm256_setzero_si256();
+      for (size_t i = 0; i < count; ++i)
+      {
+         hit0 = _mm256_or_si256(hit0, _mm256_cmpeq_epi8(block0, pattern[i]));
+         hit1 = _mm256_or_si256(hit1, _mm256_cmpeq_epi8(block1, pattern[i]));
+      }
+      unsigned long long low = static_cast<unsigned int>(_mm256_movemask_epi8(hit0));
+      unsigned long long high = static_cast<unsigned int>(_mm256_movemask_epi8(hit1));
+      return low | (high << 32);
+   }
+#endif
+}
+
+
+
+
+MU_CharSet::MU_CharSet(const std::string& aChars)
+   : mCount(0)
+{
+   memset(mTable, 0, sizeof(mTable));
+   for (size_t i = 0; i < aChars.size(); ++i)
+   {
+      unsigned char c = static_cast<unsigned char>(aChars[i]);
+      if (!mTable[c])
+      {
+         mTable[c] = true;
+         if (mCount < MaxVectorChars)
+            mChars[mCount] = aChars[i];
+         ++mCount;
+      }
+   }
+}
+
+
+
+
+unsigned long long MU_CharSet::classify(const char* p, size_t n) const
+{
+#ifdef MU_CHARSET_X86
+   // partial blocks only happen at the end of a string, so they are left to the table
+   if (n == 64 && mCount > 0 && mCount <= MaxVectorChars)
+   {
+      if (CurrentScanLevel == SCAN_AVX2)
+         return ClassifyAvx2(mChars, mCount, p);
+      if (CurrentScanLevel == SCAN_SSE2)
+         return ClassifySse2(mChars, mCount, p);
+   }
+#endif
+   return ClassifyScalar(mTable, p, n);
+}
+
+
+
+
+// static
+MU_CharSet::ScanLevel MU_CharSet::scanLevel()
+{
+   return CurrentScanLevel;
+}
+
+
+
+
+// static
+MU_CharSet::ScanLevel MU_CharSet::setScanLevel(ScanLevel aLevel)
+{
+   CurrentScanLevel = (aLevel < CpuScanLevel ? aLevel : CpuScanLevel);
+   return CurrentScanLevel;
+}
+
+
+
+
+// static
+const char* MU_CharSet::scanLevelName(ScanLevel aLevel)
+{
+   switch (aLevel)
+   {
+   case SCAN_AVX2: return "AVX2";
+   case SCAN_SSE2: return "SSE2";
+   default:        return "scalar";
+   }
+}
+
+
+
+
+bool MU_Tokenizer::nextBlock()
+{
+   mBlock += mLength;
+   mIndex = 0;
+   mLength = mEnd - mBlock;
+   if (mLength == 0)
+      return false;
+   if (mLength > 64)
+      mLength = 64;
+   mMask = mDelimiters.classify(mBlock, mLength);
+   return true;
+}
+
+
+
+
+bool MU_Tokenizer::next(MU_StringView& token)
+{
+   // skip delimiters: look for the first clear bit at or after mIndex
+   for (;;)
+   {
+      if (mIndex < mLength)
+      {
+         unsigned long long bits = ~mMask & (~0ULL << mIndex);
+         if (bits)
+         {
+            mIndex = LowestBit(bits);
+            break;
+         }
+      }
+      if (!nextBlock())
+         return false;
+   }
+   const char* start = mBlock + mIndex;
+
+   // find the end of the token: the first set bit after it, which may be in a later block
+   for (;;)
+   {
+      unsigned long long bits = mMask & (~0ULL << mIndex);
+      if (bits)
+      {
+         size_t index = LowestBit(bits);
+         if (index < mLength)
+         {
+            mIndex = index;
+            break;
+         }
+      }
+      if (!nextBlock())
+         break;      // token runs to the end of the string (mBlock is now the end)
+   }
+
+   token = MU_StringView(start, mBlock + mIndex - start);
+   return true;
+}
+
+
+
+
+bool MU_LineWrapper::next(MU_StringView& line)
+{
+   size_t left = mEnd - mNext;
+   if (left == 0)
+      return false;
+
+   if (left <= mWidth)
+   {
+      line = MU_StringView(mNext, left);
+      mNext = mEnd;
+      return true;
+   }
+
+   // the last space in the first width+1 characters, so a line of exactly width still fits
+   size_t space = mWidth + 1;
+   while (space > 0 && mNext[space - 1] != ' ')
+      --space;
+   if (space == 0)
+   {
+      line = MU_StringView(mNext, mWidth);
+      mNext += mWidth;
+   }
+   else
+   {
+      line = MU_StringView(mNext, space - 1);
+      mNext += space;
+   }
+   return true;
+}
@@ -0,0 +1,177 @@
+#include "MU_Tolerance.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MU_TOLERANCE_X86 1
+#include <immintrin.h>
+#endif
+
+// gcc and clang only allow the intrinsics in functions built for that instruction set
+#if defined(MU_TOLERANCE_X86) && !defined(_MSC_VER)
+#define MU_TARGET_SSE2 __attribute__((target("sse2")))
+#define MU_TARGET_AVX __attribute__((target("avx")))
+#else
+#define MU_TARGET_SSE2
+#define MU_TARGET_AVX
+#endif
+
+
+namespace
+{
+   // the best of the kernels below the CPU can run: AVX2 adds nothing the double compares need
+   MU_Cpu::Level BestLevel()
+   {
+      const MU_Cpu::Level level = MU_Cpu::level();
+      return (level < MU_Cpu::LEVEL_AVX ? level : MU_Cpu::LEVEL_AVX);
+   }
+
+   const MU_Cpu::Level CpuLevel = BestLevel();
+   MU_Cpu::Level CurrentLevel = CpuLevel;
+
+
+   // map a double onto an unsigned integer so that the integers are in the
+   // same order as the doubles and neighbouring doubles differ by 1
+   inline unsigned long long OrderedBits(double d)
+   {
+      unsigned long long bits;
+      memcpy(&bits, &d, sizeof(bits));
+      const unsigned long long signBit = 1ULL << 63;
+      return (bits & signBit) ? ~bits + 1 : bits | signBit;   // -0 and +0 both map to signBit
+   }
+
+
+   // pairs i in [first,n) that fail the tests one at a time
+   size_t CompareScalar(const MU_Tolerance& tol, const double* a, const double* b, size_t first, size_t n, size_t* differIndex)
+   {
+      size_t count = 0;
+      for (size_t i = first; i < n; ++i)
+      {
+         if (tol.differ(a[i], b[i]))
+            differIndex[count++] = i;
+      }
+      return count;
+   }
+
+
+#ifdef MU_TOLERANCE_X86
+   // 2 pairs at a time; lanes failing both the absolute and relative test get the full check
+   MU_TARGET_SSE2
+   size_t CompareSse2(const MU_Tolerance& tol, const double* a, const double* b, size_t n, size_t* differIndex)
+   {
+      const __m128d absMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+      const __m128d absolute = _mm_set1_pd(tol.absolute);
+      const __m128d relative = _mm_set1_pd(tol.relative);
+      size_t count = 0;
+      size_t i = 0;
+      for (; i + 2 <= n; i += 2)
+      {
+         __m128d va = _mm_loadu_pd(a + i);
+         __m128d vb = _mm_loadu_pd(b + i);
+         __m128d diff = _mm_and_pd(_mm_sub_pd(va, vb), absMask);
+         __m128d scale = _mm_mul_pd(_mm_max_pd(_mm_and_pd(va, absMask), _mm_and_pd(vb, absMask)), relative);
+         __m128d fail = _mm_and_pd(_mm_cmpgt_pd(diff, absolute), _mm_cmpgt_pd(diff, scale));
+         int mask = _mm_movemask_pd(fail);
+         if (mask)
+         {
+            for (int lane = 0; lane < 2; ++lane)
+            {
+               if ((mask & (1 << lane)) && (tol.ulps == 0 || MU_Tolerance::ulpDistance(a[i + lane], b[i + lane]) > tol.ulps))
+                  differIndex[count++] = i + lane;
+            }
+         }
+      }
+      return count + CompareScalar(tol, a, b, i, n, differIndex + count);
+   }
+
+
+   // same as CompareSse2() with 4 pairs at a time
+   MU_TARGET_AVX
+   size_t CompareAvx(const MU_Tolerance& tol, const double* a, const double* b, size_t n, size_t* differIndex)
+   {
+      const __m256d absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+      const __m256d absolute = _mm256_set1_pd(tol.absolute);
+      const __m256d relative = _mm256_set1_pd(tol.relative);
+      size_t count = 0;
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+         __m256d va = _mm256_loadu_pd(a + i);
+         __m256d vb = _mm256_loadu_pd(b + i);
+         __m256d diff = _mm256_and_pd(_mm256_sub_pd(va, vb), absMask);
+         __m256d scale = _mm256_mul_pd(_mm256_max_pd(_mm256_and_pd(va, absMask), _mm256_and_pd(vb, absMask)), relative);
+         __m256d fail = _mm256_and_pd(_mm256_cmp_pd(diff, absolute, _CMP_GT_OQ), _mm256_cmp_pd(diff, scale, _CMP_GT_OQ));
+         int mask = _mm256_movemask_pd(fail);
+         if (mask)
+         {
+            for (int lane = 0; lane < 4; ++lane)
+            {
+               if ((mask & (1 << lane)) && (tol.ulps == 0 || MU_Tolerance::ulpDistance(a[i + lane], b[i + lane]) > tol.ulps))
+                  differIndex[count++] = i + lane;
+            }
+         }
+      }
+      return count + CompareScalar(tol, a, b, i, n, differIndex + count);
+   }
+#endif
+}
+
+
+
+
+bool MU_Tolerance::differ(double a, double b) const
+{
+   // written so that a NaN difference is never reported, the same as the plain
+   // 'fabs(a - b) > delta' test this replaces
+   double diff = fabs(a - b);
+   if (!(diff > absolute))
+      return false;
+   if (!(diff > relative * fmax(fabs(a), fabs(b))))
+      return false;
+   return ulps == 0 || ulpDistance(a, b) > ulps;
+}
+
+
+
+
+size_t MU_Tolerance::compare(const double* a, const double* b, size_t n, size_t* differIndex) const
+{
+#ifdef MU_TOLERANCE_X86
+   if (CurrentLevel == MU_Cpu::LEVEL_AVX)
+      return CompareAvx(*this, a, b, n, differIndex);
+   if (CurrentLevel == MU_Cpu::LEVEL_SSE2)
+      return CompareSse2(*this, a, b, n, differIndex);
+#endif
+   return CompareScalar(*this, a, b, 0, n, differIndex);
+}
+
+
+
+
+// static
+unsigned long long MU_Tolerance::ulpDistance(double a, double b)
+{
+   unsigned long long ua = OrderedBits(a);
+   unsigned long long ub = OrderedBits(b);
+   return (ua > ub ? ua - ub : ub - ua);
+}
+
+
+
+
+// static
+MU_Cpu::Level MU_Tolerance::level()
+{
+   return CurrentLevel;
+}
+
+
+
+
+// static
+MU_Cpu::Level MU_Tolerance::setLevel(MU_Cpu::Level aLevel)
+{
+   CurrentLevel = (aLevel < CpuLevel ? aLevel : CpuLevel);
+   return CurrentLevel;
+}
@@ -0,0 +1,778 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <strstream>
+#include <vector>
+
+#include "MU_StringUtil.h"
+#include "MU_StringView.h"
+#include "MU_Tolerance.h"
+#include "tinyxml2.h"
+
+using namespace std;
+using namespace tinyxml2;
+
+
+/**
+ * @file XmlBench.cpp
+ *
+ * Micro benchmarks for the string handling that XmlDiff spends its time in.
+ * Some benchmarks run the same work with the old and the new way of doing it;
+ * the others time the MU_StringUtil and tinyxml2 functions a comparison spends
+ * most of its time in, so a change to one of them can be measured against the
+ * results from before the change.
+ *
+ * Each result is the time per operation, the bytes per second (where the
+ * operation works through text) and the number of heap allocations per
+ * operation.  With --json the results are also written to a file, one
+ * result per line, to be kept and compared with later runs.
+ *
+ * Usage: XmlBench [--json <file>] [repeat count]
+ */
+
+
+
+// ======================================================================
+// heap allocations, counted by replacing the global operator new
+// ======================================================================
+
+//! heap allocations made since the program started (the benchmarks run in one thread)
+unsigned long long gAllocations = 0;
+
+void* operator new(size_t size)
+{
+   ++gAllocations;
+   void* p = malloc(size ? size : 1);
+   if (!p)
+      throw std::bad_alloc();
+   return p;
+}
+
+void* operator new[](size_t size)
+{
+   ++gAllocations;
+   void* p = malloc(size ? size : 1);
+   if (!p)
+      throw std::bad_alloc();
+   return p;
+}
+
+// VS2013 has neither noexcept nor the sized operator delete of C++14
+#if defined(_MSC_VER) && (_MSC_VER < 1900)
+#define BENCH_NOEXCEPT throw()
+#else
+#define BENCH_NOEXCEPT noexcept
+#define BENCH_SIZED_DELETE 1
+#endif
+
+void operator delete(void* p) BENCH_NOEXCEPT
+{
+   free(p);
+}
+
+void operator delete[](void* p) BENCH_NOEXCEPT
+{
+   free(p);
+}
+
+#ifdef BENCH_SIZED_DELETE
+void operator delete(void* p, size_t) BENCH_NOEXCEPT
+{
+   free(p);
+}
+
+void operator delete[](void* p, size_t) BENCH_NOEXCEPT
+{
+   free(p);
+}
+#endif
+
+
+
+
+/**
+ * @class BenchTimer
+ * @brief wall clock stopwatch that also counts the heap allocations made while it runs
+ */
+class BenchTimer
+{
+public:
+   BenchTimer() : mStart(chrono::steady_clock::now()), mStartAllocations(gAllocations), mSeconds(-1.0), mAllocations(0) {}
+
+   //! stop the timer, so what it measured can be reported later
+   void stop()
+   {
+      mSeconds = seconds();
+      mAllocations = gAllocations - mStartAllocations;
+   }
+
+   //! seconds since the timer was made, or until it was stopped
+   double seconds() const
+   {
+      if (mSeconds >= 0.0)
+         return mSeconds;
+      return chrono::duration<double>(chrono::steady_clock::now() - mStart).count();
+   }
+
+   //! heap allocations since the timer was made, or until it was stopped
+   unsigned long long allocations() const
+   {
+      return (mSeconds >= 0.0 ? mAllocations : gAllocations - mStartAllocations);
+   }
+
+private:
+   chrono::steady_clock::time_point mStart;
+   unsigned long long mStartAllocations;
+   double mSeconds;                        //!< -1 until stopped
+   unsigned long long mAllocations;
+};
+
+
+
+
+/**
+ * @class BenchResult
+ * @brief one line of the results
+ */
+class BenchResult
+{
+public:
+   BenchResult(const string& aName, double aNsPerOp, double aBytesPerSecond, double aAllocsPerOp)
+      : name(aName), nsPerOp(aNsPerOp), bytesPerSecond(aBytesPerSecond), allocsPerOp(aAllocsPerOp) {}
+
+   string name;
+   double nsPerOp;
+   double bytesPerSecond;     //!< 0 if the operation has no bytes to count
+   double allocsPerOp;
+};
+
+//! all results so far, for --json
+vector<BenchResult> gResults;
+
+
+
+
+//! write and keep one result: name, time per operation, bytes per second and allocations per operation.
+//! 'bytes' is the amount of text worked through in all the operations, 0 if that does not apply
+void report(const char* name, const BenchTimer& timer, double operations, double bytes = 0.0)
+{
+   const double seconds = timer.seconds();
+   const double nsPerOp = 1.0e9 * seconds / operations;
+   const double bytesPerSecond = (bytes > 0.0 && seconds > 0.0 ? bytes / seconds : 0.0);
+   const double allocsPerOp = timer.allocations() / operations;
+
+   if (bytesPerSecond > 0.0)
+      printf("%-40s %10.1f ns/op %10.1f MB/s %9.3f allocs/op\n", name, nsPerOp, bytesPerSecond / 1.0e6, allocsPerOp);
+   else
+      printf("%-40s %10.1f ns/op %15s %9.3f allocs/op\n", name, nsPerOp, "", allocsPerOp);
+   gResults.push_back(BenchResult(name, nsPerOp, bytesPerSecond, allocsPerOp));
+}
+
+
+
+
+//! write the results as JSON, one result per line so two runs can be compared line by line.  Returns true on error
+bool writeJson(const char* filename, int repeat)
+{
+   FILE* file = fopen(filename, "w");
+   if (!file)
+      return true;
+   fprintf(file, "{\"repeat\": %d, \"results\": [\n", repeat);
+   for (size_t i = 0; i < gResults.size(); ++i)
+   {
+      // the names have no characters that need escaping
+      const BenchResult& result = gResults[i];
+      fprintf(file, "  {\"name\": \"%s\", \"ns_per_op\": %.3f, \"bytes_per_sec\": %.0f, \"allocs_per_op\": %.4f}%s\n",
+         result.name.c_str(), result.nsPerOp, result.bytesPerSecond, result.allocsPerOp, (i + 1 < gResults.size() ? "," : ""));
+   }
+   fprintf(file, "]}\n");
+   return fclose(file) != 0;
+}
+
+
+
+
+// ======================================================================
+// token compare: what countTextAsNumberTokenDiff() does for each pair of tokens
+// ======================================================================
+
+class BadConversion : public std::runtime_error {
+public:
+   BadConversion(const std::string& s)
+      : std::runtime_error(s)
+   { }
+};
+
+//! ToDoubleEx() as it was before TryToDouble(): a stream per call and an exception for text
+double oldToDoubleEx(const std::string& aString)
+{
+   double value = 0.0;
+   istrstream iss(aString.c_str());
+   if (!(iss >> value))
+      throw BadConversion("ToDouble(\"" + aString + "\")");
+   return value;
+}
+
+
+
+
+//! make token pairs, about 'textPercent' percent of them words instead of numbers
+void makeTokens(size_t count, int textPercent, vector<string>& tokens1, vector<string>& tokens2)
+{
+   const char* words[] = { "double", "name", "true", "meters", "Group", "id_42", "N/A", "value" };
+   srand(12345);
+   tokens1.clear();
+   tokens2.clear();
+   char buffer[64];
+   for (size_t i = 0; i < count; ++i)
+   {
+      if (rand() % 100 < textPercent)
+      {
+         tokens1.push_back(words[rand() % 8]);
+         tokens2.push_back(rand() % 10 ? tokens1.back() : words[rand() % 8]);
+      }
+      else
+      {
+         double d = (rand() - RAND_MAX / 2) / 1000.0;
+         sprintf(buffer, "%.9g", d);
+         tokens1.push_back(buffer);
+         sprintf(buffer, "%.9g", (rand() % 10 ? d : d + 1.0));
+         tokens2.push_back(buffer);
+      }
+   }
+}
+
+
+
+
+//! compare the token pairs the old way.  returns number of differences
+unsigned int compareTokensOld(const vector<string>& tokens1, const vector<string>& tokens2, double delta)
+{
+   unsigned int nDiff = 0;
+   for (size_t n = 0; n < tokens1.size(); ++n)
+   {
+      double d1, d2;
+      bool isNumber = false;
+      try
+      {
+         d1 = oldToDoubleEx(tokens1[n]);
+         d2 = oldToDoubleEx(tokens2[n]);
+         isNumber = true;
+      }
+      catch (const std::runtime_error& e)
+      {
+         d1 = 0.0;
+         d2 = 0.0;
+      }
+
+      if (isNumber ? fabs(d1 - d2) > delta : !MU_StringUtil::Strcasecmp(tokens1[n], tokens2[n]))
+         ++nDiff;
+   }
+   return nDiff;
+}
+
+
+
+
+//! compare the token pairs with TryToDouble().  returns number of differences
+unsigned int compareTokensNew(const vector<string>& tokens1, const vector<string>& tokens2, double delta)
+{
+   unsigned int nDiff = 0;
+   for (size_t n = 0; n < tokens1.size(); ++n)
+   {
+      double d1, d2;
+      bool isNumber = MU_StringUtil::TryToDouble(tokens1[n], d1) && MU_StringUtil::TryToDouble(tokens2[n], d2);
+
+      if (isNumber ? fabs(d1 - d2) > delta : !MU_StringUtil::Strcasecmp(tokens1[n], tokens2[n]))
+         ++nDiff;
+   }
+   return nDiff;
+}
+
+
+
+
+void benchTokenCompare(int repeat)
+{
+   const size_t nTokens = 100000;
+   const int textPercent[] = { 0, 50, 100 };
+   vector<string> tokens1, tokens2;
+
+   for (size_t t = 0; t < sizeof(textPercent) / sizeof(textPercent[0]); ++t)
+   {
+      makeTokens(nTokens, textPercent[t], tokens1, tokens2);
+      char name[64];
+      unsigned int nOld = 0, nNew = 0;
+
+      BenchTimer oldTimer;
+      for (int r = 0; r < repeat; ++r)
+         nOld = compareTokensOld(tokens1, tokens2, 1.0e-7);
+      oldTimer.stop();
+
+      BenchTimer newTimer;
+      for (int r = 0; r < repeat; ++r)
+         nNew = compareTokensNew(tokens1, tokens2, 1.0e-7);
+      newTimer.stop();
+
+      sprintf(name, "token compare %3d%% text, old", textPercent[t]);
+      report(name, oldTimer, static_cast<double>(nTokens) * repeat);
+      sprintf(name, "token compare %3d%% text, new", textPercent[t]);
+      report(name, newTimer, static_cast<double>(nTokens) * repeat);
+      if (nOld != nNew)
+         printf("   differences do not match: old %u, new %u\n", nOld, nNew);
+   }
+}
+
+
+
+
+// ======================================================================
+// tokenize: split a long array of numbers (as found in element text) into tokens
+// ======================================================================
+
+//! make text with 'count' numbers separated by ", "
+string makeNumberArray(size_t count)
+{
+   string text;
+   char buffer[64];
+   srand(54321);
+   for (size_t i = 0; i < count; ++i)
+   {
+      sprintf(buffer, "%s%.6f", (i ? ", " : ""), (rand() - RAND_MAX / 2) / 1000.0);
+      text += buffer;
+   }
+   return text;
+}
+
+
+
+
+void benchTokenize(int repeat)
+{
+   const size_t nNumbers = 200000;
+   const string text = makeNumberArray(nNumbers);
+   const string delim = "|{, \n";
+   const MU_CharSet delimSet(delim);
+   size_t nOld = 0, nNew = 0;
+
+   BenchTimer oldTimer;
+   for (int r = 0; r < repeat; ++r)
+   {
+      vector<string> tokens;
+      MU_StringUtil::Tokenize(text, tokens, delim);
+      nOld = tokens.size();
+   }
+   oldTimer.stop();
+
+   report("tokenize number array, Tokenize", oldTimer, static_cast<double>(nNumbers) * repeat, static_cast<double>(text.size()) * repeat);
+
+   // the view tokenizer with each instruction set the CPU has
+   const MU_CharSet::ScanLevel best = MU_CharSet::scanLevel();
+   for (int level = MU_CharSet::SCAN_SCALAR; level <= best; ++level)
+   {
+      MU_CharSet::setScanLevel(static_cast<MU_CharSet::ScanLevel>(level));
+
+      BenchTimer newTimer;
+      for (int r = 0; r < repeat; ++r)
+      {
+         MU_Tokenizer tokens(text.c_str(), delimSet);
+         nNew = tokens.countRemaining();
+      }
+      newTimer.stop();
+
+      char name[64];
+      sprintf(name, "tokenize number array, %s", MU_CharSet::scanLevelName(MU_CharSet::scanLevel()));
+      report(name, newTimer, static_cast<double>(nNumbers) * repeat, static_cast<double>(text.size()) * repeat);
+      if (nOld != nNew)
+         printf("   token counts do not match: old %u, new %u\n", static_cast<unsigned int>(nOld), static_cast<unsigned int>(nNew));
+   }
+   MU_CharSet::setScanLevel(best);
+}
+
+
+
+
+// ======================================================================
+// number array compare: the pairs of numbers from two long arrays
+// ======================================================================
+
+void benchNumberCompare(int repeat)
+{
+   const size_t nNumbers = 1000000;
+   vector<double> a(nNumbers), b(nNumbers);
+   vector<size_t> differIndex(nNumbers);
+   srand(999);
+   for (size_t i = 0; i < nNumbers; ++i)
+   {
+      a[i] = (rand() - RAND_MAX / 2) / 1000.0;
+      b[i] = (rand() % 1000 ? a[i] + 1.0e-9 : a[i] + 1.0);
+   }
+   const double delta = 1.0e-7;
+   size_t nOld = 0, nNew = 0;
+
+   BenchTimer oldTimer;
+   for (int r = 0; r < repeat; ++r)
+   {
+      nOld = 0;
+      for (size_t i = 0; i < nNumbers; ++i)
+      {
+         if (fabs(a[i] - b[i]) > delta)
+            differIndex[nOld++] = i;
+      }
+   }
+   oldTimer.stop();
+   report("number compare, one at a time", oldTimer, static_cast<double>(nNumbers) * repeat);
+
+   const MU_Tolerance tolerances[] = { MU_Tolerance(delta), MU_Tolerance(delta, 1.0e-12, 4) };
+   const char* tolNames[] = { "abs", "abs+rel+ulp" };
+   const MU_Cpu::Level best = MU_Tolerance::level();
+   for (int t = 0; t < 2; ++t)
+   {
+      for (int level = MU_Cpu::LEVEL_SCALAR; level <= best; ++level)
+      {
+         MU_Tolerance::setLevel(static_cast<MU_Cpu::Level>(level));
+
+         BenchTimer newTimer;
+         for (int r = 0; r < repeat; ++r)
+            nNew = tolerances[t].compare(&a[0], &b[0], nNumbers, &differIndex[0]);
+         newTimer.stop();
+
+         char name[64];
+         sprintf(name, "number compare, %s %s", tolNames[t], MU_Cpu::levelName(MU_Tolerance::level()));
+         report(name, newTimer, static_cast<double>(nNumbers) * repeat);
+         if (nOld != nNew)
+            printf("   differences do not match: old %u, new %u\n", static_cast<unsigned int>(nOld), static_cast<unsigned int>(nNew));
+      }
+   }
+   MU_Tolerance::setLevel(best);
+}
+
+
+
+
+// ======================================================================
+// MU_StringUtil: the functions used on each token and each element
+// ======================================================================
+
+//! total characters in the strings
+double totalSize(const vector<string>& strings)
+{
+   double size = 0.0;
+   for (size_t i = 0; i < strings.size(); ++i)
+      size += static_cast<double>(strings[i].size());
+   return size;
+}
+
+
+
+
+void benchStringUtil(int repeat)
+{
+   const size_t nTokens = 100000;
+   vector<string> words1, words2, numbers1, numbers2;
+   makeTokens(nTokens, 100, words1, words2);
+   makeTokens(nTokens, 0, numbers1, numbers2);
+   const double wordBytes = totalSize(words1) * repeat;
+   const double operations = static_cast<double>(nTokens) * repeat;
+
+   unsigned int nEqual = 0;
+   BenchTimer caseTimer;
+   for (int r = 0; r < repeat; ++r)
+   {
+      for (size_t i = 0; i < nTokens; ++i)
+         nEqual += MU_StringUtil::Strcasecmp(words1[i], words2[i]);
+   }
+   caseTimer.stop();
+   report("Strcasecmp", caseTimer, operations, wordBytes);
+
+   // assigning to a string that is already big enough does not allocate
+   string work;
+   work.reserve(64);
+   BenchTimer lowerTimer;
+   for (int r = 0; r < repeat; ++r)
+   {
+      for (size_t i = 0; i < nTokens; ++i)
+      {
+         work = words1[i];
+         MU_StringUtil::ToLower(work);
+      }
+   }
+   lowerTimer.stop();
+   report("ToLower", lowerTimer, operations, wordBytes);
+
+   size_t hash = 0;
+   BenchTimer hashTimer;
+   for (int r = 0; r < repeat; ++r)
+   {
+      for (size_t i = 0; i < nTokens; ++i)
+         hash ^= MU_StringUtil::HashFun(words1[i]);
+   }
+   hashTimer.stop();
+   report("HashFun", hashTimer, operations, wordBytes);
+
+   double sum = 0.0;
+   BenchTimer doubleTimer;
+   for (int r = 0; r < repeat; ++r)
+   {
+      for (size_t i = 0; i < nTokens; ++i)
+         sum += MU_StringUtil::ToDoubleEx(numbers1[i]);
+   }
+   doubleTimer.stop();
+   report("ToDoubleEx", doubleTimer, operations, totalSize(numbers1) * repeat);
+
+   // the text of an element with a long array of numbers, as --side writes it
+   const string text = makeNumberArray(2000);
+   const int nWraps = 20 * repeat;
+   size_t nLines = 0;
+   BenchTimer wrapTimer;
+   for (int r = 0; r < nWraps; ++r)
+      nLines += MU_StringUtil::WrapTextHard(text, 80).size();
+   wrapTimer.stop();
+   report("WrapTextHard, 80 columns", wrapTimer, nWraps, static_cast<double>(text.size()) * nWraps);
+
+   // so the compiler cannot leave out the work
+   if (nEqual == 0 && hash == 0 && sum == 0.0 && nLines == 0)
+      printf("   (no results)\n");
+}
+
+
+
+
+// ======================================================================
+// tinyxml2: parsing, the strings of the parsed nodes, printing, the memory pools
+// ======================================================================
+
+//! make an XML document of about 'size' bytes, shaped like the files XmlDiff compares
+string makeXmlDocument(size_t size)
+{
+   string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<root>\n";
+   char buffer[64];
+   srand(2468);
+   for (unsigned int g = 0; xml.size() < size; ++g)
+   {
+      sprintf(buffer, "  <group name=\"g%u\" type=\"grp\">\n", g);
+      xml += buffer;
+      for (unsigned int v = 0; v < 8; ++v)
+      {
+         sprintf(buffer, "    <var name=\"v%u\" type=\"double\" units=\"m\">", v);
+         xml += buffer;
+         for (int i = 0; i < 8; ++i)
+         {
+            sprintf(buffer, "%s%.9g", (i ? ", " : ""), (rand() - RAND_MAX / 2) / 1000.0);
+            xml += buffer;
+         }
+         xml += "</var>\n";
+      }
+      xml += "    <Text name=\"note\">speed &lt; 5 m/s &amp; height &gt; 2 m</Text>\n  </group>\n";
+   }
+   xml += "</root>\n";
+   return xml;
+}
+
+
+
+
+void benchParse(int repeat)
+{
+   const string xml = makeXmlDocument(1 << 20);
+   const int nParses = 4 * repeat;
+   XMLDocument doc;
+   int nErrors = 0;
+
+   BenchTimer timer;
+   for (int r = 0; r < nParses; ++r)
+      nErrors += (doc.Parse(xml.c_str(), xml.size()) != XML_SUCCESS);
+   timer.stop();
+   report("XMLDocument::Parse, 1 MB", timer, nParses, static_cast<double>(xml.size()) * nParses);
+   if (nErrors)
+      printf("   %d parse errors\n", nErrors);
+}
+
+
+
+
+void benchSkipWhiteSpace(int repeat)
+{
+   // runs of white space between words, as between the elements of an indented file
+   const size_t nRuns = 100000;
+   string text;
+   for (size_t i = 0; i < nRuns; ++i)
+      text += (i % 2 ? "\n      <a>" : "  \t <b>");
+   const double operations = static_cast<double>(nRuns) * repeat;
+
+   size_t nSkipped = 0;
+   BenchTimer timer;
+   for (int r = 0; r < repeat; ++r)
+   {
+      const char* p = text.c_str();
+      while (*p)
+      {
+         const char* q = XMLUtil::SkipWhiteSpace(p);
+         nSkipped += q - p;
+         while (*q && !XMLUtil::IsWhiteSpace(*q))
+            ++q;
+         p = q;
+      }
+   }
+   timer.stop();
+   report("XMLUtil::SkipWhiteSpace", timer, operations, static_cast<double>(text.size()) * repeat);
+   if (nSkipped == 0)
+      printf("   (nothing skipped)\n");
+}
+
+
+
+
+void benchGetStr(int repeat)
+{
+   // GetStr() ends each string and replaces its entities in place, so the
+   // strings are copied back before each pass (the copy is a small part of the time)
+   const size_t nStrings = 20000;
+   const char* const texts[] = { "1.5, 2.25, 3.125, 4.0625, 5.03125", "speed &lt; 5 m/s &amp; height &gt; 2 m" };
+   for (int t = 0; t < 2; ++t)
+   {
+      const size_t length = strlen(texts[t]);
+      string source;
+      for (size_t i = 0; i < nStrings; ++i)
+      {
+         source += texts[t];
+         source += '<';
+      }
+      vector<char> work(source.size() + 1);
+      StrPair pair;
+      size_t nChars = 0;
+
+      BenchTimer timer;
+      for (int r = 0; r < repeat; ++r)
+      {
+         memcpy(&work[0], source.c_str(), source.size() + 1);
+         char* p = &work[0];
+         for (size_t i = 0; i < nStrings; ++i, p += length + 1)
+         {
+            pair.Set(p, p + length, StrPair::TEXT_ELEMENT);
+            nChars += strlen(pair.GetStr());
+         }
+      }
+      timer.stop();
+      report(t ? "StrPair::GetStr, entities" : "StrPair::GetStr, plain text", timer,
+         static_cast<double>(nStrings) * repeat, static_cast<double>(length) * nStrings * repeat);
+      if (nChars == 0)
+         printf("   (no characters)\n");
+   }
+}
+
+
+
+
+void benchPrintString(int repeat)
+{
+   // PrintString() is private; PushText() outside of an element is PrintString() and nothing else
+   const size_t nStrings = 20000;
+   const char* const texts[] = { "1.5, 2.25, 3.125, 4.0625, 5.03125", "speed < 5 m/s & height > 2 m" };
+   for (int t = 0; t < 2; ++t)
+   {
+      XMLPrinter printer(0, true);
+      int nBytes = 0;
+
+      BenchTimer timer;
+      for (int r = 0; r < repeat; ++r)
+      {
+         for (size_t i = 0; i < nStrings; ++i)
+         {
+            printer.ClearBuffer();
+            printer.PushText(texts[t]);
+            nBytes += printer.CStrSize();
+         }
+      }
+      timer.stop();
+      report(t ? "XMLPrinter::PrintString, entities" : "XMLPrinter::PrintString, plain text", timer,
+         static_cast<double>(nStrings) * repeat, static_cast<double>(strlen(texts[t])) * nStrings * repeat);
+      if (nBytes == 0)
+         printf("   (nothing printed)\n");
+   }
+}
+
+
+
+
+void benchMemPool(int repeat)
+{
+   const int nItems = 100000;
+   vector<void*> items(nItems);
+   MemPoolT< sizeof(XMLElement) > pool;
+
+   // a new document: every block is new
+   BenchTimer newTimer;
+   for (int r = 0; r < repeat; ++r)
+   {
+      for (int i = 0; i < nItems; ++i)
+         items[i] = pool.Alloc();
+      pool.Clear();
+   }
+   newTimer.stop();
+   report("MemPoolT::Alloc, new blocks", newTimer, static_cast<double>(nItems) * repeat);
+
+   // items freed and allocated again, as when nodes are deleted and made
+   for (int i = 0; i < nItems; ++i)
+      items[i] = pool.Alloc();
+   BenchTimer reuseTimer;
+   for (int r = 0; r < repeat; ++r)
+   {
+      for (int i = 0; i < nItems; ++i)
+         pool.Free(items[i]);
+      for (int i = 0; i < nItems; ++i)
+         items[i] = pool.Alloc();
+   }
+   reuseTimer.stop();
+   report("MemPoolT::Alloc, freed items", reuseTimer, static_cast<double>(nItems) * repeat);
+   pool.Clear();
+}
+
+
+
+
+void benchTinyXml(int repeat)
+{
+   benchParse(repeat);
+   benchSkipWhiteSpace(repeat);
+   benchGetStr(repeat);
+   benchPrintString(repeat);
+   benchMemPool(repeat);
+}
+
+
+
+
+int main(int argc, char** argv)
+{
+   int repeat = 5;
+   const char* jsonFile = nullptr;
+   for (int i = 1; i < argc; ++i)
+   {
+      if (MU_StringUtil::Strcasecmp(argv[i], "--json") && i + 1 < argc)
+         jsonFile = argv[++i];
+      else
+         repeat = atoi(argv[i]);
+   }
+   if (repeat < 1)
+      repeat = 1;
+
+   benchTokenCompare(repeat);
+   benchTokenize(repeat);
+   benchNumberCompare(repeat);
+   benchStringUtil(repeat);
+   benchTinyXml(repeat);
+
+   if (jsonFile && writeJson(jsonFile, repeat))
+   {
+      printf("Error: unable to write '%s'\n", jsonFile);
+      return 1;
+   }
+   return 0;
+}
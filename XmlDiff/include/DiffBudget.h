@@ -0,0 +1,89 @@
+#ifndef DiffBudget_h
+#define DiffBudget_h 1
+
+/**
+ * @file DiffBudget.h
+ * @brief contains prototypes and class declarations for class DiffBudget
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+
+class DiffRecordWriter;
+
+
+
+/**
+ * @class DiffBudget
+ * @brief How many differences a comparison may write and how long it may take (--max-diffs, --timeout).
+ *
+ * takeDiff() is called before each difference is written.  Once the limit is
+ * reached no more are written, and stopped() tells the walk through the trees
+ * to stop at the next element.  stopped() also reads the clock, but only
+ * every so many calls, so it is cheap to call for every element.
+ *
+ * The counts of a comparison that stopped are the counts up to that point.
+ * One budget may be shared by the threads comparing the same pair of files.
+ */
+
+class DiffBudget
+{
+
+public:
+   typedef std::chrono::steady_clock Clock;
+
+   //! why the comparison stopped
+   enum Reason
+   {
+      NotStopped,       //!< it ran to the end
+      MaxDiffs,         //!< the limit on differences was reached
+      Timeout           //!< the time ran out
+   };
+
+   //! Constructor
+   /*!
+    * @param aMaxDiffs the most differences to write, 0 for no limit
+    * @param aDeadline stop at this time, or null for no time limit
+    */
+   DiffBudget(unsigned int aMaxDiffs, const Clock::time_point* aDeadline);
+
+   //! count a difference that is about to be written.  Returns false if the limit was already reached and it must not be written
+   bool takeDiff();
+
+   //! true if the comparison should stop.  'calls' is a counter kept by the caller, one per thread, to read the clock less often
+   bool stopped(unsigned int& calls);
+
+   //! read the clock now.  Returns true if the time has run out (or the comparison stopped for another reason)
+   bool checkClock();
+
+   //! why the comparison stopped, if it did
+   Reason reason() const { return static_cast<Reason>(mReason.load()); }
+
+   //! the limit on differences, 0 for none
+   unsigned int maxDiffs() const { return mMaxDiffs; }
+
+   //! say why the comparison stopped, if it did, as a stopped record if 'records' is not null
+   void writeStopped(std::ostream& os, const DiffRecordWriter* records) const;
+
+   //! the exit status with --quick: 0 if the same, 2 if they differ, 3 if --timeout ran out before a difference was found
+   static int quickStatus(bool differ, bool timedOut);
+
+
+private:
+   DiffBudget(const DiffBudget&);                 // not supported
+   void operator=(const DiffBudget&);             // not supported
+
+   //! record why the comparison stopped, keeping the first reason
+   void stop(Reason aReason);
+
+   unsigned int mMaxDiffs;
+   bool mHasDeadline;
+   Clock::time_point mDeadline;
+   std::atomic<unsigned int> mDiffs;       //!< differences written so far
+   std::atomic<int> mReason;               //!< a Reason, NotStopped until the comparison should stop
+};
+
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef DiffRecordWriter_h
+#define DiffRecordWriter_h 1
+
+/**
+ * @file DiffRecordWriter.h
+ * @brief contains prototypes and class declarations for class DiffRecordWriter
+ *
+ */
+
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MU_StringView.h"
+
+
+
+/**
+ * @class DiffRecordWriter
+ * @brief Writes the differences as records for other programs to read (--format).
+ *
+ * Instead of the comma separated text lines, each difference is one record
+ * giving its kind, the id of its path in the XML tree, the two values, the
+ * difference of the values if both are numbers, and where the values are in
+ * each file.  A path is written once, in a path record before the first
+ * difference that uses it; after that only its id is written.
+ *
+ * JsonLines writes one JSON object per line with a "type" of "header",
+ * "files", "path", "diff", "stopped", "summary", "batch" or "error".  Keys that do not
+ * apply (delta, offsets, attribute) are left out.
+ *
+ * Binary writes the same records, each as a 4 byte length (of what follows
+ * it), a type byte ('H','F','P','D','T','S','B','E') and the fields.  Integers
+ * are little endian, a string is its 4 byte length then its bytes, delta is
+ * an 8 byte IEEE double (NaN if the values are not both numbers) and an
+ * unknown offset is -1.
+ *
+ * The path ids start at 0 for each pair of files.  pathId() may be called
+ * from several threads at once; the records themselves are written to
+ * whichever stream is given.
+ */
+
+class DiffRecordWriter
+{
+
+public:
+   //! what the records are written as
+   enum Format
+   {
+      Text,          //!< no records, the comma separated lines
+      JsonLines,     //!< one JSON object per line
+      Binary         //!< length-prefixed binary records
+   };
+
+   //! what differs
+   enum Kind
+   {
+      TagName = 1,         //!< the element tag names
+      AttributeName = 2,   //!< the names of attributes in the same place
+      AttributeValue = 3,  //!< a token of an attribute value
+      Content = 4,         //!< a token of the element text, or the text is only in one file
+      Deleted = 5,         //!< an element only in file 1 (--align)
+      Inserted = 6         //!< an element only in file 2 (--align)
+   };
+
+   //! the counts of one comparison, for the summary record
+   struct Summary
+   {
+      Summary() : elements(0), tagDiffs(0), extraElements1(0), extraElements2(0), attributeNameDiffs(0),
+         attributeValueDiffs(0), contentDiffs(0), numberDiffs(0), textDiffs(0), total(0), deleted(0), inserted(0) {}
+
+      unsigned int elements;              //!< elements compared
+      unsigned int tagDiffs;              //!< elements with different tag names
+      unsigned int extraElements1;        //!< extra elements in file 1
+      unsigned int extraElements2;        //!< extra elements in file 2
+      unsigned int attributeNameDiffs;    //!< elements with an attribute name difference
+      unsigned int attributeValueDiffs;   //!< elements with an attribute value difference
+      unsigned int contentDiffs;          //!< elements with a content difference
+      unsigned int numberDiffs;           //!< content tokens that differ as numbers
+      unsigned int textDiffs;             //!< content tokens that differ as text
+      unsigned int total;                 //!< total differences
+      unsigned int deleted;               //!< elements only in file 1 (--align)
+      unsigned int inserted;              //!< elements only in file 2 (--align)
+   };
+
+   //! Constructor
+   DiffRecordWriter(Format aFormat);
+
+   //! turn "text", "jsonl" or "binary" (any case) into a format.  Returns true if it is none of these
+   static bool parseFormat(const std::string& name, Format& aFormat);
+
+   //! the format records are written in
+   Format format() const { return mFormat; }
+
+   //! id of the path, and whether this is the first time the path was asked for
+   unsigned int pathId(const std::string& path, bool& isNew);
+
+   //! mark the path written.  Returns true if it was not written before
+   bool markWritten(unsigned int id);
+
+   //! first record of the output
+   void header(std::ostream& os) const;
+   //! start of the records of a pair of files.  Forgets the paths of the pair before
+   void files(std::ostream& os, const std::string& filename1, const std::string& filename2);
+   //! the text of path 'id'
+   void path(std::ostream& os, unsigned int id) const;
+   //! one difference.  'attribute' is null unless the kind is AttributeValue, delta is NaN and offsets -1 if not known
+   void diff(std::ostream& os, Kind kind, unsigned int pathId, const char* attribute,
+      const MU_StringView& value1, const MU_StringView& value2, double delta, long long offset1, long long offset2) const;
+   //! the comparison of a pair of files stopped early, 'reason' being "max-diffs" or "timeout".  Comes before its summary
+   void stopped(std::ostream& os, const char* reason) const;
+   //! the counts of a pair of files, or of all pairs after a batch record
+   void summary(std::ostream& os, const Summary& counts) const;
+   //! the counts of a --batch run, followed by the summary of all pairs
+   void batch(std::ostream& os, unsigned int pairs, unsigned int withDifferences, unsigned int notCompared) const;
+   //! a file could not be read, or the like
+   void error(std::ostream& os, const std::string& message) const;
+   //! an error record, or the message as a line of text if 'records' is null
+   static void writeError(std::ostream& os, const DiffRecordWriter* records, const std::string& message);
+
+
+private:
+   DiffRecordWriter(const DiffRecordWriter&);     // not supported
+   void operator=(const DiffRecordWriter&);       // not supported
+
+   //! write the string as a JSON string, quotes included
+   static void jsonString(std::ostream& os, const char* p, size_t n);
+   //! write the binary record length and type, the length being that of 'fields' plus the type
+   static void binaryRecord(std::ostream& os, char type, const std::string& fields);
+   //! add integers, doubles and strings to binary record fields
+   static void putU32(std::string& fields, unsigned int v);
+   static void putI64(std::string& fields, long long v);
+   static void putF64(std::string& fields, double v);
+   static void putString(std::string& fields, const char* p, size_t n);
+
+   Format mFormat;
+   mutable std::mutex mLock;                               //!< guards the paths
+   std::unordered_map<std::string, unsigned int> mPathIds; //!< id of each path
+   std::vector<const std::string*> mPaths;                 //!< path of each id (the key in mPathIds)
+   std::vector<bool> mWritten;                             //!< the path record of each id was written
+};
+
+
+#endif
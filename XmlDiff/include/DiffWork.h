@@ -0,0 +1,87 @@
+#ifndef DiffWork_h
+#define DiffWork_h 1
+
+/**
+ * @file DiffWork.h
+ * @brief contains prototypes and class declarations for class DiffWork
+ *
+ */
+
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tinyxml2.h"
+#include "MU_StringView.h"
+
+#include "DiffRecordWriter.h"
+#include "XmlDifferences.h"
+
+
+
+/**
+ * @class DiffWork
+ * @brief one piece of a comparison split up to run on several threads
+ *
+ * A piece is either a pair of elements whose subtrees still need comparing, or
+ * (when element1 is null) output and counts that were made while splitting.
+ * Each piece keeps its own output and counts so the pieces can be put back
+ * together in document order no matter which thread ran them or when.
+ *
+ * With records (--format) a piece does not take path ids from the writer, as
+ * the ids would then depend on which thread got there first.  It keeps the
+ * text of its paths and its records, and write() gives the paths their ids
+ * when the pieces are written in document order, the same ids as with one
+ * thread.
+ */
+
+class DiffWork
+{
+
+public:
+   //! Constructor, a piece with nothing in it
+   DiffWork();
+
+   //! the records added from now on have this path.  Returns the id of the path within the piece
+   unsigned int addPath(const std::string& path);
+
+   //! keep one difference as a record, 'path' being from addPath().  The arguments are those of DiffRecordWriter::diff
+   void addRecord(DiffRecordWriter::Kind kind, unsigned int path, const char* attribute,
+      const MU_StringView& value1, const MU_StringView& value2, double delta, long long offset1, long long offset2);
+
+   //! write the differences of the piece to 'os'.  Each record is given the id 'records' has for its path,
+   //! after a path record if the path was not written before
+   void write(std::ostream& os, DiffRecordWriter* records) const;
+
+   tinyxml2::XMLElement* element1;  // element pair to compare along with their children
+   tinyxml2::XMLElement* element2;
+   std::vector<std::string> modelTree;    // model tree of the parent of the element pair, one name per level
+   std::ostringstream out;                // differences found in this piece, as text
+   XmlDifferences totDiff;                // counts for this piece
+   bool finished;                         // the element pair has been compared (see DiffWorkCursor)
+
+
+private:
+   DiffWork(const DiffWork&);             // not supported
+   void operator=(const DiffWork&);       // not supported
+
+   //! a difference kept until the piece is written (--format)
+   struct Record
+   {
+      DiffRecordWriter::Kind kind;
+      unsigned int path;            // index into mPaths
+      std::string attribute;        // empty unless the kind is AttributeValue
+      std::string value1;
+      std::string value2;
+      double delta;
+      long long offset1;
+      long long offset2;
+   };
+
+   std::vector<std::string> mPaths;       // text of each path the records use
+   std::vector<Record> mRecords;          // the records, in document order
+};
+
+
+#endif
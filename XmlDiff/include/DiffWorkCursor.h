@@ -0,0 +1,70 @@
+#ifndef DiffWorkCursor_h
+#define DiffWorkCursor_h 1
+
+/**
+ * @file DiffWorkCursor.h
+ * @brief contains prototypes and class declarations for class DiffWorkCursor
+ *
+ */
+
+#include <list>
+#include <mutex>
+#include <ostream>
+
+#include "DiffRecordWriter.h"
+#include "DiffWork.h"
+#include "XmlDifferences.h"
+
+
+
+/**
+ * @class DiffWorkCursor
+ * @brief Writes the pieces of a split comparison in document order as soon as they can be.
+ *
+ * The pool threads call finish() as each piece is compared.  A piece is
+ * written, its counts added and the piece removed from the list as soon as
+ * it and every piece before it are finished, so the output starts before the
+ * whole tree has been compared and only the pieces that finished out of turn
+ * are held.  The pieces without an element pair were finished when the work
+ * was split.
+ *
+ * Only the pieces at the front of the list are removed, and only once they
+ * are finished; a piece not yet handed to the pool stays where it is.
+ */
+
+class DiffWorkCursor
+{
+
+public:
+   //! Constructor
+   /*!
+    * @param aWork the pieces, in document order
+    * @param aOut where the pieces are written
+    * @param aRecords write the records of the pieces in this format, null for text lines
+    * @param aTotDiff the counts of each piece are added to this
+    */
+   DiffWorkCursor(std::list<DiffWork>& aWork, std::ostream& aOut, DiffRecordWriter* aRecords, XmlDifferences& aTotDiff);
+
+   //! write the finished pieces at the front of the list
+   void writeFinished();
+
+   //! mark a piece finished and write what can be written.  Called by the pool threads
+   void finish(DiffWork* piece);
+
+
+private:
+   DiffWorkCursor(const DiffWorkCursor&);         // not supported
+   void operator=(const DiffWorkCursor&);         // not supported
+
+   //! writeFinished() with the lock held
+   void writeFront();
+
+   std::mutex mLock;                  //!< guards the front of the list and the output
+   std::list<DiffWork>& mWork;
+   std::ostream& mOut;
+   DiffRecordWriter* mRecords;
+   XmlDifferences& mTotDiff;
+};
+
+
+#endif
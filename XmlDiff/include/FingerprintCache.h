@@ -0,0 +1,75 @@
+#ifndef FingerprintCache_h
+#define FingerprintCache_h 1
+
+/**
+ * @file FingerprintCache.h
+ * @brief contains prototypes and class declarations for class FingerprintCache
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include "tinyxml2.h"
+#include "XmlFingerprint.h"
+
+
+
+/**
+ * @class FingerprintCache
+ * @brief The subtree fingerprints of a file, kept in a sidecar file between runs (--cache).
+ *
+ * The same baseline file is often compared with many others, one run after
+ * another.  write() keeps its fingerprints (see XmlFingerprint) in
+ * '<file>.xdfp' with the size and modification time of the file and a hash of
+ * the settings the fingerprints depend on.  read() gives them back only if all
+ * three are still the same, so a later run can attach them instead of hashing
+ * the file again, or, if the other file has the same top fingerprints, not read
+ * the baseline at all.
+ *
+ * The sidecar is only written, and only read back, if it is newer than the
+ * file (see SidecarFile), so a change made in the same clock tick as the
+ * sidecar is not missed.  The sidecar is written to a temporary name and then
+ * renamed, so a run reading it never sees half of it; if it cannot be written
+ * the comparison goes on without it.
+ */
+
+class FingerprintCache
+{
+
+public:
+   //! Constructor
+   /*!
+    * @param aFilename the XML file the fingerprints are for
+    * @param aConfigHash hash of the settings the fingerprints depend on
+    */
+   FingerprintCache(const std::string& aFilename, unsigned long long aConfigHash);
+
+   //! read the sidecar.  Returns false if there is none or it is for another version of the file or other settings
+   bool read();
+
+   //! write the fingerprints of the file to the sidecar.  Returns true on error
+   bool write(const std::vector<XmlFingerprint::Entry>& entries) const;
+
+   //! the fingerprints read, each element after its children.  For XmlFingerprint::attach()
+   std::vector<XmlFingerprint::Entry>& entries() { return mEntries; }
+
+   //! true if the top elements of a fingerprinted document are the same as those of the cached file.
+   //! The number of elements in them is set in 'elements'
+   bool sameTop(const tinyxml2::XMLDocument& doc, unsigned int& elements) const;
+
+   //! the name of the sidecar file for an XML file
+   static std::string sidecarName(const std::string& filename) { return filename + ".xdfp"; }
+
+
+private:
+   FingerprintCache(const FingerprintCache&);     // not supported
+   void operator=(const FingerprintCache&);       // not supported
+
+   std::string mFilename;
+   unsigned long long mConfigHash;
+   std::vector<XmlFingerprint::Entry> mEntries;
+};
+
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef OutputSink_h
+#define OutputSink_h 1
+
+/**
+ * @file OutputSink.h
+ * @brief contains prototypes and class declarations for class OutputSink
+ *
+ */
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+
+/**
+ * @class OutputSink
+ * @brief Stream buffer that collects output in large blocks before writing it.
+ *
+ * Put an ostream on top of it and write to that.  The characters go into a
+ * block of memory that is only written to the file (stdout unless open() is
+ * called) when it is full, so one write is made for many lines.  Flushing the
+ * ostream, as endl does, does not write anything; call finish() at the end to
+ * write what is left and to learn whether all of the output was written.  The
+ * destructor calls finish() too.
+ *
+ * After startWriter() the full blocks are written by a separate thread while
+ * the program carries on filling the next block.  At most a few blocks wait to
+ * be written; if the writer falls behind, the program waits for it.  The
+ * blocks are reused, so no memory is allocated once the output is going.
+ */
+
+class OutputSink : public std::streambuf
+{
+
+public:
+   //! Constructor, writes to stdout
+   /*!
+    * @param aBlockSize number of characters collected before they are written
+    */
+   OutputSink(size_t aBlockSize = 1 << 20);
+
+   //! Destructor, writes any output left
+   ~OutputSink();
+
+   //! write to this file instead of stdout.  Returns true if the file cannot be opened
+   bool open(const std::string& filename);
+
+   //! write the bytes as they are, without turning '\n' into "\r\n" on Windows
+   void setBinary();
+
+   //! write the full blocks on a separate thread, with no more than maxQueued blocks waiting
+   void startWriter(size_t maxQueued = 4);
+
+   //! write everything collected so far, wait for it to be written, stop the writer thread and close the file.
+   //! Returns true if any of the output could not be written
+   bool finish();
+
+
+protected:
+   //! the block is full: hand it over to be written and start another
+   virtual int_type overflow(int_type c);
+   //! copy n characters into the block
+   virtual std::streamsize xsputn(const char* s, std::streamsize n);
+   //! does nothing, the output is only written when a block is full or at finish()
+   virtual int sync() { return 0; }
+
+
+private:
+   OutputSink(const OutputSink&);        // not supported
+   void operator=(const OutputSink&);    // not supported
+
+   //! hand the characters in the current block over to be written and get an empty block
+   void handOver();
+   //! make the block the put area, emptied and mBlockSize characters big
+   void startBlock(std::vector<char>* block);
+   //! write the block to the file
+   void write(const std::vector<char>& block);
+   //! loop run by the writer thread until finish() is called
+   void writer();
+
+   size_t mBlockSize;                        //!< characters in a full block
+   FILE* mFile;                              //!< where the output goes
+   bool mCloseFile;                          //!< the file was opened by open() and must be closed
+   bool mBinary;                             //!< no newline translation
+   bool mFailed;                             //!< a write, flush or close failed, some output is lost
+   std::vector<char>* mBlock;                //!< block being filled, its characters are the put area
+
+   std::thread mWriter;                      //!< thread writing the blocks, if started
+   bool mWriterRunning;                      //!< true from startWriter() to finish()
+   size_t mMaxQueued;                        //!< most blocks waiting to be written
+   std::mutex mLock;                         //!< guards the members below
+   std::condition_variable mChanged;         //!< signalled when a block is queued or written, or on finish
+   std::deque<std::vector<char>*> mQueued;   //!< full blocks waiting to be written, in order
+   std::vector<std::vector<char>*> mFree;    //!< written blocks to reuse
+   bool mStopping;                           //!< finish() was called, the writer stops once the queue is empty
+};
+
+
+#endif
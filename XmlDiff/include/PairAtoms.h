@@ -0,0 +1,45 @@
+#ifndef PairAtoms_h
+#define PairAtoms_h 1
+
+/**
+ * @file PairAtoms.h
+ * @brief contains prototypes and class declarations for class PairAtoms
+ *
+ */
+
+#include "tinyxml2.h"
+
+
+
+/**
+ * @class PairAtoms
+ * @brief the atom table the two documents of a pair intern their names in
+ *
+ * The tags and attribute names of both files are interned in one table as they
+ * are parsed, so compareXmlElement and compareXmlAttribs match them by their atoms
+ * (see matchName) instead of by their characters.  The documents are only given
+ * the table while it is in scope; each pair of a --batch has a table of its own.
+ */
+
+class PairAtoms
+{
+
+public:
+   //! Constructor, gives both documents the table
+   PairAtoms(tinyxml2::XMLDocument& doc1, tinyxml2::XMLDocument& doc2);
+
+   //! Destructor, takes the table back from the documents
+   ~PairAtoms();
+
+
+private:
+   PairAtoms(const PairAtoms&);           // not supported
+   void operator=(const PairAtoms&);      // not supported
+
+   tinyxml2::XMLAtomTable mAtoms;
+   tinyxml2::XMLDocument& mDoc1;
+   tinyxml2::XMLDocument& mDoc2;
+};
+
+
+#endif
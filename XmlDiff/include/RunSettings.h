@@ -91,6 +91,11 @@ public:
    std::string getDelim() const { return mDelimiters; }
    bool delimSet() const { return mDelimitersSet; }
 
+   // get or set the names of the attributes compared, separated by commas, or "all" (--attribs)
+   void setAttribs(const std::string& aList);
+   const std::string& getAttribs() const { return mAttribs; }
+   bool attribsSet() const { return mAttribsSet; }
+
    void setReformat(bool r) { mReformat = r; }
    bool getReformat() const { return mReformat; }
 
@@ -102,6 +107,72 @@ public:
    bool setConfig(const std::string& filename);   // return true if error
    const XMLDocument* getConfig() const { return &mConfigXml; }
 
+   // get or set the number of threads to compare with
+   void setJobs(unsigned int n) { mJobs = (n > 0 ? n : 1); }
+   unsigned int getJobs() const { return mJobs; }
+
+   // get or set the flag to compare the files as they are read instead of loading them first
+   void setStreaming(bool r) { mStreaming = r; }
+   bool getStreaming() const { return mStreaming; }
+
+   // get or set the manifest file listing the pairs of files to compare (--batch)
+   void setBatchFile(const std::string& filename) { mBatchFile = filename; }
+   const std::string& getBatchFile() const { return mBatchFile; }
+
+   // get or set the file the output is written to, empty for stdout (--output)
+   void setOutputFile(const std::string& filename) { mOutputFile = filename; }
+   const std::string& getOutputFile() const { return mOutputFile; }
+
+   // get or set the flag to write the output on a separate thread
+   void setAsyncOutput(bool r) { mAsyncOutput = r; }
+   bool getAsyncOutput() const { return mAsyncOutput; }
+
+   // get or set the output format: text, jsonl or binary (--format)
+   void setFormat(const std::string& aFormat) { mFormat = aFormat; }
+   const std::string& getFormat() const { return mFormat; }
+
+   // get or set the flag to skip subtrees whose fingerprints are the same in both files
+   void setSkipSame(bool r) { mSkipSame = r; }
+   bool getSkipSame() const { return mSkipSame; }
+
+   // get or set the flag to keep the fingerprints of file 1 in a sidecar file for the next run
+   void setFingerprintCache(bool r) { mFingerprintCache = r; }
+   bool getFingerprintCache() const { return mFingerprintCache; }
+
+   // get or set the flag to load file 1 from a snapshot kept from the last run, and to make one
+   void setSnapshot(bool r) { mSnapshot = r; }
+   bool getSnapshot() const { return mSnapshot; }
+
+   // get or set the format of the run statistics written at the end: text or json, empty for none
+   void setStats(const std::string& aFormat) { mStats = aFormat; }
+   const std::string& getStats() const { return mStats; }
+
+   // get or set the flag to only find out if the files are the same, stopping at the first difference
+   void setQuick(bool r) { mQuick = r; }
+   bool getQuick() const { return mQuick; }
+
+   // get or set the most differences to write before stopping, 0 for no limit
+   void setMaxDiffs(unsigned int n) { mMaxDiffs = n; }
+   unsigned int getMaxDiffs() const { return mMaxDiffs; }
+   // the most differences to write before stopping: --max-diffs, else 1 with --quick, else 0 for no limit
+   unsigned int diffLimit() const { return (mMaxDiffs > 0 ? mMaxDiffs : (mQuick ? 1 : 0)); }
+
+   // get or set the seconds the comparison may take before stopping, 0 for no limit
+   void setTimeout(double seconds) { mTimeout = (seconds > 0.0 ? seconds : 0.0); }
+   double getTimeout() const { return mTimeout; }
+
+   // get or set the flag to pair child elements by name (or tag and order) instead of by position
+   void setAlign(bool r) { mAlign = r; }
+   bool getAlign() const { return mAlign; }
+
+   // get or set the number of pairs shown around each difference with --side, -1 to show every pair
+   void setSideContext(int n) { mSideContext = (n >= 0 ? n : -1); }
+   int getSideContext() const { return mSideContext; }
+
+   // get or set the flag to load input files through a memory mapping instead of reading them
+   void setMemoryMapped(bool r) { mMemoryMapped = r; }
+   bool getMemoryMapped() const { return mMemoryMapped; }
+
    // Get the value of flag that indicates if the version number is to be shown
    bool showVersion() const { return mShowVersion; }
    void showVersion( const bool p ) { mShowVersion = p; }
@@ -136,8 +207,26 @@ private:
    bool mCaseSensitiveSet;          //!< true if case-sensitive switch was set on command-line
    std::string mDelimiters;         //!< delimiter characters to use when tokenizing strings
    bool mDelimitersSet;             //!< true if delimiters has been set
+   std::string mAttribs;            //!< names of the attributes compared, or "all"
+   bool mAttribsSet;                //!< true if the attributes have been set
    bool mReformat;                  //!< output the reformatted XML document to files
    bool mSideBySide;                //!< show inputs side by side
+   int mSideContext;                //!< with mSideBySide, pairs shown before and after a difference, -1 for all
+   bool mMemoryMapped;              //!< load input files with a memory mapping
+   bool mStreaming;                 //!< compare while reading, without loading whole documents
+   unsigned int mJobs;              //!< number of threads to compare subtrees on
+   bool mSkipSame;                  //!< skip subtrees with the same fingerprint in both files
+   bool mFingerprintCache;          //!< read and write the fingerprints of file 1 in a sidecar file
+   bool mSnapshot;                  //!< read and write file 1 as a binary snapshot in a sidecar file
+   bool mAlign;                     //!< pair child elements by key instead of by position
+   bool mQuick;                     //!< stop at the first difference, exit status tells if the files differ
+   unsigned int mMaxDiffs;          //!< stop after writing this many differences, 0 for no limit
+   double mTimeout;                 //!< stop after this many seconds, 0 for no limit
+   std::string mBatchFile;          //!< manifest of file pairs to compare, empty to compare two files
+   std::string mOutputFile;         //!< write the output to this file, empty for stdout
+   bool mAsyncOutput;               //!< write the output on a separate thread
+   std::string mStats;              //!< write the run statistics in this format (text or json), empty for none
+   std::string mFormat;             //!< format of the differences: text, jsonl or binary
    XMLDocument mConfigXml;          //!< configuration file
    bool mShowVersion;               //!< show version number and quit
    bool mShowUsage;                 //!< show program usage and quit
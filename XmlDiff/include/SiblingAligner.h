@@ -0,0 +1,130 @@
+#ifndef SiblingAligner_h
+#define SiblingAligner_h 1
+
+/**
+ * @file SiblingAligner.h
+ * @brief contains prototypes and class declarations for class SiblingAligner
+ *
+ */
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tinyxml2.h"
+
+
+
+/**
+ * @class SiblingAligner
+ * @brief Pairs the child elements of two elements by key instead of by position (--align).
+ *
+ * Comparing siblings by position means one element added near the top of a
+ * list shifts every pair after it, and each of those pairs is reported as
+ * differing.  align() instead pairs the siblings this way:
+ *
+ *  - Elements with a name attribute (the name the model tree shows) are
+ *    paired by name, the first "x" in file 1 with the first "x" in file 2
+ *    and so on, through a hash table.  The longest run of these pairs that
+ *    is in the same order in both files anchors the alignment; the other
+ *    named pairs are elements that moved, and are still paired.
+ *  - The elements without a name between two anchors are lined up with a
+ *    longest common subsequence of their content hashes (the fingerprint of
+ *    the subtree if the document has one, else the hash of the tag,
+ *    attributes and text).  Only a window of 'window' elements either side of
+ *    the diagonal is searched, so this is linear in the length of the run.
+ *    The elements left over between two matches are paired by tag and
+ *    ordinal, and so is a run too long for the search.
+ *  - An element still without a pair is only in its own file, and is given
+ *    with a null partner.
+ *
+ * The pairs come out in the order of file 1, each element only in file 2
+ * just before the pair that follows it in file 2.  When the two lists have
+ * the same names in the same places, and the same content where there is no
+ * name, they are simply paired by position.  The tables are kept between
+ * calls, so keep one aligner per thread.
+ */
+
+class SiblingAligner
+{
+
+public:
+   //! two elements to compare, or one element and a null if it is only in one file
+   struct Pair
+   {
+      Pair(tinyxml2::XMLElement* aElement1, tinyxml2::XMLElement* aElement2) : element1(aElement1), element2(aElement2) {}
+
+      tinyxml2::XMLElement* element1;
+      tinyxml2::XMLElement* element2;
+   };
+
+   //! Constructor
+   /*!
+    * @param aCaseSensitive true if names and tags are matched with case sensitivity
+    * @param aWindow how far from the diagonal the common subsequence search looks
+    */
+   SiblingAligner(bool aCaseSensitive, size_t aWindow = 32);
+
+   //! pair first1 and its following siblings with first2 and its following siblings.  The pairs are added to 'pairs'
+   void align(tinyxml2::XMLElement* first1, tinyxml2::XMLElement* first2, std::vector<Pair>& pairs);
+
+
+private:
+   //! one of the siblings being aligned
+   struct Sibling
+   {
+      tinyxml2::XMLElement* element;
+      const char* name;                //!< value of the name attribute, or null
+      unsigned long long key;          //!< hash of the name, or of the tag if there is no name
+      unsigned long long content;      //!< hash of the subtree, for the common subsequence
+      int partner;                     //!< index of the paired sibling in the other file, or -1
+      bool anchor;                     //!< a named pair in the same order in both files
+   };
+
+   SiblingAligner(const SiblingAligner&);        // not supported
+   void operator=(const SiblingAligner&);        // not supported
+
+   //! fill 'siblings' with first and the siblings after it
+   void collect(tinyxml2::XMLElement* first, std::vector<Sibling>& siblings) const;
+   //! true if the two lists can be paired by position
+   bool samePlaces() const;
+   //! pair the named siblings, the k-th of a name in file 1 with the k-th in file 2
+   void pairNames();
+   //! mark the longest run of named pairs that is in order in both files as anchors
+   void findAnchors();
+   //! pair the siblings without a name in [begin1,end1) of file 1 and [begin2,end2) of file 2
+   void alignRun(size_t begin1, size_t end1, size_t begin2, size_t end2);
+   //! pair mRun1 and mRun2 by a common subsequence of their content hashes, then by tag
+   void pairCommon();
+   //! pair mRun1[begin1,end1) and mRun2[begin2,end2) by tag and ordinal
+   void pairTags(size_t begin1, size_t end1, size_t begin2, size_t end2);
+   //! pair sibling i of file 1 with sibling j of file 2
+   void setPartners(size_t i, size_t j);
+
+   //! true if the names (or tags) of two siblings are the same
+   bool sameKey(const Sibling& s1, const Sibling& s2) const;
+   //! true if the tags of two elements are the same
+   bool sameTag(const tinyxml2::XMLElement* e1, const tinyxml2::XMLElement* e2) const;
+   //! add the characters to the hash, folded to lower case unless case sensitive
+   unsigned long long hashName(unsigned long long hash, const char* p) const;
+
+   bool mCaseSensitive;
+   size_t mWindow;
+   std::vector<Sibling> mSiblings1;             //!< siblings of file 1
+   std::vector<Sibling> mSiblings2;             //!< siblings of file 2
+   std::vector<size_t> mRun1;                   //!< siblings without a name in the run being aligned, file 1
+   std::vector<size_t> mRun2;                   //!< and file 2
+   std::unordered_map<unsigned long long, unsigned int> mCounts;     //!< number of each name so far
+   std::unordered_map<unsigned long long, unsigned int> mKeys;       //!< name and ordinal to file 2 index
+   std::unordered_map<unsigned long long, size_t> mFirst;            //!< tag to first unpaired in a run
+   std::vector<size_t> mNext;                   //!< next of the same tag in a run
+   std::vector<int> mValues;                    //!< common subsequence lengths, two rows
+   std::vector<unsigned char> mSteps;           //!< common subsequence steps, the cells of each row in turn
+   std::vector<size_t> mRowStart;               //!< where each row starts in mSteps
+   std::vector<std::pair<size_t, size_t> > mMatches;   //!< the common subsequence, mRun1 and mRun2 indexes
+   std::vector<size_t> mTails;                  //!< longest ordered run search: index of the last pair of each length
+   std::vector<int> mLinks;                     //!< and the pair before each pair in the run
+};
+
+
+#endif
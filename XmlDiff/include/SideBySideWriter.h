@@ -0,0 +1,82 @@
+#ifndef SideBySideWriter_h
+#define SideBySideWriter_h 1
+
+/**
+ * @file SideBySideWriter.h
+ * @brief contains prototypes and class declarations for class SideBySideWriter
+ *
+ */
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "tinyxml2.h"
+
+
+
+/**
+ * @class SideBySideWriter
+ * @brief Writes the pairs of elements compared side by side (--side), all of them or only those near a difference (--context).
+ *
+ * Each element is shown as its tag, its attributes in order of their (lower
+ * case) names and its text, wrapped to the margin, with file 1 on the left and
+ * file 2 on the right.
+ *
+ * With a context of -1 every pair is written as it is given to pair().  With a
+ * context of N the pairs are held back instead: the last N+1 are kept in a ring,
+ * and difference() writes them out when the pair being compared has a
+ * difference, so the pair is shown with the N pairs before it.  The N pairs
+ * after it are written as they come.  A line of "--" marks where pairs were
+ * left out.  The text of the pairs held is kept in strings that are reused, so
+ * the elements may be deleted once they are compared (--stream).
+ */
+
+class SideBySideWriter
+{
+
+public:
+   //! Constructor
+   /*!
+    * @param aContext the number of pairs to show before and after a pair with a difference, -1 to show every pair
+    * @param aMargin the width of each side
+    */
+   SideBySideWriter(int aContext, size_t aMargin = 80);
+
+   //! the next pair of elements being compared.  Written now, or held until it is known if it is needed
+   void pair(std::ostream& out, const tinyxml2::XMLElement* elem1, const tinyxml2::XMLElement* elem2);
+
+   //! the last pair given has a difference: write it and the pairs held before it, if not written already
+   void difference(std::ostream& out);
+
+
+private:
+   //! the text of the two elements of a pair
+   struct Pair
+   {
+      std::string text1;
+      std::string text2;
+   };
+
+   SideBySideWriter(const SideBySideWriter&);     // not supported
+   void operator=(const SideBySideWriter&);       // not supported
+
+   //! the element as one line of text, in 'text'
+   static void render(const tinyxml2::XMLElement* elem, std::string& text);
+   //! write the two texts side by side
+   void write(std::ostream& out, const Pair& pair);
+
+   int mContext;
+   size_t mMargin;
+   std::vector<Pair> mRing;      //!< the pairs held, at most mContext+1
+   size_t mFirst;                //!< index in mRing of the oldest pair held
+   size_t mHeld;                 //!< number of pairs held, the last one is the current pair
+   int mTrailing;                //!< pairs still to write after the last difference
+   bool mCurrentShown;           //!< the current pair has been written (or there is none)
+   bool mSkipped;                //!< pairs were left out since the last one written
+   bool mAnyShown;               //!< a pair has been written
+   std::string mLine;            //!< one line of the output, reused
+};
+
+
+#endif
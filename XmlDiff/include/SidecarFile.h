@@ -0,0 +1,57 @@
+#ifndef SidecarFile_h
+#define SidecarFile_h 1
+
+/**
+ * @file SidecarFile.h
+ * @brief contains prototypes and class declarations for class SidecarFile
+ *
+ */
+
+#include <cstdio>
+#include <string>
+
+
+
+/**
+ * @class SidecarFile
+ * @brief Helpers for the files kept next to an input file between runs (--cache, --snapshot).
+ *
+ * A sidecar holds something worked out from its file, so it is only good
+ * while the file has the same key (its size and modification time, to the
+ * finest the file system keeps).  It is written under a temporary name and
+ * then put in place with replace(), so another run reading it, or writing it
+ * at the same time, never sees half of one.
+ *
+ * A file changed again in the same clock tick the sidecar was written in
+ * keeps its key, so as with the "racy" entries of git's index, a sidecar is
+ * only written or used if it was written after the last change of its file
+ * (see writtenAfter()).
+ */
+
+class SidecarFile
+{
+
+public:
+   //! the size and modification time of a file, the time in the finest units the system gives.
+   //! Returns false if it cannot be found
+   static bool fileKey(const std::string& filename, unsigned long long& size, long long& modified);
+
+   //! true if the sidecar (or its temporary file) was modified after the time 'modified' from fileKey() of its file
+   static bool writtenAfter(const std::string& sidecar, long long modified);
+
+   //! a name to write the sidecar 'name' under before replace().  No other process or thread gets the same name
+   static std::string temporaryName(const std::string& name);
+
+   //! create the file 'temporary' for writing in binary.  Returns null if it already exists or cannot be created
+   static FILE* create(const std::string& temporary);
+
+   //! put the file written as 'temporary' in place as 'name'.  Returns true on error, and the temporary file is removed
+   static bool replace(const std::string& temporary, const std::string& name);
+
+
+private:
+   SidecarFile();                                 // not supported
+};
+
+
+#endif
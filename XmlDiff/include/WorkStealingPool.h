@@ -0,0 +1,80 @@
+#ifndef WorkStealingPool_h
+#define WorkStealingPool_h 1
+
+/**
+ * @file WorkStealingPool.h
+ * @brief contains prototypes and class declarations for class WorkStealingPool
+ *
+ */
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+
+/**
+ * @class WorkStealingPool
+ * @brief Runs a batch of independent tasks on a fixed number of threads.
+ *
+ * Tasks are added with add() and then all run by run(), which returns once
+ * every task is finished.  The tasks are handed out to the threads in
+ * contiguous blocks, in the order they were added.  Each thread takes tasks
+ * from the front of its own queue; a thread that runs out takes one from the
+ * back of another thread's queue, so threads that got the cheap tasks help out
+ * the ones that got the expensive ones.
+ *
+ * Tasks must not add tasks to the pool.  The thread calling run() is used as
+ * one of the worker threads.
+ */
+
+class WorkStealingPool
+{
+
+public:
+   typedef std::function<void()> Task;
+
+   //! Constructor
+   /*!
+    * @param aThreads number of threads to run tasks on (at least 1)
+    */
+   WorkStealingPool(unsigned int aThreads);
+
+   //! Destructor
+   ~WorkStealingPool();
+
+   //! add a task to be run by the next call to run()
+   void add(const Task& task) { mPending.push_back(task); }
+
+   //! run all tasks that have been added and wait for them to finish
+   void run();
+
+   //! number of threads tasks are run on
+   unsigned int threads() const { return static_cast<unsigned int>(mQueues.size()); }
+
+
+private:
+   WorkStealingPool(const WorkStealingPool&);     // not supported
+   void operator=(const WorkStealingPool&);       // not supported
+
+   //! task queue for one thread
+   struct Queue
+   {
+      std::mutex lock;
+      std::deque<Task> tasks;
+   };
+
+   //! loop run by worker thread 'id' until no tasks are left anywhere
+   void work(unsigned int id);
+   //! take the next task from thread id's own queue.  Returns false if empty
+   bool takeOwn(unsigned int id, Task& task);
+   //! take a task from the back of another thread's queue.  Returns false if all are empty
+   bool steal(unsigned int id, Task& task);
+
+   std::vector<Queue*> mQueues;      //!< one queue per thread
+   std::vector<Task> mPending;       //!< tasks added since the last run()
+};
+
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef XmlAttributeSet_h
+#define XmlAttributeSet_h 1
+
+/**
+ * @file XmlAttributeSet.h
+ * @brief contains prototypes and class declarations for class XmlAttributeSet
+ *
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+
+/**
+ * @class XmlAttributeSet
+ * @brief The names of the attributes that are compared (<Attribs> in the config file, --attribs).
+ *
+ * contains() is asked about every attribute of every element in both files,
+ * so the names are put in a perfect hash table when they are set: the hash of
+ * each name (folded to lower case unless the comparison is case sensitive)
+ * lands in a slot of its own.  A lookup goes over the name once to get its
+ * length and hash, turns away names of a length no wanted name has, and then
+ * compares with the one name in its slot.  Nothing is allocated.
+ *
+ * The set may also be "all", when every attribute is compared.  The default
+ * is name and type.
+ */
+
+class XmlAttributeSet
+{
+
+public:
+   //! Constructor, the set of name and type, not case sensitive
+   XmlAttributeSet();
+
+   //! set the names from a list separated by commas or white space, or "all" (or "*") for every attribute
+   void set(const std::string& aList);
+
+   //! set the case sensitivity of the names (true=yes it is case sensitive)
+   void caseSensitive(bool aFlag);
+
+   //! is an attribute with this name compared?
+   bool contains(const char* aName) const;
+
+   //! true if every attribute is compared
+   bool all() const { return mAll; }
+
+   //! the names in the order they were set, without repeats.  Empty if all()
+   const std::vector<std::string>& names() const { return mNames; }
+
+   //! write the set to the stream in human-readable format
+   void show(std::ostream& stream = std::cout) const;
+
+
+private:
+   //! fold a character to lower case
+   static char lower(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; }
+
+   //! the bit in mLengths for names of this length; names of 63 characters or more share the last bit
+   static unsigned long long lengthBit(size_t length) { return 1ULL << (length < 63 ? length : 63); }
+
+   //! hash of the name, folded to lower case unless case sensitive
+   unsigned long long hashName(const char* aName, size_t& length) const;
+
+   //! the slot for a hash
+   size_t slotOf(unsigned long long hash, unsigned long long seed, size_t mask) const;
+
+   //! make the hash table for mNames
+   void build();
+
+   std::vector<std::string> mNames;    //!< as they were set
+   bool mAll;                          //!< every attribute is compared
+   bool mCaseSensitive;
+   std::vector<std::string> mSlots;    //!< hash table, each name in a slot of its own (folded unless case sensitive), empty if no name
+   size_t mMask;                       //!< the number of slots minus 1
+   unsigned long long mSeed;           //!< mixed into each hash so that no two names share a slot
+   unsigned long long mLengths;        //!< the lengthBit() of each name
+};
+
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef XmlAttributeView_h
+#define XmlAttributeView_h 1
+
+/**
+ * @file XmlAttributeView.h
+ * @brief contains prototypes and class declarations for class XmlAttributeView
+ *
+ */
+
+#include <vector>
+
+#include "tinyxml2.h"
+
+
+
+/**
+ * @class XmlAttributeView
+ * @brief The attributes of an XML element, read in place from the element.
+ *
+ * Used in place of copying the attributes into a map of lower case names to
+ * values for every element compared.  The names and values are pointers to the
+ * strings tinyxml2 already holds, and up to MaxInline of them are kept in the
+ * object itself, so making one on the stack does not allocate.
+ *
+ * Attribute names are matched without case, as if they had been lower cased:
+ * if an element has two attributes whose names differ only in case (which XML
+ * allows) only the last one is kept, the same as a map keyed on the lower case
+ * name would.  The attributes are in document order until sortByName() is called.
+ * The view must not outlive the element.
+ */
+
+class XmlAttributeView
+{
+
+public:
+   //! one attribute: pointers into the element
+   struct Attribute
+   {
+      const char* name;
+      const char* value;
+   };
+
+   //! attributes kept without allocating
+   static const size_t MaxInline = 16;
+
+   //! Constructor reads the attributes of the element (which may be null)
+   explicit XmlAttributeView(const tinyxml2::XMLElement* elem);
+
+   //! number of attributes
+   size_t size() const { return mSize; }
+   //! attribute i, for i < size()
+   const Attribute& operator[](size_t i) const { return mData[i]; }
+
+   //! value of the attribute with this name, compared without case.  Null if there is none
+   const char* find(const char* name) const;
+
+   //! put the attributes in order of their lower case names
+   void sortByName();
+
+   //! true if the two names are the same without case
+   static bool equalNoCase(const char* a, const char* b);
+   //! true if 'name' lower cased is the same as 'lowerName', e.g. "Type" and "type" (but not "TYPE" and "Type")
+   static bool equalLowered(const char* name, const char* lowerName);
+   //! compare the lower case forms of a and b: less than, equal to or greater than 0 like strcmp()
+   static int compareNoCase(const char* a, const char* b);
+
+
+private:
+   XmlAttributeView(const XmlAttributeView&);       // not supported
+   void operator=(const XmlAttributeView&);         // not supported
+
+   Attribute mInline[MaxInline];     //!< the attributes, unless there are more than MaxInline
+   std::vector<Attribute> mMore;     //!< the attributes of an element with more than MaxInline
+   Attribute* mData;                 //!< mInline or the data of mMore
+   size_t mSize;
+};
+
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef XmlBatch_h
+#define XmlBatch_h 1
+
+/**
+ * @file XmlBatch.h
+ * @brief contains prototypes and class declarations for class XmlBatch
+ *
+ */
+
+#include <functional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tinyxml2.h"
+#include "MU_RunStats.h"
+
+#include "DiffBudget.h"
+#include "DiffRecordWriter.h"
+#include "RunSettings.h"
+#include "XmlDifferences.h"
+#include "XmlDocumentPool.h"
+
+
+
+/**
+ * @class XmlBatch
+ * @brief Compares every pair of files listed in a --batch manifest.
+ *
+ * Each line of the manifest holds two file names separated by white space,
+ * or by a tab if the names have spaces in them.  Blank lines and lines
+ * starting with '#' are skipped.
+ *
+ * The pairs are compared several at a time on the --jobs threads, a chunk of
+ * pairs at a time so the output waiting to be written stays small.  The
+ * differences and summary of each pair are written in manifest order,
+ * followed by the totals for the whole batch.  Each pair of files has its
+ * own path ids.  The documents are reused from one pair to the next.
+ */
+
+class XmlBatch
+{
+
+public:
+   //! compares one pair of files into the documents given, writing the differences to the stream (see compareXmlPair)
+   typedef std::function<bool(const std::string& filename1, const std::string& filename2, tinyxml2::XMLDocument& doc1,
+      tinyxml2::XMLDocument& doc2, XmlDifferences& totDiff, std::ostream& out, DiffRecordWriter* records,
+      DiffBudget* budget)> PairCompare;
+
+   //! Constructor
+   /*!
+    * @param aRunSettings the program settings, giving the manifest, --jobs, --quick and the total file
+    * @param aCompare compares one pair of files, called on the pool threads
+    * @param aStats where the memory pools of the documents are added (--stats), null for none
+    */
+   XmlBatch(const RunSettings& aRunSettings, const PairCompare& aCompare, MU_RunStats* aStats);
+
+   //! compare every pair, writing to 'out' as records if 'records' is not null.  Returns the program exit code:
+   //! 1 if any pair could not be compared or the manifest has bad lines, else 0, or with --quick the
+   //! DiffBudget::quickStatus() of all the pairs
+   int run(std::ostream& out, const DiffRecordWriter* records, const DiffBudget::Clock::time_point* deadline);
+
+
+private:
+   XmlBatch(const XmlBatch&);                     // not supported
+   void operator=(const XmlBatch&);               // not supported
+
+   //! one pair of files from the manifest and the result of comparing them
+   class FilePair
+   {
+   public:
+      FilePair(DiffRecordWriter::Format aFormat) : filename1(), filename2(), error(false), stopped(DiffBudget::NotStopped),
+         out(), records(aFormat), totDiff() {}
+
+      std::string filename1;
+      std::string filename2;
+      bool error;                   // the files could not be compared
+      DiffBudget::Reason stopped;   // why the comparison stopped early, if it did
+      std::ostringstream out;       // differences and summary for this pair
+      DiffRecordWriter records;     // the paths of this pair, if the output is records
+      XmlDifferences totDiff;       // counts for this pair
+   };
+
+   //! read the file pairs from the manifest.  Lines without two names are reported to 'out' and
+   //! counted in 'nBadLines'.  Returns true if the manifest could not be opened
+   bool readManifest(std::vector<std::pair<std::string, std::string> >& files, unsigned int& nBadLines, std::ostream& out,
+      const DiffRecordWriter* records) const;
+
+   //! compare one pair of files.  Runs on a pool thread
+   void comparePair(FilePair* filePair, XmlDocumentPool* docs, const DiffBudget::Clock::time_point* deadline) const;
+
+   const RunSettings& mRunSettings;
+   PairCompare mCompare;
+   MU_RunStats* mStats;
+};
+
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef XmlDifferences_h
+#define XmlDifferences_h 1
+
+/**
+ * @file XmlDifferences.h
+ * @brief contains prototypes and class declarations for class XmlDifferences
+ *
+ */
+
+#include <ostream>
+
+#include "DiffRecordWriter.h"
+
+
+
+/**
+ * @class XmlDifferences
+ * @brief contains count on the number of differences between the two files
+ */
+
+class XmlDifferences
+{
+
+public:
+   XmlDifferences();
+   ~XmlDifferences() {}
+
+   unsigned int Total() const                // return total number of differences
+   {
+      return totalDifferentTypeElem + extraElemFile1 + extraElemFile2 + elemWithAttribNameDiff + elemWithAttribValueDiff + elemWithTextDiff
+         + elemDeleted + elemInserted;
+   }
+
+   // add in the counts from a later part of the same comparison.  the extra element
+   // counts are replaced rather than added, same as when comparing on one thread
+   void add(const XmlDifferences& p);
+
+   // add in the counts from the comparison of another pair of files (--batch).  all counts are added
+   void addFile(const XmlDifferences& p);
+
+   // the counts for a summary record
+   DiffRecordWriter::Summary summary() const;
+
+   // write the counts, as a summary record if 'records' is not null
+   void write(std::ostream& os, const DiffRecordWriter* records) const;
+
+   unsigned int totalElemCompared;           // total number of elements compared
+   unsigned int totalDifferentTypeElem;      // encountered tags of different type (e.g. <var> vs <group>)
+   unsigned int extraElemFile1;              // number of extra elements in file 1 after file 2 hits eof
+   unsigned int extraElemFile2;              // number of extra elements in file 2 after file 1 hits eof
+   unsigned int elemWithAttribNameDiff;      // number of tags with one or more attribute name differences
+   unsigned int elemWithAttribValueDiff;     // number of tags with one or more attribute value differences
+   unsigned int elemWithTextDiff;            // number of tags with inner text differs
+   unsigned int totalTagNumbContentDiff;     // number of number token differences inside a tag
+   unsigned int totalTagTextContentDiff;     // number of text token differences inside a tag
+   unsigned int elemDeleted;                 // number of elements only in file 1 (--align)
+   unsigned int elemInserted;                // number of elements only in file 2 (--align)
+   unsigned long long totalTokensCompared;   // number of pairs of tokens compared (--stats)
+   unsigned long long totalNumbersCompared;  // number of those that were both numbers (--stats)
+
+private:
+   friend std::ostream& operator<<(std::ostream &os, const XmlDifferences& p);
+};
+
+std::ostream& operator<<(std::ostream &os, const XmlDifferences& p);
+
+
+#endif
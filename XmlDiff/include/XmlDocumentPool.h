@@ -0,0 +1,59 @@
+#ifndef XmlDocumentPool_h
+#define XmlDocumentPool_h 1
+
+/**
+ * @file XmlDocumentPool.h
+ * @brief contains prototypes and class declarations for class XmlDocumentPool
+ *
+ */
+
+#include <mutex>
+#include <vector>
+
+#include "tinyxml2.h"
+#include "MU_RunStats.h"
+
+
+
+/**
+ * @class XmlDocumentPool
+ * @brief documents kept for reuse by the --batch threads
+ *
+ * A document that is cleared keeps the memory pools its elements, attributes
+ * and text were allocated from, so loading the next file into it does not
+ * have to allocate them again.  Any thread can take a document and give it back.
+ */
+
+class XmlDocumentPool
+{
+
+public:
+   //! Constructor, an empty pool
+   XmlDocumentPool();
+
+   //! Destructor, deletes the documents given back
+   ~XmlDocumentPool();
+
+   //! a cleared document, new if none are free
+   tinyxml2::XMLDocument* take();
+
+   //! give back a document from take().  It is cleared so the file it held is released
+   void give(tinyxml2::XMLDocument* doc);
+
+   //! add the memory pools of the documents given back to the stats.  Each one has held several files
+   void addMemPoolStats(MU_RunStats& stats);
+
+   //! add the memory pools of one document to the stats
+   static void addMemPoolStats(MU_RunStats& stats, const tinyxml2::XMLDocument& doc);
+
+
+private:
+   XmlDocumentPool(const XmlDocumentPool&);       // not supported
+   void operator=(const XmlDocumentPool&);        // not supported
+
+   std::mutex mLock;
+   std::vector<tinyxml2::XMLDocument*> mFree;
+};
+
+
+#endif
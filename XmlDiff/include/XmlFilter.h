@@ -11,10 +11,11 @@
 #include <iostream>
 #include <string>
 #include <cstring>
-#include <map>
+#include <vector>
 
 #include "tinyxml2.h"
 #include "MU_StringUtil.h"
+#include "XmlAttributeView.h"
 
 
 using namespace tinyxml2;
@@ -40,9 +41,13 @@ using namespace std;
  * checked must have the same tag name and all of the attributes that are in
  * the filter. The element can have additioinal attributes and still be a match.
  *
- * For speed, this function keeps the map of attributes both as a case-
- * insensitive and case-sensitive map so either one can be used.  This is
- * something to consider improving when time permits.
+ * The attributes are kept in one flat array sorted by name.  Their names are
+ * also folded to lower case once, when the filter is made, into a second flat
+ * array sorted by the folded name.  An element's attribute name is looked up
+ * with a binary search on it, lowering the element's name as it is compared,
+ * so nothing is copied or folded again for each element.  A set of many
+ * filters is matched through XmlFilterSet, which only tries the filters with
+ * the element's tag name.
  *
  */
 
@@ -111,20 +116,20 @@ public:
    void caseSensitive(bool aFlag) { mCaseSensitive = aFlag; }
 
    //! does input tag match this one.  will do case-sensitive or case-insensitive depending on member
-   bool matchTag(const std::string& aTag) const {
-      return (mCaseSensitive ? aTag == mTagName : MU_StringUtil::Strcasecmp(aTag, mTagName));
+   bool matchTag(const char* aTag) const {
+      return (mCaseSensitive ? mTagName == aTag : MU_StringUtil::Strcasecmp(aTag, mTagName));
    }
 
    //! does this attribute match one of the filter attributes? (name & value)
    bool matchAttrib(const std::string& attrib, const std::string& attribValue) const;
-   //! check to see if any in a list (map) of attributes match in the filter
-   bool matchAnyAttrib(const std::map<std::string, std::string>& attribs) const;
+   //! check to see if any of the attributes of an element match in the filter
+   bool matchAnyAttrib(const XmlAttributeView& attribs) const;
 
    //! check to see if all attributes in filter are also in the attributes being passed in
-   bool matchAllAttrib(const std::map<std::string, std::string>& attribs) const;
+   bool matchAllAttrib(const XmlAttributeView& attribs) const;
 
    //! Does the XML tag and attributes match this filter?  (Must match all attributes in filter)
-   bool match(const std::string& aTag, const std::map<std::string, std::string>& attribs) const
+   bool match(const char* aTag, const XmlAttributeView& attribs) const
    {
       return matchTag(aTag) && matchAllAttrib(attribs);
    }
@@ -132,23 +137,27 @@ public:
 
 
 protected:
-   // comparison function for map to be case sensitive
-   struct ciLessSen : public std::binary_function<string, string, bool> {
-      bool operator()(const string& lhs, const string& rhs) const {
-         return strcmp(lhs.c_str(), rhs.c_str()) < 0;
-      }
+   //! one attribute to filter on
+   struct Attribute
+   {
+      Attribute(const std::string& aName, const std::string& aValue)
+         : name(aName), value(aValue), hiddenCase(false), hiddenNoCase(false) {}
+
+      std::string name;       //!< name as written in the filter
+      std::string value;
+      bool hiddenCase;        //!< a later attribute has the same name, so this one is not used
+      bool hiddenNoCase;      //!< a later attribute has the same name without case, not used when case insensitive
    };
 
-   // comparison function for map to be case insensitive
-   struct ciLessInsen : public std::binary_function<string, string, bool>
+   //! the attributes an element attribute name finds, by the name in lower case
+   struct FoldedName
    {
-      bool operator() (const string& lhs, const string& rhs) const {
-         return strcasecmp(lhs.c_str(), rhs.c_str()) < 0;
-      }
-   };
+      FoldedName(const std::string& aFolded) : folded(aFolded), noCase(-1), lowered(-1) {}
 
-   typedef map<string, string, ciLessSen> mapCaseSen_t;       //!< map attribute name to value, case sensitive
-   typedef map<string, string, ciLessInsen> mapCaseInsen_t;   //!< map attribute name to value, case insensitive
+      std::string folded;     //!< an attribute name folded to lower case
+      int noCase;             //!< index in mAttributes of the attribute used when case insensitive
+      int lowered;            //!< index of the attribute named exactly 'folded', used when case sensitive.  -1 if none
+   };
 
 
 private:
@@ -159,10 +168,25 @@ private:
     */
    void destroy();
 
+   //! value of the filter attribute an element attribute name matches, or null if none
+   const std::string* findValue(const char* aName) const;
+   //! the attribute whose name is the element attribute name in lower case, or null if none
+   const Attribute* findLowered(const char* aName) const;
+   //! the folded name that is the element attribute name in lower case, or null if none
+   const FoldedName* findFolded(const char* aName) const;
+   //! the attribute named exactly aName that is used, or null if none
+   const Attribute* findExact(const std::string& aName) const;
+   //! make mFolded from mAttributes
+   void buildFolded();
+   //! order of mAttributes
+   static bool lessName(const Attribute& a, const Attribute& b);
+   //! order of mFolded
+   static bool lessFolded(const FoldedName& a, const FoldedName& b);
+
    // member variables
    std::string mTagName;          //!< xml element tag e.g. <tag>
-   mapCaseSen_t mAttributes;      //!< attributes to filter on, name and value e.g.  "type","double".  case sensitive
-   mapCaseInsen_t mAttributesLC;  //!< attributes to filter on, name and value e.g.  "type","double" but case insensitive
+   std::vector<Attribute> mAttributes;  //!< attributes to filter on, name and value e.g.  "type","double".  sorted by name
+   std::vector<FoldedName> mFolded;     //!< each distinct name of mAttributes in lower case, sorted
    bool mCaseSensitive;           //!< if true all string compares are case sensitive
 };
 
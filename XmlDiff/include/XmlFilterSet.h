@@ -0,0 +1,77 @@
+#ifndef XmlFilterSet_h
+#define XmlFilterSet_h 1
+
+/**
+ * @file XmlFilterSet.h
+ * @brief contains prototypes and class declarations for class XmlFilterSet
+ *
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "XmlAttributeView.h"
+#include "XmlFilter.h"
+
+
+
+/**
+ * @class XmlFilterSet
+ * @brief All of the filters from the config file, indexed by tag name.
+ *
+ * match() tells if an element matches any of the filters.  Instead of trying
+ * every filter, it looks up the element's tag name (folded to lower case) in a
+ * hash table and only tries the filters with that tag, so the time to check an
+ * element does not grow with the number of filters.  The lookup hashes the tag
+ * in place and does not allocate.
+ */
+
+class XmlFilterSet
+{
+
+public:
+   //! Constructor, an empty set
+   XmlFilterSet();
+
+   //! add a filter to the set
+   void add(const XmlFilter& aFilter);
+
+   //! number of filters
+   size_t size() const { return mFilters.size(); }
+
+   //! set the case sensitivity of every filter (true=yes it is case sensitive)
+   void caseSensitive(bool aFlag);
+
+   //! does the XML tag and attributes match any of the filters?
+   bool match(const char* aTag, const XmlAttributeView& attribs) const;
+
+   //! write each filter to the stream in human-readable format
+   void show(std::ostream& stream = std::cout) const;
+
+
+private:
+   //! the filters with one tag name
+   struct TagGroup
+   {
+      std::string lowerTag;            //!< tag name in lower case
+      unsigned long long hash;         //!< hash of lowerTag
+      std::vector<size_t> filters;     //!< index of each filter in mFilters
+   };
+
+   //! hash of the string folded to lower case
+   static unsigned long long hashLower(const char* p);
+   //! index in mGroups of the group for a tag name (any case), or mGroups.size() if no filter has that tag
+   size_t findGroup(const char* aTag) const;
+   //! make the hash table nSlots big (a power of 2) and put the groups back into it
+   void rehash(size_t nSlots);
+   //! put group g into the first free slot from its hash on
+   void insertSlot(size_t g);
+
+   std::vector<XmlFilter> mFilters;    //!< the filters in the order they were added
+   std::vector<TagGroup> mGroups;      //!< one per tag name
+   std::vector<size_t> mSlots;         //!< hash table, open addressing: index into mGroups plus 1, or 0 if empty
+};
+
+
+#endif
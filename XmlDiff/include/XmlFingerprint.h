@@ -0,0 +1,103 @@
+#ifndef XmlFingerprint_h
+#define XmlFingerprint_h 1
+
+/**
+ * @file XmlFingerprint.h
+ * @brief contains prototypes and class declarations for class XmlFingerprint
+ *
+ */
+
+#include <vector>
+
+#include "tinyxml2.h"
+#include "MU_StringView.h"
+
+
+
+/**
+ * @class XmlFingerprint
+ * @brief 64-bit hash of every subtree of a document, to skip the ones that are the same.
+ *
+ * compute() walks a document once and gives each element a fingerprint made
+ * from its tag, its desired attributes, the tokens of its text and the
+ * fingerprints of its child elements, in order (a Merkle tree).  Tags,
+ * attribute names and tokens are folded to lower case unless the comparison is
+ * case sensitive, and the text is hashed token by token, so two subtrees with
+ * the same fingerprint would be compared without finding a single difference.
+ * Different text that still compares equal (such as "1.0" and "1.00") gives
+ * different fingerprints, so those subtrees are compared as usual.
+ *
+ * The fingerprint is attached to the element with XMLNode::SetUserData() and
+ * found again with get().  The XmlFingerprint object owns the fingerprints and
+ * must outlive the comparison; the document must not change after compute().
+ *
+ * entries() holds the fingerprints in the order they are made, each element
+ * after its children, so fingerprints kept from an earlier run (--cache) can be
+ * given back to attach() instead of being computed again.
+ */
+
+class XmlFingerprint
+{
+
+public:
+   //! fingerprint of one element and everything below it
+   struct Entry
+   {
+      Entry(unsigned long long aHash, unsigned int aElements) : hash(aHash), elements(aElements) {}
+
+      unsigned long long hash;      //!< hash of the subtree
+      unsigned int elements;        //!< number of elements in the subtree, including the top one
+   };
+
+   //! decides if an attribute takes part in the comparison, by name
+   typedef bool (*AttributeTest)(const char* name);
+
+   //! Constructor
+   /*!
+    * @param aDelimiters characters the comparison splits attribute values and text on
+    * @param aCaseSensitive true if the comparison is case sensitive
+    * @param aIsDesired attributes this returns false for are left out of the fingerprint
+    */
+   XmlFingerprint(const MU_CharSet& aDelimiters, bool aCaseSensitive, AttributeTest aIsDesired);
+
+   //! fingerprint every element of the document
+   void compute(tinyxml2::XMLDocument* doc);
+
+   //! attach fingerprints made earlier for the same document instead of computing them.  They are
+   //! taken out of 'entries'.  Returns false if they do not fit the shape of the document, and then
+   //! compute() must be called instead
+   bool attach(tinyxml2::XMLDocument* doc, std::vector<Entry>& entries);
+
+   //! the fingerprints, each element after its children, in document order
+   const std::vector<Entry>& entries() const { return mEntries; }
+
+   //! the fingerprint of an element, or null if its document has not been fingerprinted
+   static const Entry* get(const tinyxml2::XMLElement* elem)
+   {
+      return static_cast<const Entry*>(elem->GetUserData());
+   }
+
+
+private:
+   XmlFingerprint(const XmlFingerprint&);        // not supported
+   void operator=(const XmlFingerprint&);        // not supported
+
+   //! fingerprint elem and its children and attach them to the elements
+   const Entry& computeSubtree(tinyxml2::XMLElement* elem);
+   //! attach mEntries[next] on to elem and its children.  Returns false if a count of elements does not fit
+   bool attachSubtree(tinyxml2::XMLElement* elem, size_t& next);
+   //! hash of the element itself: tag, desired attributes and text
+   unsigned long long hashElement(const tinyxml2::XMLElement* elem) const;
+   //! add each token of text to the hash
+   unsigned long long hashTokens(unsigned long long hash, const char* text) const;
+   //! add the characters to the hash, folded to lower case unless case sensitive
+   unsigned long long hashChars(unsigned long long hash, const char* p, size_t n) const;
+
+   const MU_CharSet& mDelimiters;
+   bool mCaseSensitive;
+   AttributeTest mIsDesired;
+   std::vector<Entry> mEntries;      //!< one per element, sized before they are attached
+};
+
+
+#endif
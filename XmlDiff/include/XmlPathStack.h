@@ -0,0 +1,71 @@
+#ifndef XmlPathStack_h
+#define XmlPathStack_h 1
+
+/**
+ * @file XmlPathStack.h
+ * @brief contains prototypes and class declarations for class XmlPathStack
+ *
+ */
+
+#include <string>
+#include <vector>
+
+
+
+/**
+ * @class XmlPathStack
+ * @brief The path from the root to the element being compared, e.g. "model.group.var"
+ *
+ * Each level is kept as the id of its name in a table of names, so pushing
+ * a name that was seen before only hashes it and copies nothing.  The path is
+ * only turned into text when text() is called, which is when a difference is
+ * written.  The text is kept between calls and only the levels that changed
+ * since the last call are added again.
+ */
+
+class XmlPathStack
+{
+
+public:
+   //! Constructor, an empty path
+   XmlPathStack();
+
+   //! add a level with this name to the end of the path
+   void push(const char* aName);
+
+   //! remove the last level of the path
+   void pop();
+
+   //! number of levels
+   size_t depth() const { return mIds.size(); }
+
+   //! the name of level i (0 is the top)
+   const std::string& name(size_t i) const { return mNames[mIds[i]]; }
+
+   //! the path as text, the levels separated by '.'
+   const std::string& text() const;
+
+   //! number of pushes and pops so far.  The path is the same as long as this is
+   unsigned long long changes() const { return mChanges; }
+
+
+private:
+   //! id of the name, adding it to the table if it is not there yet
+   unsigned int intern(const char* aName);
+   //! make the hash table nSlots big (a power of 2) and put the names back into it
+   void rehash(size_t nSlots);
+   //! put name id into the first free slot from its hash on
+   void insertSlot(unsigned int id);
+
+   std::vector<std::string> mNames;          //!< the names, indexed by id
+   std::vector<unsigned long long> mHashes;  //!< hash of each name
+   std::vector<unsigned int> mSlots;         //!< hash table, open addressing: name id plus 1, or 0 if empty
+   std::vector<unsigned int> mIds;           //!< name id of each level of the path
+   unsigned long long mChanges;              //!< number of pushes and pops
+
+   mutable std::string mText;                //!< text of the first mTextEnd.size() levels
+   mutable std::vector<size_t> mTextEnd;     //!< length of mText after each level it holds
+};
+
+
+#endif
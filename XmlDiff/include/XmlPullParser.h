@@ -0,0 +1,139 @@
+#ifndef XmlPullParser_h
+#define XmlPullParser_h 1
+
+/**
+ * @file XmlPullParser.h
+ * @brief contains prototypes and class declarations for class XmlPullParser
+ *
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "tinyxml2.h"
+
+
+using namespace tinyxml2;
+
+
+
+/**
+ * @class XmlPullParser
+ * @brief Reads an XML file one event at a time without building a DOM.
+ *
+ * The file is read in chunks into a sliding buffer, so memory use depends on
+ * the size of the largest single tag or text block and the nesting depth, not
+ * on the size of the file.  Call next() to get the next event.  After a
+ * START_ELEMENT event the tag name and attributes are available, after a
+ * TEXT event the text is available.  Everything returned stays valid only
+ * until the following call to next().
+ *
+ * Text, attribute values and names are decoded with the same rules tinyxml2
+ * uses (entities and newline normalization), and text that is only white
+ * space is skipped the same way, so the events line up with what an
+ * XMLDocument of the same file would contain.  Comments, declarations and
+ * DTD entries are skipped but still count as child nodes (see firstChild()).
+ */
+
+class XmlPullParser
+{
+
+public:
+   //! the events returned by next()
+   enum Event { START_ELEMENT, TEXT, END_ELEMENT, END_DOCUMENT, PARSE_ERROR };
+
+   //! Default constructor
+   /*!
+    * @param aChunkSize number of bytes to read from the file at a time
+    */
+   XmlPullParser(size_t aChunkSize = 256 * 1024);
+
+   //! Destructor closes the file
+   ~XmlPullParser();
+
+   //! Open a file to read events from.  Returns true if error (see errorID())
+   bool open(const char* filename);
+
+   //! Close the file (also done by destructor)
+   void close();
+
+   //! Read the next event.  Once END_DOCUMENT or PARSE_ERROR is returned it will keep being returned.
+   Event next();
+
+   //! Make the next call to next() return the current event again (one level only)
+   void unread() { mUnread = true; }
+
+   //! the tag name of the START_ELEMENT or END_ELEMENT
+   const char* name() const { return mName.c_str(); }
+
+   //! number of attributes of the START_ELEMENT
+   size_t attributeCount() const { return mAttribCount; }
+   //! attribute name by index, in the order they are in the file
+   const char* attributeName(size_t i) const { return mAttribNames[i].c_str(); }
+   //! attribute value by index, in the order they are in the file
+   const char* attributeValue(size_t i) const { return mAttribValues[i].c_str(); }
+
+   //! the decoded text of a TEXT event
+   const char* text() const { return mText.c_str(); }
+
+   //! true if the TEXT event is the first child node of its element (what XMLElement::GetText() returns)
+   bool firstChild() const { return mFirstChild; }
+
+   //! current element nesting depth (0 at document level)
+   size_t depth() const { return mOpenTags.size(); }
+
+   //! error code after a PARSE_ERROR (or after open() fails)
+   XMLError errorID() const { return mErrorID; }
+   //! text name of the error code, e.g. "XML_ERROR_PARSING_ELEMENT"
+   const char* errorName() const;
+
+
+private:
+   XmlPullParser(const XmlPullParser&);           // not supported
+   void operator=(const XmlPullParser&);          // not supported
+
+   Event readEvent();
+   Event setError(XMLError err);
+
+   //! read more of the file into the buffer, returns false at end of file
+   bool fill();
+   //! make sure there are at least n bytes after mPos (unless end of file)
+   bool ensure(size_t n);
+   //! find 'pattern' at or after offset 'from' (relative to mPos), reading more as needed.  Returns offset or npos
+   size_t find(size_t from, const char* pattern);
+   //! find the '>' closing a start or end tag, skipping over quoted attribute values.  Returns offset or npos
+   size_t findTagEnd(size_t from);
+   //! note that a node was found at the current level, sets mFirstChild
+   void addChildNode();
+
+   Event parseTag(const char* p, const char* end);
+   void decode(std::string& s, int flags);
+
+   FILE* mFile;
+   size_t mChunkSize;
+   std::vector<char> mBuffer;      //!< file data, mBuffer[mEnd] is always 0
+   size_t mPos;                    //!< parse position in mBuffer
+   size_t mEnd;                    //!< end of valid data in mBuffer
+   bool mEof;                      //!< file has been read to the end
+   bool mStarted;                  //!< BOM has been checked
+
+   Event mEvent;                   //!< the last event returned
+   bool mUnread;                   //!< return mEvent again on next()
+   bool mPendingEnd;               //!< an empty element <a/> still owes its END_ELEMENT
+   bool mFirstChild;
+   std::vector<bool> mHasChild;    //!< per open element: a child node has been seen
+   std::vector<std::string> mOpenTags;
+
+   std::string mName;
+   size_t mAttribCount;
+   std::vector<std::string> mAttribNames;
+   std::vector<std::string> mAttribValues;
+   std::string mText;
+   StrPair mDecoder;
+
+   XMLError mErrorID;
+};
+
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ *
+ * @file DiffBudget.cpp
+ * @brief This file contains the member function definitions for class DiffBudget
+ */
+
+#include "DiffBudget.h"
+#include "DiffRecordWriter.h"
+
+
+namespace
+{
+   // the clock is read once every this many calls of stopped()
+   const unsigned int ClockInterval = 256;
+}
+
+
+
+
+// ==========================================================================
+DiffBudget::DiffBudget(unsigned int aMaxDiffs, const Clock::time_point* aDeadline)
+   : mMaxDiffs(aMaxDiffs)
+   , mHasDeadline(aDeadline != nullptr)
+   , mDeadline(aDeadline ? *aDeadline : Clock::time_point())
+   , mDiffs(0)
+   , mReason(NotStopped)
+{
+}
+
+
+
+
+// ==========================================================================
+bool DiffBudget::takeDiff()
+{
+   if (mMaxDiffs == 0)
+      return true;
+
+   const unsigned int n = ++mDiffs;
+   if (n >= mMaxDiffs)
+      stop(MaxDiffs);
+   return n <= mMaxDiffs;
+}
+
+
+
+
+// ==========================================================================
+bool DiffBudget::stopped(unsigned int& calls)
+{
+   if (mReason.load() != NotStopped)
+      return true;
+
+   if (mHasDeadline && ++calls >= ClockInterval)
+   {
+      calls = 0;
+      return checkClock();
+   }
+   return false;
+}
+
+
+
+
+// ==========================================================================
+bool DiffBudget::checkClock()
+{
+   if (mHasDeadline && Clock::now() >= mDeadline)
+      stop(Timeout);
+   return mReason.load() != NotStopped;
+}
+
+
+
+
+// ==========================================================================
+void DiffBudget::writeStopped(std::ostream& os, const DiffRecordWriter* records) const
+{
+   if (reason() == NotStopped)
+      return;
+
+   const bool timeout = (reason() == Timeout);
+   if (records)
+      records->stopped(os, (timeout ? "timeout" : "max-diffs"));
+   else if (timeout)
+      os << "Stopped, out of time (--timeout). The counts are up to there" << std::endl;
+   else
+      os << "Stopped after " << mMaxDiffs << " difference(s). The counts are up to there" << std::endl;
+}
+
+
+
+
+// ==========================================================================
+// static
+int DiffBudget::quickStatus(bool differ, bool timedOut)
+{
+   if (differ)
+      return 2;
+   return (timedOut ? 3 : 0);
+}
+
+
+
+
+// ==========================================================================
+void DiffBudget::stop(Reason aReason)
+{
+   int expected = NotStopped;
+   mReason.compare_exchange_strong(expected, aReason);
+}
@@ -0,0 +1,434 @@
+/**
+ *
+ * @file DiffRecordWriter.cpp
+ * @brief This file contains the member function definitions for class DiffRecordWriter
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "DiffRecordWriter.h"
+#include "MU_StringUtil.h"
+
+using namespace std;
+
+
+namespace
+{
+   const unsigned int RecordVersion = 1;
+
+   const char* KindName(DiffRecordWriter::Kind kind)
+   {
+      switch (kind)
+      {
+      case DiffRecordWriter::TagName:        return "tag";
+      case DiffRecordWriter::AttributeName:  return "attributeName";
+      case DiffRecordWriter::AttributeValue: return "attributeValue";
+      case DiffRecordWriter::Content:        return "content";
+      case DiffRecordWriter::Deleted:        return "deleted";
+      case DiffRecordWriter::Inserted:       return "inserted";
+      }
+      return "unknown";
+   }
+
+
+   // text that reads back as the same double
+   void WriteDouble(ostream& os, double d)
+   {
+      char buffer[32];
+      sprintf(buffer, "%.17g", d);
+      os << buffer;
+   }
+}
+
+
+
+
+// ==========================================================================
+DiffRecordWriter::DiffRecordWriter(Format aFormat)
+   : mFormat(aFormat)
+   , mLock()
+   , mPathIds()
+   , mPaths()
+   , mWritten()
+{
+}
+
+
+
+
+// ==========================================================================
+// static
+bool DiffRecordWriter::parseFormat(const std::string& name, Format& aFormat)
+{
+   if (MU_StringUtil::Strcasecmp(name, "text"))
+      aFormat = Text;
+   else if (MU_StringUtil::Strcasecmp(name, "jsonl"))
+      aFormat = JsonLines;
+   else if (MU_StringUtil::Strcasecmp(name, "binary"))
+      aFormat = Binary;
+   else
+      return true;
+   return false;
+}
+
+
+
+
+// ==========================================================================
+unsigned int DiffRecordWriter::pathId(const std::string& path, bool& isNew)
+{
+   lock_guard<mutex> lock(mLock);
+   pair<unordered_map<string, unsigned int>::iterator, bool> ins =
+      mPathIds.insert(make_pair(path, static_cast<unsigned int>(mPaths.size())));
+   isNew = ins.second;
+   if (isNew)
+   {
+      // the keys of an unordered_map do not move when it grows
+      mPaths.push_back(&ins.first->first);
+      mWritten.push_back(false);
+   }
+   return ins.first->second;
+}
+
+
+
+
+// ==========================================================================
+bool DiffRecordWriter::markWritten(unsigned int id)
+{
+   lock_guard<mutex> lock(mLock);
+   if (mWritten[id])
+      return false;
+   mWritten[id] = true;
+   return true;
+}
+
+
+
+
+// ==========================================================================
+void DiffRecordWriter::header(std::ostream& os) const
+{
+   if (mFormat == JsonLines)
+   {
+      os << "{\"type\":\"header\",\"program\":\"XmlDiff\",\"version\":" << RecordVersion << "}\n";
+   }
+   else if (mFormat == Binary)
+   {
+      string fields;
+      putU32(fields, RecordVersion);
+      putString(fields, "XmlDiff", 7);
+      binaryRecord(os, 'H', fields);
+   }
+}
+
+
+
+
+// ==========================================================================
+void DiffRecordWriter::files(std::ostream& os, const std::string& filename1, const std::string& filename2)
+{
+   {
+      lock_guard<mutex> lock(mLock);
+      mPathIds.clear();
+      mPaths.clear();
+      mWritten.clear();
+   }
+
+   if (mFormat == JsonLines)
+   {
+      os << "{\"type\":\"files\",\"file1\":";
+      jsonString(os, filename1.data(), filename1.size());
+      os << ",\"file2\":";
+      jsonString(os, filename2.data(), filename2.size());
+      os << "}\n";
+   }
+   else if (mFormat == Binary)
+   {
+      string fields;
+      putString(fields, filename1.data(), filename1.size());
+      putString(fields, filename2.data(), filename2.size());
+      binaryRecord(os, 'F', fields);
+   }
+}
+
+
+
+
+// ==========================================================================
+void DiffRecordWriter::path(std::ostream& os, unsigned int id) const
+{
+   const string* p;
+   {
+      lock_guard<mutex> lock(mLock);
+      p = mPaths[id];
+   }
+
+   if (mFormat == JsonLines)
+   {
+      os << "{\"type\":\"path\",\"id\":" << id << ",\"path\":";
+      jsonString(os, p->data(), p->size());
+      os << "}\n";
+   }
+   else if (mFormat == Binary)
+   {
+      string fields;
+      putU32(fields, id);
+      putString(fields, p->data(), p->size());
+      binaryRecord(os, 'P', fields);
+   }
+}
+
+
+
+
+// ==========================================================================
+void DiffRecordWriter::diff(std::ostream& os, Kind kind, unsigned int pathId, const char* attribute,
+   const MU_StringView& value1, const MU_StringView& value2, double delta, long long offset1, long long offset2) const
+{
+   if (mFormat == JsonLines)
+   {
+      os << "{\"type\":\"diff\",\"kind\":\"" << KindName(kind) << "\",\"path\":" << pathId;
+      if (attribute)
+      {
+         os << ",\"attribute\":";
+         jsonString(os, attribute, strlen(attribute));
+      }
+      os << ",\"file1\":";
+      jsonString(os, value1.data(), value1.size());
+      os << ",\"file2\":";
+      jsonString(os, value2.data(), value2.size());
+      // NaN and infinity are not JSON numbers
+      if (delta == delta && delta - delta == 0.0)
+      {
+         os << ",\"delta\":";
+         WriteDouble(os, delta);
+      }
+      if (offset1 >= 0)
+         os << ",\"offset1\":" << offset1;
+      if (offset2 >= 0)
+         os << ",\"offset2\":" << offset2;
+      os << "}\n";
+   }
+   else if (mFormat == Binary)
+   {
+      string fields;
+      fields += static_cast<char>(kind);
+      putU32(fields, pathId);
+      putI64(fields, offset1);
+      putI64(fields, offset2);
+      putF64(fields, delta);
+      putString(fields, (attribute ? attribute : ""), (attribute ? strlen(attribute) : 0));
+      putString(fields, value1.data(), value1.size());
+      putString(fields, value2.data(), value2.size());
+      binaryRecord(os, 'D', fields);
+   }
+}
+
+
+
+
+// ==========================================================================
+void DiffRecordWriter::stopped(std::ostream& os, const char* reason) const
+{
+   if (mFormat == JsonLines)
+   {
+      os << "{\"type\":\"stopped\",\"reason\":\"" << reason << "\"}\n";
+   }
+   else if (mFormat == Binary)
+   {
+      string fields;
+      putString(fields, reason, strlen(reason));
+      binaryRecord(os, 'T', fields);
+   }
+}
+
+
+
+
+// ==========================================================================
+void DiffRecordWriter::summary(std::ostream& os, const Summary& counts) const
+{
+   if (mFormat == JsonLines)
+   {
+      os << "{\"type\":\"summary\""
+         << ",\"elements\":" << counts.elements
+         << ",\"tagDiffs\":" << counts.tagDiffs
+         << ",\"extraElements1\":" << counts.extraElements1
+         << ",\"extraElements2\":" << counts.extraElements2
+         << ",\"attributeNameDiffs\":" << counts.attributeNameDiffs
+         << ",\"attributeValueDiffs\":" << counts.attributeValueDiffs
+         << ",\"contentDiffs\":" << counts.contentDiffs
+         << ",\"numberDiffs\":" << counts.numberDiffs
+         << ",\"textDiffs\":" << counts.textDiffs
+         << ",\"total\":" << counts.total
+         << ",\"deleted\":" << counts.deleted
+         << ",\"inserted\":" << counts.inserted
+         << "}\n";
+   }
+   else if (mFormat == Binary)
+   {
+      string fields;
+      putU32(fields, counts.elements);
+      putU32(fields, counts.tagDiffs);
+      putU32(fields, counts.extraElements1);
+      putU32(fields, counts.extraElements2);
+      putU32(fields, counts.attributeNameDiffs);
+      putU32(fields, counts.attributeValueDiffs);
+      putU32(fields, counts.contentDiffs);
+      putU32(fields, counts.numberDiffs);
+      putU32(fields, counts.textDiffs);
+      putU32(fields, counts.total);
+      putU32(fields, counts.deleted);
+      putU32(fields, counts.inserted);
+      binaryRecord(os, 'S', fields);
+   }
+}
+
+
+
+
+// ==========================================================================
+void DiffRecordWriter::batch(std::ostream& os, unsigned int pairs, unsigned int withDifferences, unsigned int notCompared) const
+{
+   if (mFormat == JsonLines)
+   {
+      os << "{\"type\":\"batch\",\"pairs\":" << pairs << ",\"withDifferences\":" << withDifferences
+         << ",\"notCompared\":" << notCompared << "}\n";
+   }
+   else if (mFormat == Binary)
+   {
+      string fields;
+      putU32(fields, pairs);
+      putU32(fields, withDifferences);
+      putU32(fields, notCompared);
+      binaryRecord(os, 'B', fields);
+   }
+}
+
+
+
+
+// ==========================================================================
+void DiffRecordWriter::error(std::ostream& os, const std::string& message) const
+{
+   if (mFormat == JsonLines)
+   {
+      os << "{\"type\":\"error\",\"message\":";
+      jsonString(os, message.data(), message.size());
+      os << "}\n";
+   }
+   else if (mFormat == Binary)
+   {
+      string fields;
+      putString(fields, message.data(), message.size());
+      binaryRecord(os, 'E', fields);
+   }
+}
+
+
+
+
+// ==========================================================================
+// static
+void DiffRecordWriter::writeError(std::ostream& os, const DiffRecordWriter* records, const std::string& message)
+{
+   if (records)
+      records->error(os, message);
+   else
+      os << message << endl;
+}
+
+
+
+
+// ==========================================================================
+// static
+void DiffRecordWriter::jsonString(std::ostream& os, const char* p, size_t n)
+{
+   static const char hex[] = "0123456789abcdef";
+
+   os << '"';
+   const char* run = p;      // characters not needing escapes are written in runs
+   for (size_t i = 0; i < n; ++i)
+   {
+      unsigned char c = static_cast<unsigned char>(p[i]);
+      if (c >= 0x20 && c != '"' && c != '\\')
+         continue;
+
+      os.write(run, p + i - run);
+      run = p + i + 1;
+      switch (c)
+      {
+      case '"':  os << "\\\""; break;
+      case '\\': os << "\\\\"; break;
+      case '\n': os << "\\n"; break;
+      case '\r': os << "\\r"; break;
+      case '\t': os << "\\t"; break;
+      default:   os << "\\u00" << hex[c >> 4] << hex[c & 0xF]; break;
+      }
+   }
+   os.write(run, p + n - run);
+   os << '"';
+}
+
+
+
+
+// ==========================================================================
+// static
+void DiffRecordWriter::binaryRecord(std::ostream& os, char type, const std::string& fields)
+{
+   string head;
+   putU32(head, static_cast<unsigned int>(fields.size() + 1));
+   head += type;
+   os.write(head.data(), head.size());
+   os.write(fields.data(), fields.size());
+}
+
+
+
+
+// ==========================================================================
+// static
+void DiffRecordWriter::putU32(std::string& fields, unsigned int v)
+{
+   for (int i = 0; i < 4; ++i)
+      fields += static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+
+
+
+// ==========================================================================
+// static
+void DiffRecordWriter::putI64(std::string& fields, long long v)
+{
+   unsigned long long u = static_cast<unsigned long long>(v);
+   for (int i = 0; i < 8; ++i)
+      fields += static_cast<char>((u >> (8 * i)) & 0xFF);
+}
+
+
+
+
+// ==========================================================================
+// static
+void DiffRecordWriter::putF64(std::string& fields, double v)
+{
+   unsigned long long u;
+   memcpy(&u, &v, sizeof(u));
+   putI64(fields, static_cast<long long>(u));
+}
+
+
+
+
+// ==========================================================================
+// static
+void DiffRecordWriter::putString(std::string& fields, const char* p, size_t n)
+{
+   putU32(fields, static_cast<unsigned int>(n));
+   fields.append(p, n);
+}
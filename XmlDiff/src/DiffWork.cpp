@@ -0,0 +1,83 @@
+/**
+ *
+ * @file DiffWork.cpp
+ * @brief This file contains the member function definitions for class DiffWork
+ */
+
+#include "DiffWork.h"
+
+using namespace std;
+
+
+// ==========================================================================
+DiffWork::DiffWork()
+   : element1(nullptr)
+   , element2(nullptr)
+   , modelTree()
+   , out()
+   , totDiff()
+   , finished(false)
+   , mPaths()
+   , mRecords()
+{
+}
+
+
+
+
+// ==========================================================================
+unsigned int DiffWork::addPath(const std::string& path)
+{
+   // the same path may be added again later in the piece, it is given the same id when written
+   mPaths.push_back(path);
+   return static_cast<unsigned int>(mPaths.size() - 1);
+}
+
+
+
+
+// ==========================================================================
+void DiffWork::addRecord(DiffRecordWriter::Kind kind, unsigned int path, const char* attribute,
+   const MU_StringView& value1, const MU_StringView& value2, double delta, long long offset1, long long offset2)
+{
+   mRecords.push_back(Record());
+   Record& record = mRecords.back();
+   record.kind = kind;
+   record.path = path;
+   if (attribute)
+      record.attribute = attribute;
+   record.value1.assign(value1.data(), value1.size());
+   record.value2.assign(value2.data(), value2.size());
+   record.delta = delta;
+   record.offset1 = offset1;
+   record.offset2 = offset2;
+}
+
+
+
+
+// ==========================================================================
+void DiffWork::write(std::ostream& os, DiffRecordWriter* records) const
+{
+   os << out.str();
+   if (!records)
+      return;
+
+   unsigned int path = 0;
+   unsigned int pathId = 0;
+   for (size_t i = 0; i < mRecords.size(); ++i)
+   {
+      const Record& record = mRecords[i];
+      if (i == 0 || record.path != path)
+      {
+         bool isNew;
+         path = record.path;
+         pathId = records->pathId(mPaths[path], isNew);
+         if (isNew && records->markWritten(pathId))
+            records->path(os, pathId);
+      }
+      records->diff(os, record.kind, pathId, (record.kind == DiffRecordWriter::AttributeValue ? record.attribute.c_str() : nullptr),
+         MU_StringView(record.value1.data(), record.value1.size()), MU_StringView(record.value2.data(), record.value2.size()),
+         record.delta, record.offset1, record.offset2);
+   }
+}
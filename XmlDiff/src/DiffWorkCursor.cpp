@@ -0,0 +1,55 @@
+/**
+ *
+ * @file DiffWorkCursor.cpp
+ * @brief This file contains the member function definitions for class DiffWorkCursor
+ */
+
+#include "DiffWorkCursor.h"
+
+using namespace std;
+
+
+// ==========================================================================
+DiffWorkCursor::DiffWorkCursor(std::list<DiffWork>& aWork, std::ostream& aOut, DiffRecordWriter* aRecords, XmlDifferences& aTotDiff)
+   : mLock()
+   , mWork(aWork)
+   , mOut(aOut)
+   , mRecords(aRecords)
+   , mTotDiff(aTotDiff)
+{
+}
+
+
+
+
+// ==========================================================================
+void DiffWorkCursor::writeFinished()
+{
+   lock_guard<mutex> lock(mLock);
+   writeFront();
+}
+
+
+
+
+// ==========================================================================
+void DiffWorkCursor::finish(DiffWork* piece)
+{
+   lock_guard<mutex> lock(mLock);
+   piece->finished = true;
+   writeFront();
+}
+
+
+
+
+// ==========================================================================
+void DiffWorkCursor::writeFront()
+{
+   while (!mWork.empty() && (mWork.front().finished || !mWork.front().element1))
+   {
+      mWork.front().write(mOut, mRecords);
+      mTotDiff.add(mWork.front().totDiff);
+      mWork.pop_front();
+   }
+}
@@ -0,0 +1,184 @@
+/**
+ *
+ * @file FingerprintCache.cpp
+ * @brief This file contains the member function definitions for class FingerprintCache
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "FingerprintCache.h"
+#include "SidecarFile.h"
+
+using namespace tinyxml2;
+
+
+namespace
+{
+   // the sidecar starts with these, then the size and time of the file, the settings hash
+   // and the number of entries, then each entry as a hash and a count of elements.  it is
+   // in the byte order of the machine that wrote it; another order fails the version check
+   const char Magic[4] = { 'X', 'D', 'F', 'P' };
+   const unsigned int Version = 1;
+   const size_t HeaderSize = sizeof(Magic) + sizeof(unsigned int) + 4 * sizeof(unsigned long long);
+   const size_t EntrySize = sizeof(unsigned long long) + sizeof(unsigned int);
+
+   template <class T>
+   void Put(std::vector<char>& buffer, T value)
+   {
+      const char* p = reinterpret_cast<const char*>(&value);
+      buffer.insert(buffer.end(), p, p + sizeof(T));
+   }
+
+   template <class T>
+   T Get(const char*& p)
+   {
+      T value;
+      memcpy(&value, p, sizeof(T));
+      p += sizeof(T);
+      return value;
+   }
+}
+
+
+
+
+// ==========================================================================
+FingerprintCache::FingerprintCache(const std::string& aFilename, unsigned long long aConfigHash)
+   : mFilename(aFilename)
+   , mConfigHash(aConfigHash)
+   , mEntries()
+{
+}
+
+
+
+
+// ==========================================================================
+bool FingerprintCache::read()
+{
+   mEntries.clear();
+
+   unsigned long long size = 0;
+   long long modified = 0;
+   if (!SidecarFile::fileKey(mFilename, size, modified))
+      return false;
+
+   // one written in the same tick as a change of the file may be of the version before it
+   const std::string sidecar = sidecarName(mFilename);
+   if (!SidecarFile::writtenAfter(sidecar, modified))
+      return false;
+
+   FILE* file = fopen(sidecar.c_str(), "rb");
+   if (!file)
+      return false;
+
+   std::vector<char> header(HeaderSize);
+   bool good = (fread(&header[0], 1, HeaderSize, file) == HeaderSize);
+   const char* p = &header[0];
+   unsigned long long count = 0;
+   if (good)
+   {
+      good = (memcmp(p, Magic, sizeof(Magic)) == 0);
+      p += sizeof(Magic);
+      good = good && Get<unsigned int>(p) == Version;
+      good = good && Get<unsigned long long>(p) == size;
+      good = good && Get<long long>(p) == modified;
+      good = good && Get<unsigned long long>(p) == mConfigHash;
+      if (good)
+         count = Get<unsigned long long>(p);
+   }
+
+   // a file of 'size' bytes cannot hold more elements than that
+   std::vector<char> body;
+   if (good && count > 0 && count <= size)
+   {
+      body.resize(static_cast<size_t>(count) * EntrySize);
+      good = (fread(&body[0], 1, body.size(), file) == body.size());
+   }
+   else
+   {
+      good = false;
+   }
+   fclose(file);
+   if (!good)
+      return false;
+
+   mEntries.reserve(static_cast<size_t>(count));
+   p = &body[0];
+   for (unsigned long long i = 0; i < count; ++i)
+   {
+      unsigned long long hash = Get<unsigned long long>(p);
+      unsigned int elements = Get<unsigned int>(p);
+      mEntries.push_back(XmlFingerprint::Entry(hash, elements));
+   }
+   return true;
+}
+
+
+
+
+// ==========================================================================
+bool FingerprintCache::write(const std::vector<XmlFingerprint::Entry>& entries) const
+{
+   unsigned long long size = 0;
+   long long modified = 0;
+   if (entries.empty() || !SidecarFile::fileKey(mFilename, size, modified))
+      return true;
+
+   std::vector<char> buffer;
+   buffer.reserve(HeaderSize + entries.size() * EntrySize);
+   buffer.insert(buffer.end(), Magic, Magic + sizeof(Magic));
+   Put(buffer, Version);
+   Put(buffer, size);
+   Put(buffer, modified);
+   Put(buffer, mConfigHash);
+   Put(buffer, static_cast<unsigned long long>(entries.size()));
+   for (size_t i = 0; i < entries.size(); ++i)
+   {
+      Put(buffer, entries[i].hash);
+      Put(buffer, entries[i].elements);
+   }
+
+   // another run may be reading or writing the same sidecar, so it is replaced in one step
+   const std::string sidecar = sidecarName(mFilename);
+   const std::string temporary = SidecarFile::temporaryName(sidecar);
+   FILE* file = SidecarFile::create(temporary);
+   if (!file)
+      return true;
+   const bool failed = (fwrite(&buffer[0], 1, buffer.size(), file) != buffer.size());
+   // not if the file may have changed after its fingerprints were worked out, in the same tick
+   if (fclose(file) != 0 || failed || !SidecarFile::writtenAfter(temporary, modified))
+   {
+      remove(temporary.c_str());
+      return true;
+   }
+
+   return SidecarFile::replace(temporary, sidecar);
+}
+
+
+
+
+// ==========================================================================
+bool FingerprintCache::sameTop(const XMLDocument& doc, unsigned int& elements) const
+{
+   elements = 0;
+
+   // the top elements of the cached file are its last entry, the entry before that
+   // one's subtree, and so on back to the start
+   size_t end = mEntries.size();
+   const XMLElement* elem = doc.LastChildElement();
+   for (; elem && end > 0; elem = elem->PreviousSiblingElement())
+   {
+      const XmlFingerprint::Entry* fingerprint = XmlFingerprint::get(elem);
+      const XmlFingerprint::Entry& cached = mEntries[end - 1];
+      if (!fingerprint || cached.elements == 0 || cached.elements > end
+         || fingerprint->hash != cached.hash || fingerprint->elements != cached.elements)
+         return false;
+      elements += cached.elements;
+      end -= cached.elements;
+   }
+   return (!elem && end == 0);
+}
+
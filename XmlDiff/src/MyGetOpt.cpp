@@ -116,6 +116,40 @@ void MyGetOpt( int argc, char **argv, RunSettings& runSettings )
                //std::cout << "mdelta = " << runSettings.getDelta() << std::endl;
             }
          }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--align"))
+         {
+            runSettings.setAlign(true);
+         }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--async"))
+         {
+            runSettings.setAsyncOutput(true);
+         }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--attribs"))
+         {
+            if (MyOptArg(argc, argv, 1, 1, optlist) < 0)
+            {
+               exit(0);
+            }
+            else
+            {
+               runSettings.setAttribs(optlist[0]);
+            }
+         }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--batch"))
+         {
+            if (MyOptArg(argc, argv, 1, 1, optlist) < 0)
+            {
+               exit(0);
+            }
+            else
+            {
+               runSettings.setBatchFile(optlist[0]);
+            }
+         }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--cache"))
+         {
+            runSettings.setFingerprintCache(true);
+         }
          else if (MU_StringUtil::Strcasecmp(*argv, "--case"))
          {
             if (MyOptArg(argc, argv, 1, 1, optlist) < 0)
@@ -139,6 +173,17 @@ void MyGetOpt( int argc, char **argv, RunSettings& runSettings )
                   exit(0);
             }
          }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--context"))
+         {
+            if (MyOptArg(argc, argv, 1, 1, optlist) < 0)
+            {
+               exit(0);
+            }
+            else
+            {
+               runSettings.setSideContext(atoi(optlist[0].c_str()));
+            }
+         }
          else if (MU_StringUtil::Strcasecmp(*argv, "--delim"))
          {
             if (MyOptArg(argc, argv, 1, 1, optlist) < 0)
@@ -152,6 +197,48 @@ void MyGetOpt( int argc, char **argv, RunSettings& runSettings )
                runSettings.setDelim(MU_StringUtil::ToEscapedString(optlist[0]));
             }
          }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--format"))
+         {
+            if (MyOptArg(argc, argv, 1, 1, optlist) < 0)
+            {
+               exit(0);
+            }
+            else
+            {
+               runSettings.setFormat(optlist[0]);
+            }
+         }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--max-diffs"))
+         {
+            if (MyOptArg(argc, argv, 1, 1, optlist) < 0)
+            {
+               exit(0);
+            }
+            else
+            {
+               int n = atoi(optlist[0].c_str());
+               runSettings.setMaxDiffs(n > 0 ? n : 0);
+            }
+         }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--mmap"))
+         {
+            runSettings.setMemoryMapped(true);
+         }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--output") || MU_StringUtil::Strcasecmp(*argv, "-o"))
+         {
+            if (MyOptArg(argc, argv, 1, 1, optlist) < 0)
+            {
+               exit(0);
+            }
+            else
+            {
+               runSettings.setOutputFile(optlist[0]);
+            }
+         }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--quick"))
+         {
+            runSettings.setQuick(true);
+         }
          else if (MU_StringUtil::Strcasecmp(*argv, "--ref"))
          {
             runSettings.setReformat(true);
@@ -160,6 +247,51 @@ void MyGetOpt( int argc, char **argv, RunSettings& runSettings )
          {
             runSettings.setSideBySide(true);
          }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--jobs") || MU_StringUtil::Strcasecmp(*argv, "-j"))
+         {
+            if (MyOptArg(argc, argv, 1, 1, optlist) < 0)
+            {
+               exit(0);
+            }
+            else
+            {
+               runSettings.setJobs(atoi(optlist[0].c_str()));
+            }
+         }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--skip-same"))
+         {
+            runSettings.setSkipSame(true);
+         }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--snapshot"))
+         {
+            runSettings.setSnapshot(true);
+         }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--stats"))
+         {
+            if (MyOptArg(argc, argv, 1, 1, optlist) < 0)
+            {
+               exit(0);
+            }
+            else
+            {
+               runSettings.setStats(optlist[0]);
+            }
+         }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--stream"))
+         {
+            runSettings.setStreaming(true);
+         }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--timeout"))
+         {
+            if (MyOptArg(argc, argv, 1, 1, optlist) < 0)
+            {
+               exit(0);
+            }
+            else
+            {
+               runSettings.setTimeout(atof(optlist[0].c_str()));
+            }
+         }
          else if (MU_StringUtil::Strcasecmp(*argv, "--total"))
          {
             if (MyOptArg(argc, argv, 1, 1, optlist) < 0)
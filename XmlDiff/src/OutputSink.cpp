@@ -0,0 +1,256 @@
+/**
+ *
+ * @file OutputSink.cpp
+ * @brief This file contains the member function definitions for class OutputSink
+ */
+
+#include <cstring>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#include "OutputSink.h"
+
+
+
+
+// ==========================================================================
+OutputSink::OutputSink(size_t aBlockSize)
+   : mBlockSize(aBlockSize > 0 ? aBlockSize : 1)
+   , mFile(stdout)
+   , mCloseFile(false)
+   , mBinary(false)
+   , mFailed(false)
+   , mBlock(0)
+   , mWriter()
+   , mWriterRunning(false)
+   , mMaxQueued(1)
+   , mLock()
+   , mChanged()
+   , mQueued()
+   , mFree()
+   , mStopping(false)
+{
+   startBlock(new std::vector<char>);
+}
+
+
+
+
+// ==========================================================================
+OutputSink::~OutputSink()
+{
+   finish();
+
+   delete mBlock;
+   for (size_t i = 0; i < mFree.size(); ++i)
+      delete mFree[i];
+   mFree.clear();
+}
+
+
+
+
+// ==========================================================================
+bool OutputSink::open(const std::string& filename)
+{
+   // anything already collected goes to the old file
+   finish();
+
+   FILE* file = fopen(filename.c_str(), (mBinary ? "wb" : "w"));
+   if (!file)
+      return true;
+   mFile = file;
+   mCloseFile = true;
+   return false;
+}
+
+
+
+
+// ==========================================================================
+void OutputSink::setBinary()
+{
+   mBinary = true;
+#ifdef _WIN32
+   if (mFile)
+   {
+      fflush(mFile);
+      _setmode(_fileno(mFile), _O_BINARY);
+   }
+#endif
+}
+
+
+
+
+// ==========================================================================
+void OutputSink::startWriter(size_t maxQueued)
+{
+   if (mWriterRunning)
+      return;
+   mMaxQueued = (maxQueued > 0 ? maxQueued : 1);
+   mStopping = false;
+   mWriterRunning = true;
+   mWriter = std::thread(&OutputSink::writer, this);
+}
+
+
+
+
+// ==========================================================================
+bool OutputSink::finish()
+{
+   handOver();
+
+   if (mWriterRunning)
+   {
+      {
+         std::lock_guard<std::mutex> lock(mLock);
+         mStopping = true;
+      }
+      mChanged.notify_all();
+      mWriter.join();
+      mWriterRunning = false;
+   }
+
+   if (mFile)
+   {
+      if (fflush(mFile) != 0)
+         mFailed = true;
+      if (mCloseFile)
+      {
+         if (fclose(mFile) != 0)
+            mFailed = true;
+         mFile = stdout;
+         mCloseFile = false;
+      }
+   }
+   return mFailed;
+}
+
+
+
+
+// ==========================================================================
+OutputSink::int_type OutputSink::overflow(int_type c)
+{
+   handOver();
+   if (!traits_type::eq_int_type(c, traits_type::eof()))
+   {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+   }
+   return traits_type::not_eof(c);
+}
+
+
+
+
+// ==========================================================================
+std::streamsize OutputSink::xsputn(const char* s, std::streamsize n)
+{
+   std::streamsize left = n;
+   while (left > 0)
+   {
+      std::streamsize room = epptr() - pptr();
+      if (room == 0)
+      {
+         handOver();
+         continue;
+      }
+      std::streamsize count = (left < room ? left : room);
+      memcpy(pptr(), s, static_cast<size_t>(count));
+      pbump(static_cast<int>(count));
+      s += count;
+      left -= count;
+   }
+   return n;
+}
+
+
+
+
+// ==========================================================================
+void OutputSink::handOver()
+{
+   const size_t n = pptr() - pbase();
+   if (n == 0)
+      return;
+
+   if (!mWriterRunning)
+   {
+      // no writer thread, write it here and fill the same block again
+      mBlock->resize(n);
+      write(*mBlock);
+      startBlock(mBlock);
+      return;
+   }
+
+   mBlock->resize(n);
+   std::vector<char>* block = 0;
+   {
+      std::unique_lock<std::mutex> lock(mLock);
+      while (mQueued.size() >= mMaxQueued)
+         mChanged.wait(lock);
+      mQueued.push_back(mBlock);
+      if (!mFree.empty())
+      {
+         block = mFree.back();
+         mFree.pop_back();
+      }
+   }
+   mChanged.notify_all();
+
+   startBlock(block ? block : new std::vector<char>);
+}
+
+
+
+
+// ==========================================================================
+void OutputSink::startBlock(std::vector<char>* block)
+{
+   mBlock = block;
+   mBlock->resize(mBlockSize);
+   setp(&(*mBlock)[0], &(*mBlock)[0] + mBlockSize);
+}
+
+
+
+
+// ==========================================================================
+void OutputSink::write(const std::vector<char>& block)
+{
+   // only one thread writes at a time, and finish() reads mFailed after joining the writer
+   if (mFile && !block.empty() && fwrite(&block[0], 1, block.size(), mFile) != block.size())
+      mFailed = true;
+}
+
+
+
+
+// ==========================================================================
+void OutputSink::writer()
+{
+   std::unique_lock<std::mutex> lock(mLock);
+   for (;;)
+   {
+      while (mQueued.empty() && !mStopping)
+         mChanged.wait(lock);
+      if (mQueued.empty())
+         break;
+
+      std::vector<char>* block = mQueued.front();
+      mQueued.pop_front();
+
+      // write without holding the lock so the next block can be queued meanwhile
+      lock.unlock();
+      write(*block);
+      lock.lock();
+
+      mFree.push_back(block);
+      mChanged.notify_all();
+   }
+}
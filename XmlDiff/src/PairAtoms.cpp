@@ -0,0 +1,30 @@
+/**
+ *
+ * @file PairAtoms.cpp
+ * @brief This file contains the member function definitions for class PairAtoms
+ */
+
+#include "PairAtoms.h"
+
+using namespace tinyxml2;
+
+
+// ==========================================================================
+PairAtoms::PairAtoms(XMLDocument& doc1, XMLDocument& doc2)
+   : mAtoms()
+   , mDoc1(doc1)
+   , mDoc2(doc2)
+{
+   mDoc1.SetAtomTable(&mAtoms);
+   mDoc2.SetAtomTable(&mAtoms);
+}
+
+
+
+
+// ==========================================================================
+PairAtoms::~PairAtoms()
+{
+   mDoc1.SetAtomTable(nullptr);
+   mDoc2.SetAtomTable(nullptr);
+}
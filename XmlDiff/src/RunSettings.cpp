@@ -21,8 +21,26 @@ RunSettings::RunSettings()
    , mCaseSensitiveSet(false)
    , mDelimiters()
    , mDelimitersSet(false)
+   , mAttribs()
+   , mAttribsSet(false)
    , mReformat(false)
    , mSideBySide(false)
+   , mSideContext(-1)
+   , mMemoryMapped(false)
+   , mStreaming(false)
+   , mJobs(1)
+   , mSkipSame(false)
+   , mFingerprintCache(false)
+   , mSnapshot(false)
+   , mAlign(false)
+   , mQuick(false)
+   , mMaxDiffs(0)
+   , mTimeout(0.0)
+   , mBatchFile()
+   , mOutputFile()
+   , mAsyncOutput(false)
+   , mStats()
+   , mFormat("text")
    , mConfigXml()
    , mShowVersion(false)
    , mShowUsage(false)
@@ -42,8 +60,26 @@ RunSettings::RunSettings(double aDelta, bool aCase, const std::string& aDelim,
    , mCaseSensitiveSet(false)
    , mDelimiters(aDelim)
    , mDelimitersSet(true)
+   , mAttribs()
+   , mAttribsSet(false)
    , mReformat(aReformat)
    , mSideBySide(aSide)
+   , mSideContext(-1)
+   , mMemoryMapped(false)
+   , mStreaming(false)
+   , mJobs(1)
+   , mSkipSame(false)
+   , mFingerprintCache(false)
+   , mSnapshot(false)
+   , mAlign(false)
+   , mQuick(false)
+   , mMaxDiffs(0)
+   , mTimeout(0.0)
+   , mBatchFile()
+   , mOutputFile()
+   , mAsyncOutput(false)
+   , mStats()
+   , mFormat("text")
    , mConfigXml()
    , mShowVersion(aVersion)
    , mShowUsage(aUsage)
@@ -71,8 +107,26 @@ RunSettings::RunSettings(const RunSettings& p)
    , mCaseSensitiveSet(p.mCaseSensitiveSet)
    , mDelimiters(p.mDelimiters)
    , mDelimitersSet(p.mDelimitersSet)
+   , mAttribs(p.mAttribs)
+   , mAttribsSet(p.mAttribsSet)
    , mReformat(p.mReformat)
    , mSideBySide(p.mSideBySide)
+   , mSideContext(p.mSideContext)
+   , mMemoryMapped(p.mMemoryMapped)
+   , mStreaming(p.mStreaming)
+   , mJobs(p.mJobs)
+   , mSkipSame(p.mSkipSame)
+   , mFingerprintCache(p.mFingerprintCache)
+   , mSnapshot(p.mSnapshot)
+   , mAlign(p.mAlign)
+   , mQuick(p.mQuick)
+   , mMaxDiffs(p.mMaxDiffs)
+   , mTimeout(p.mTimeout)
+   , mBatchFile(p.mBatchFile)
+   , mOutputFile(p.mOutputFile)
+   , mAsyncOutput(p.mAsyncOutput)
+   , mStats(p.mStats)
+   , mFormat(p.mFormat)
    , mConfigXml()
    , mShowVersion(p.mShowVersion)
    , mShowUsage(p.mShowUsage)
@@ -100,8 +154,26 @@ RunSettings& RunSettings::operator = (const RunSettings& p)
       mCaseSensitiveSet = p.mCaseSensitiveSet;
       mDelimiters    = p.mDelimiters;
       mDelimitersSet = p.mDelimitersSet;
+      mAttribs       = p.mAttribs;
+      mAttribsSet    = p.mAttribsSet;
       mReformat      = p.mReformat;
       mSideBySide    = p.mSideBySide;
+      mSideContext   = p.mSideContext;
+      mMemoryMapped  = p.mMemoryMapped;
+      mStreaming     = p.mStreaming;
+      mJobs          = p.mJobs;
+      mSkipSame      = p.mSkipSame;
+      mFingerprintCache = p.mFingerprintCache;
+      mSnapshot      = p.mSnapshot;
+      mAlign         = p.mAlign;
+      mQuick         = p.mQuick;
+      mMaxDiffs      = p.mMaxDiffs;
+      mTimeout       = p.mTimeout;
+      mBatchFile     = p.mBatchFile;
+      mOutputFile    = p.mOutputFile;
+      mAsyncOutput   = p.mAsyncOutput;
+      mStats         = p.mStats;
+      mFormat        = p.mFormat;
       mShowVersion   = p.mShowVersion;
       mShowUsage     = p.mShowUsage;
       mTotalFile     = p.mTotalFile;
@@ -122,8 +194,25 @@ void RunSettings::show(std::ostream& stream) const
    stream << "<delta>" << mDelta << "</delta>";
    stream << "<case>" << (mCaseSensitive ? "true" : "false") << "</case>";
    stream << "<delim>" << mDelimiters << "</delim>";
+   stream << "<attribs>" << mAttribs << "</attribs>";
    stream << "<reformat>" << (mReformat ? "true" : "false") << "</reformat>";
    stream << "<side>" << (mReformat ? "true" : "false") << "</side>";
+   stream << "<context>" << mSideContext << "</context>";
+   stream << "<mmap>" << (mMemoryMapped ? "true" : "false") << "</mmap>";
+   stream << "<stream>" << (mStreaming ? "true" : "false") << "</stream>";
+   stream << "<jobs>" << mJobs << "</jobs>";
+   stream << "<skipsame>" << (mSkipSame ? "true" : "false") << "</skipsame>";
+   stream << "<cache>" << (mFingerprintCache ? "true" : "false") << "</cache>";
+   stream << "<snapshot>" << (mSnapshot ? "true" : "false") << "</snapshot>";
+   stream << "<align>" << (mAlign ? "true" : "false") << "</align>";
+   stream << "<quick>" << (mQuick ? "true" : "false") << "</quick>";
+   stream << "<maxdiffs>" << mMaxDiffs << "</maxdiffs>";
+   stream << "<timeout>" << mTimeout << "</timeout>";
+   stream << "<batch>" << mBatchFile << "</batch>";
+   stream << "<output>" << mOutputFile << "</output>";
+   stream << "<async>" << (mAsyncOutput ? "true" : "false") << "</async>";
+   stream << "<stats>" << mStats << "</stats>";
+   stream << "<format>" << mFormat << "</format>";
    XMLPrinter printer;
    mConfigXml.Print(&printer);
    stream << "<config>" << printer.CStr() << "</config>";
@@ -227,3 +316,13 @@ void RunSettings::setDelim(const std::string& aDelim)
    mDelimiters = aDelim;
    mDelimitersSet = true;
 }
+
+
+
+
+// ==========================================================================
+void RunSettings::setAttribs(const std::string& aList)
+{
+   mAttribs = aList;
+   mAttribsSet = true;
+}
@@ -0,0 +1,524 @@
+/**
+ *
+ * @file SiblingAligner.cpp
+ * @brief This file contains the member function definitions for class SiblingAligner
+ */
+
+#include <string.h>
+
+#include "SiblingAligner.h"
+#include "MU_Hash.h"
+#include "MU_StringUtil.h"
+#include "XmlFingerprint.h"
+
+using namespace std;
+using namespace tinyxml2;
+
+
+namespace
+{
+   // the most cells the common subsequence of one run may use, a byte each
+   const size_t MaxCells = 16 * 1024 * 1024;
+
+   // runs this small are paired by tag without a hash table
+   const size_t SmallRun = 64;
+
+   const size_t None = static_cast<size_t>(-1);
+
+   // steps back through the common subsequence table
+   const unsigned char StepUp = 0;
+   const unsigned char StepLeft = 1;
+   const unsigned char StepDiagonal = 2;
+}
+
+
+
+
+// ==========================================================================
+SiblingAligner::SiblingAligner(bool aCaseSensitive, size_t aWindow)
+   : mCaseSensitive(aCaseSensitive)
+   , mWindow(aWindow)
+   , mSiblings1()
+   , mSiblings2()
+   , mRun1()
+   , mRun2()
+   , mCounts()
+   , mKeys()
+   , mFirst()
+   , mNext()
+   , mValues()
+   , mSteps()
+   , mRowStart()
+   , mMatches()
+   , mTails()
+   , mLinks()
+{
+}
+
+
+
+
+// ==========================================================================
+void SiblingAligner::align(XMLElement* first1, XMLElement* first2, std::vector<Pair>& pairs)
+{
+   collect(first1, mSiblings1);
+   collect(first2, mSiblings2);
+   const size_t n1 = mSiblings1.size();
+   const size_t n2 = mSiblings2.size();
+
+   if (samePlaces())
+   {
+      for (size_t i = 0; i < n1; ++i)
+         pairs.push_back(Pair(mSiblings1[i].element, mSiblings2[i].element));
+      return;
+   }
+
+   pairNames();
+   findAnchors();
+
+   // the siblings without a name are lined up between one anchor and the next
+   size_t begin1 = 0;
+   size_t begin2 = 0;
+   for (size_t i = 0; i < n1; ++i)
+   {
+      if (mSiblings1[i].anchor)
+      {
+         const size_t j = mSiblings1[i].partner;
+         alignRun(begin1, i, begin2, j);
+         begin1 = i + 1;
+         begin2 = j + 1;
+      }
+   }
+   alignRun(begin1, n1, begin2, n2);
+
+   // file 1 order.  an element only in file 2 goes before the next pair that is in
+   // order in file 2; elements that moved are paired where they are in file 1
+   size_t next2 = 0;
+   for (size_t i = 0; i < n1; ++i)
+   {
+      const Sibling& s1 = mSiblings1[i];
+      if (s1.partner < 0)
+      {
+         pairs.push_back(Pair(s1.element, nullptr));
+         continue;
+      }
+
+      const size_t j = s1.partner;
+      if ((s1.anchor || !s1.name) && j >= next2)
+      {
+         for (; next2 < j; ++next2)
+         {
+            if (mSiblings2[next2].partner < 0)
+               pairs.push_back(Pair(nullptr, mSiblings2[next2].element));
+         }
+         next2 = j + 1;
+      }
+      pairs.push_back(Pair(s1.element, mSiblings2[j].element));
+   }
+   for (; next2 < n2; ++next2)
+   {
+      if (mSiblings2[next2].partner < 0)
+         pairs.push_back(Pair(nullptr, mSiblings2[next2].element));
+   }
+}
+
+
+
+
+// ==========================================================================
+void SiblingAligner::collect(XMLElement* first, std::vector<Sibling>& siblings) const
+{
+   siblings.clear();
+   for (XMLElement* elem = first; elem; elem = elem->NextSiblingElement())
+   {
+      Sibling s;
+      s.element = elem;
+      s.name = elem->Attribute("name");
+      s.partner = -1;
+      s.anchor = false;
+
+      // a marker byte keeps a name apart from a tag of the same letters
+      const char* tag = elem->Value();
+      s.key = (s.name ? hashName(MU_Hash::AddByte(MU_Hash::Start, '@'), s.name) : hashName(MU_Hash::AddByte(MU_Hash::Start, '<'), tag));
+
+      const XmlFingerprint::Entry* fingerprint = XmlFingerprint::get(elem);
+      if (fingerprint)
+      {
+         s.content = fingerprint->hash;
+      }
+      else
+      {
+         unsigned long long hash = hashName(MU_Hash::AddByte(MU_Hash::Start, '<'), tag);
+         for (const XMLAttribute* attrib = elem->FirstAttribute(); attrib; attrib = attrib->Next())
+         {
+            hash = hashName(MU_Hash::AddByte(hash, '@'), attrib->Name());
+            hash = hashName(MU_Hash::AddByte(hash, '='), attrib->Value());
+         }
+         const char* text = elem->GetText();
+         if (text)
+            hash = hashName(MU_Hash::AddByte(hash, '>'), text);
+         s.content = hash;
+      }
+
+      siblings.push_back(s);
+   }
+}
+
+
+
+
+// ==========================================================================
+bool SiblingAligner::samePlaces() const
+{
+   if (mSiblings1.size() != mSiblings2.size())
+      return false;
+   // an element without a name is only known by its content, the same tag could be
+   // another element, so those must be the same all through
+   for (size_t i = 0; i < mSiblings1.size(); ++i)
+   {
+      const Sibling& s1 = mSiblings1[i];
+      if (!sameKey(s1, mSiblings2[i]) || (!s1.name && s1.content != mSiblings2[i].content))
+         return false;
+   }
+   return true;
+}
+
+
+
+
+// ==========================================================================
+void SiblingAligner::pairNames()
+{
+   // the key of the k-th sibling with a name is the hash of the name and k
+   mCounts.clear();
+   mKeys.clear();
+   for (size_t j = 0; j < mSiblings2.size(); ++j)
+   {
+      const Sibling& s2 = mSiblings2[j];
+      if (s2.name)
+      {
+         const unsigned long long k = mCounts[s2.key]++;
+         mKeys.insert(make_pair(MU_Hash::Mix(s2.key + k), static_cast<unsigned int>(j)));
+      }
+   }
+
+   mCounts.clear();
+   for (size_t i = 0; i < mSiblings1.size(); ++i)
+   {
+      const Sibling& s1 = mSiblings1[i];
+      if (s1.name)
+      {
+         const unsigned long long k = mCounts[s1.key]++;
+         unordered_map<unsigned long long, unsigned int>::const_iterator k_it = mKeys.find(MU_Hash::Mix(s1.key + k));
+         if (k_it != mKeys.end() && mSiblings2[k_it->second].partner < 0 && sameKey(s1, mSiblings2[k_it->second]))
+            setPartners(i, k_it->second);
+      }
+   }
+}
+
+
+
+
+// ==========================================================================
+void SiblingAligner::findAnchors()
+{
+   // longest increasing run of the file 2 indexes of the named pairs, in file 1 order.
+   // mTails[L] is the pair ending the best run of length L+1 found so far
+   mRun1.clear();
+   for (size_t i = 0; i < mSiblings1.size(); ++i)
+   {
+      if (mSiblings1[i].partner >= 0)
+         mRun1.push_back(i);
+   }
+
+   mTails.clear();
+   mLinks.assign(mRun1.size(), -1);
+   for (size_t p = 0; p < mRun1.size(); ++p)
+   {
+      const int j = mSiblings1[mRun1[p]].partner;
+      size_t lo = 0;
+      size_t hi = mTails.size();
+      while (lo < hi)
+      {
+         const size_t mid = (lo + hi) / 2;
+         if (mSiblings1[mRun1[mTails[mid]]].partner < j)
+            lo = mid + 1;
+         else
+            hi = mid;
+      }
+      if (lo > 0)
+         mLinks[p] = static_cast<int>(mTails[lo - 1]);
+      if (lo == mTails.size())
+         mTails.push_back(p);
+      else
+         mTails[lo] = p;
+   }
+
+   if (mTails.empty())
+      return;
+   for (int p = static_cast<int>(mTails.back()); p >= 0; p = mLinks[p])
+   {
+      Sibling& s1 = mSiblings1[mRun1[p]];
+      s1.anchor = true;
+      mSiblings2[s1.partner].anchor = true;
+   }
+}
+
+
+
+
+// ==========================================================================
+void SiblingAligner::alignRun(size_t begin1, size_t end1, size_t begin2, size_t end2)
+{
+   mRun1.clear();
+   for (size_t i = begin1; i < end1; ++i)
+   {
+      if (!mSiblings1[i].name)
+         mRun1.push_back(i);
+   }
+   mRun2.clear();
+   for (size_t j = begin2; j < end2; ++j)
+   {
+      if (!mSiblings2[j].name)
+         mRun2.push_back(j);
+   }
+
+   if (!mRun1.empty() && !mRun2.empty())
+      pairCommon();
+}
+
+
+
+
+// ==========================================================================
+void SiblingAligner::pairCommon()
+{
+   const size_t n = mRun1.size();
+   const size_t m = mRun2.size();
+
+   // the same at the start and the end, the usual case, needs no table
+   size_t head = 0;
+   while (head < n && head < m && mSiblings1[mRun1[head]].content == mSiblings2[mRun2[head]].content &&
+      sameTag(mSiblings1[mRun1[head]].element, mSiblings2[mRun2[head]].element))
+   {
+      setPartners(mRun1[head], mRun2[head]);
+      ++head;
+   }
+   size_t tail = 0;
+   while (tail < n - head && tail < m - head &&
+      mSiblings1[mRun1[n - 1 - tail]].content == mSiblings2[mRun2[m - 1 - tail]].content &&
+      sameTag(mSiblings1[mRun1[n - 1 - tail]].element, mSiblings2[mRun2[m - 1 - tail]].element))
+   {
+      setPartners(mRun1[n - 1 - tail], mRun2[m - 1 - tail]);
+      ++tail;
+   }
+
+   // the rest is a table of rows 0..rows and columns 0..cols, but row r only has the
+   // columns within mWindow of the diagonal from (0,0) to (rows,cols)
+   const size_t rows = n - head - tail;
+   const size_t cols = m - head - tail;
+   if (rows == 0 || cols == 0)
+      return;
+
+   mRowStart.resize(rows + 2);
+   mRowStart[1] = 0;
+   for (size_t r = 1; r <= rows; ++r)
+   {
+      const unsigned long long from = static_cast<unsigned long long>(r - 1) * cols / rows;
+      const unsigned long long to = (static_cast<unsigned long long>(r) * cols + rows - 1) / rows;
+      const size_t lo = (from > mWindow ? static_cast<size_t>(from) - mWindow : 0);
+      const size_t hi = (to + mWindow < cols ? static_cast<size_t>(to) + mWindow : cols);
+      mRowStart[r + 1] = mRowStart[r] + (hi - lo + 1);
+      if (mRowStart[r + 1] > MaxCells)
+      {
+         // too big to search, pair it all by tag
+         pairTags(head, n - tail, head, m - tail);
+         return;
+      }
+   }
+   mSteps.resize(mRowStart[rows + 1]);
+
+   // two rows of lengths, indexed by column
+   mValues.assign(2 * (cols + 1), 0);
+   size_t prevLo = 0;
+   size_t prevHi = cols;
+   for (size_t r = 1; r <= rows; ++r)
+   {
+      const unsigned long long from = static_cast<unsigned long long>(r - 1) * cols / rows;
+      const size_t lo = (from > mWindow ? static_cast<size_t>(from) - mWindow : 0);
+      const size_t hi = lo + (mRowStart[r + 1] - mRowStart[r]) - 1;
+      const int* prev = &mValues[((r - 1) & 1) * (cols + 1)];
+      int* cur = &mValues[(r & 1) * (cols + 1)];
+      unsigned char* steps = &mSteps[mRowStart[r]];
+      const Sibling& s1 = mSiblings1[mRun1[head + r - 1]];
+
+      for (size_t c = lo; c <= hi; ++c)
+      {
+         // the row above covers this column, since the rows overlap
+         int best = -1;
+         unsigned char step = StepUp;
+         if (c >= prevLo && c <= prevHi)
+            best = prev[c];
+         if (c > lo && cur[c - 1] > best)
+         {
+            best = cur[c - 1];
+            step = StepLeft;
+         }
+         if (c > 0 && c - 1 >= prevLo && c - 1 <= prevHi && prev[c - 1] + 1 > best)
+         {
+            const Sibling& s2 = mSiblings2[mRun2[head + c - 1]];
+            if (s1.content == s2.content && sameTag(s1.element, s2.element))
+            {
+               best = prev[c - 1] + 1;
+               step = StepDiagonal;
+            }
+         }
+         cur[c] = best;
+         steps[c - lo] = step;
+      }
+      prevLo = lo;
+      prevHi = hi;
+   }
+
+   // walk back from the end for the matches
+   mMatches.clear();
+   size_t r = rows;
+   size_t c = cols;
+   while (r > 0 && c > 0)
+   {
+      const unsigned long long from = static_cast<unsigned long long>(r - 1) * cols / rows;
+      const size_t lo = (from > mWindow ? static_cast<size_t>(from) - mWindow : 0);
+      const unsigned char step = mSteps[mRowStart[r] + c - lo];
+      if (step == StepDiagonal)
+      {
+         mMatches.push_back(make_pair(head + r - 1, head + c - 1));
+         --r;
+         --c;
+      }
+      else if (step == StepLeft)
+      {
+         --c;
+      }
+      else
+      {
+         --r;
+      }
+   }
+
+   // the ones left between two matches are paired by tag
+   size_t next1 = head;
+   size_t next2 = head;
+   for (size_t k = mMatches.size(); k > 0; --k)
+   {
+      const pair<size_t, size_t>& match = mMatches[k - 1];
+      pairTags(next1, match.first, next2, match.second);
+      setPartners(mRun1[match.first], mRun2[match.second]);
+      next1 = match.first + 1;
+      next2 = match.second + 1;
+   }
+   pairTags(next1, n - tail, next2, m - tail);
+}
+
+
+
+
+// ==========================================================================
+void SiblingAligner::pairTags(size_t begin1, size_t end1, size_t begin2, size_t end2)
+{
+   if (begin1 >= end1 || begin2 >= end2)
+      return;
+
+   // the first unpaired element with the same tag, in order, is tag and ordinal
+   if ((end1 - begin1) * (end2 - begin2) <= SmallRun)
+   {
+      for (size_t x = begin1; x < end1; ++x)
+      {
+         const Sibling& s1 = mSiblings1[mRun1[x]];
+         if (s1.partner >= 0)
+            continue;
+         for (size_t y = begin2; y < end2; ++y)
+         {
+            const Sibling& s2 = mSiblings2[mRun2[y]];
+            if (s2.partner < 0 && s1.key == s2.key && sameTag(s1.element, s2.element))
+            {
+               setPartners(mRun1[x], mRun2[y]);
+               break;
+            }
+         }
+      }
+      return;
+   }
+
+   // a list of the unpaired elements of each tag, in order, through mNext
+   mFirst.clear();
+   mNext.assign(end2 - begin2, None);
+   for (size_t y = end2; y > begin2; --y)
+   {
+      const Sibling& s2 = mSiblings2[mRun2[y - 1]];
+      if (s2.partner >= 0)
+         continue;
+      pair<unordered_map<unsigned long long, size_t>::iterator, bool> ins = mFirst.insert(make_pair(s2.key, y - 1));
+      if (!ins.second)
+      {
+         mNext[y - 1 - begin2] = ins.first->second;
+         ins.first->second = y - 1;
+      }
+   }
+
+   for (size_t x = begin1; x < end1; ++x)
+   {
+      const Sibling& s1 = mSiblings1[mRun1[x]];
+      if (s1.partner >= 0)
+         continue;
+      unordered_map<unsigned long long, size_t>::iterator f_it = mFirst.find(s1.key);
+      if (f_it == mFirst.end() || f_it->second == None)
+         continue;
+      const size_t y = f_it->second;
+      if (sameTag(s1.element, mSiblings2[mRun2[y]].element))
+      {
+         setPartners(mRun1[x], mRun2[y]);
+         f_it->second = mNext[y - begin2];
+      }
+   }
+}
+
+
+
+
+// ==========================================================================
+void SiblingAligner::setPartners(size_t i, size_t j)
+{
+   mSiblings1[i].partner = static_cast<int>(j);
+   mSiblings2[j].partner = static_cast<int>(i);
+}
+
+
+
+
+// ==========================================================================
+bool SiblingAligner::sameKey(const Sibling& s1, const Sibling& s2) const
+{
+   if (s1.key != s2.key || !s1.name != !s2.name)
+      return false;
+   if (!s1.name)
+      return sameTag(s1.element, s2.element);
+   return (mCaseSensitive ? strcmp(s1.name, s2.name) == 0 : MU_StringUtil::Strcasecmp(s1.name, s2.name));
+}
+
+
+
+
+// ==========================================================================
+bool SiblingAligner::sameTag(const XMLElement* e1, const XMLElement* e2) const
+{
+   return (mCaseSensitive ? strcmp(e1->Value(), e2->Value()) == 0 : MU_StringUtil::Strcasecmp(e1->Value(), e2->Value()));
+}
+
+
+
+
+// ==========================================================================
+unsigned long long SiblingAligner::hashName(unsigned long long hash, const char* p) const
+{
+   return (mCaseSensitive ? MU_Hash::AddChars(hash, p, strlen(p)) : MU_Hash::AddLower(hash, p));
+}
@@ -0,0 +1,172 @@
+/**
+ *
+ * @file SideBySideWriter.cpp
+ * @brief This file contains the member function definitions for class SideBySideWriter
+ */
+
+#include <cctype>
+
+#include "MU_StringView.h"
+
+#include "SideBySideWriter.h"
+#include "XmlAttributeView.h"
+
+using namespace tinyxml2;
+
+
+
+
+// ==========================================================================
+SideBySideWriter::SideBySideWriter(int aContext, size_t aMargin)
+   : mContext(aContext)
+   , mMargin(aMargin)
+   , mRing()
+   , mFirst(0)
+   , mHeld(0)
+   , mTrailing(0)
+   , mCurrentShown(true)
+   , mSkipped(false)
+   , mAnyShown(false)
+   , mLine()
+{
+}
+
+
+
+
+// ==========================================================================
+void SideBySideWriter::pair(std::ostream& out, const XMLElement* elem1, const XMLElement* elem2)
+{
+   if (!elem1 || !elem2)
+      return;
+
+   if (mContext < 0 || mTrailing > 0)
+   {
+      // written now, so only one slot is needed
+      if (mRing.empty())
+         mRing.resize(1);
+      render(elem1, mRing[0].text1);
+      render(elem2, mRing[0].text2);
+      write(out, mRing[0]);
+      if (mTrailing > 0)
+         --mTrailing;
+      mCurrentShown = true;
+      mAnyShown = true;
+      return;
+   }
+
+   // the ring only grows as far as it is used, so a large context costs nothing until then
+   const size_t capacity = static_cast<size_t>(mContext) + 1;
+   if (mHeld == capacity)
+   {
+      mFirst = (mFirst + 1) % capacity;
+      --mHeld;
+      mSkipped = true;
+   }
+   const size_t slot = (mFirst + mHeld) % capacity;
+   if (slot == mRing.size())
+      mRing.resize(slot + 1);
+   render(elem1, mRing[slot].text1);
+   render(elem2, mRing[slot].text2);
+   ++mHeld;
+   mCurrentShown = false;
+}
+
+
+
+
+// ==========================================================================
+void SideBySideWriter::difference(std::ostream& out)
+{
+   if (mContext < 0 || mCurrentShown)
+      return;
+
+   if (mSkipped && mAnyShown)
+      out << "--\n";
+   for (size_t i = 0; i < mHeld; ++i)
+      write(out, mRing[(mFirst + i) % mRing.size()]);
+
+   mFirst = 0;
+   mHeld = 0;
+   mTrailing = mContext;
+   mCurrentShown = true;
+   mSkipped = false;
+   mAnyShown = true;
+}
+
+
+
+
+// ==========================================================================
+void SideBySideWriter::render(const XMLElement* elem, std::string& text)
+{
+   const char* tag = elem->Value();
+   text.assign("<");
+   text += tag;
+
+   // attributes in order of their names, which are shown in lower case
+   XmlAttributeView attribs(elem);
+   attribs.sortByName();
+   for (size_t i = 0; i < attribs.size(); ++i)
+   {
+      text += ' ';
+      for (const char* p = attribs[i].name; *p; ++p)
+         text += static_cast<char>(tolower(static_cast<unsigned char>(*p)));
+      text += "=\"";
+      text += attribs[i].value;
+      text += '"';
+   }
+
+   const char* content = elem->GetText();
+   if (content)
+   {
+      text += '>';
+      text += content;
+      text += "</";
+      text += tag;
+      text += '>';
+   }
+   else
+   {
+      text += "/>";
+   }
+
+   // the lines are wrapped on spaces, and a new line would break up the columns
+   for (size_t i = 0; i < text.size(); ++i)
+   {
+      if (text[i] == '\n')
+         text[i] = ' ';
+   }
+}
+
+
+
+
+// ==========================================================================
+void SideBySideWriter::write(std::ostream& out, const Pair& pair)
+{
+   MU_LineWrapper wrap1(pair.text1.data(), pair.text1.size(), mMargin);
+   MU_LineWrapper wrap2(pair.text2.data(), pair.text2.size(), mMargin);
+   MU_StringView line1;
+   MU_StringView line2;
+   bool more1 = wrap1.next(line1);
+   bool more2 = wrap2.next(line2);
+   while (more1 || more2)
+   {
+      mLine.assign(1, '|');
+      if (more1)
+         mLine.append(line1.data(), line1.size());
+      mLine.append(mMargin - (more1 ? line1.size() : 0), ' ');
+      mLine += '|';
+      if (more2)
+         mLine.append(line2.data(), line2.size());
+      mLine.append(mMargin - (more2 ? line2.size() : 0), ' ');
+      mLine += "|\n";
+      out.write(mLine.data(), mLine.size());
+
+      if (more1)
+         more1 = wrap1.next(line1);
+      if (more2)
+         more2 = wrap2.next(line2);
+   }
+}
@@ -0,0 +1,131 @@
+/**
+ *
+ * @file SidecarFile.cpp
+ * @brief This file contains the member function definitions for class SidecarFile
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "SidecarFile.h"
+
+
+namespace
+{
+   // the temporary names taken so far by this process
+   std::atomic<unsigned int> TemporaryCount(0);
+}
+
+
+
+
+// ==========================================================================
+bool SidecarFile::fileKey(const std::string& filename, unsigned long long& size, long long& modified)
+{
+#ifdef _WIN32
+   // the time in 100 nanosecond ticks, _stat64 only gives seconds
+   WIN32_FILE_ATTRIBUTE_DATA info;
+   if (!GetFileAttributesExA(filename.c_str(), GetFileExInfoStandard, &info))
+      return false;
+   size = (static_cast<unsigned long long>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+   modified = static_cast<long long>((static_cast<unsigned long long>(info.ftLastWriteTime.dwHighDateTime) << 32)
+      | info.ftLastWriteTime.dwLowDateTime);
+#else
+   struct stat info;
+   if (stat(filename.c_str(), &info) != 0)
+      return false;
+   size = static_cast<unsigned long long>(info.st_size);
+   // in nanoseconds
+#ifdef __APPLE__
+   modified = static_cast<long long>(info.st_mtimespec.tv_sec) * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+   modified = static_cast<long long>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+#endif
+   return true;
+}
+
+
+
+
+// ==========================================================================
+bool SidecarFile::writtenAfter(const std::string& sidecar, long long modified)
+{
+   // where the file system keeps whole seconds, a change made in the same second the sidecar
+   // was written has the sidecar's time, and may not be in it.  so it must be later, not the same
+   unsigned long long size = 0;
+   long long written = 0;
+   return fileKey(sidecar, size, written) && written > modified;
+}
+
+
+
+
+// ==========================================================================
+std::string SidecarFile::temporaryName(const std::string& name)
+{
+   // the process id and a count keep the runs and threads that may write the same sidecar at
+   // once apart.  the clock keeps this run apart from a process of the same id that left one behind
+#ifdef _WIN32
+   const unsigned long long process = static_cast<unsigned long long>(_getpid());
+#else
+   const unsigned long long process = static_cast<unsigned long long>(getpid());
+#endif
+   const unsigned long long count = ++TemporaryCount;
+   const unsigned long long ticks = static_cast<unsigned long long>(std::chrono::steady_clock::now().time_since_epoch().count());
+   return name + "." + std::to_string(process) + "." + std::to_string(count) + "." + std::to_string(ticks) + ".tmp";
+}
+
+
+
+
+// ==========================================================================
+FILE* SidecarFile::create(const std::string& temporary)
+{
+   // exclusive, so two writers can never share one file even if the names did meet
+#ifdef _WIN32
+   const int fd = _open(temporary.c_str(), _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY, _S_IREAD | _S_IWRITE);
+   if (fd < 0)
+      return nullptr;
+   FILE* file = _fdopen(fd, "wb");
+   if (!file)
+      _close(fd);
+#else
+   const int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+   if (fd < 0)
+      return nullptr;
+   FILE* file = fdopen(fd, "wb");
+   if (!file)
+      close(fd);
+#endif
+   return file;
+}
+
+
+
+
+// ==========================================================================
+bool SidecarFile::replace(const std::string& temporary, const std::string& name)
+{
+#ifdef _WIN32
+   // rename() does not replace a file here
+   remove(name.c_str());
+#endif
+   if (rename(temporary.c_str(), name.c_str()) != 0)
+   {
+      remove(temporary.c_str());
+      return true;
+   }
+   return false;
+}
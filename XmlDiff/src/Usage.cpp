@@ -40,20 +40,83 @@ void Usage(const char* progName)
       << progName << " - check for differences between two XML files\n"
       << "\n"
       << "Usage:  " << progName << " [options] <file1> <file2>\n"
+      << "        " << progName << " [options] --batch <manifest>\n"
       << "\n"
       << "Optional arguments (not case sensitive) are:\n"
+      << "   --align             -> Pair the child elements of two elements by their name\n"
+      << "                          attribute, or by tag and order, instead of by position.\n"
+      << "                          An element added or removed is reported once as inserted\n"
+      << "                          or deleted instead of shifting every element after it.\n"
+      << "                          (not used with --stream)\n"
+      << "   --async             -> Write the output on a separate thread, so the comparison\n"
+      << "                          does not wait for the disk or the terminal\n"
+      << "   --attribs <names>   -> Compare only these attributes, separated by commas, or\n"
+      << "                          'all' to compare every attribute [name,type]\n"
+      << "   --batch <manifest>  -> Compare each pair of files listed in the manifest, one\n"
+      << "                          pair per line (see below). The pairs are compared on\n"
+      << "                          the --jobs threads and the results written in order,\n"
+      << "                          followed by the totals for all pairs\n"
+      << "   --cache             -> Keep the fingerprints of each file 1 (see --skip-same) in\n"
+      << "                          '<file1>.xdfp' and use them again while file 1 has the\n"
+      << "                          same size and time and the settings are the same. If\n"
+      << "                          file 2 has the same fingerprints file 1 is not even read.\n"
+      << "                          Implies --skip-same\n"
       << "   --case true|false   -> Set string comparison to be case sensitive or insensitive.\n"
       << "                          This applies to tags, attribute name, and attribute value.\n"
       << "                          It also is used when matching against filters in the\n"
       << "                          config file. [false]\n"
       << "   --config file[.xml] -> Use XML config file to get settings\n"
+      << "   --context <N>       -> With --side, only show the pairs of elements that differ\n"
+      << "                          and N pairs before and after each of them. Compares on\n"
+      << "                          one thread\n"
       << "   --delim <string>    -> Use characters in <string> as delimiters when breaking up\n"
       << "                          XML attribute value and content into tokens [defaults to a\n"
       << "                          space but commas and tabs are commonly used also \" ,\\t\"]\n"
       << "   --delta d           -> Use d as delta value when comparing numbers [1e-7]\n"
+      << "   --format <name>     -> Write the differences as 'text' (the default), 'jsonl'\n"
+      << "                          (one JSON object per line) or 'binary' records (see\n"
+      << "                          below). --side is not used with jsonl or binary\n"
+      << "   --jobs <N>          -> Compare the subtrees of the files on N threads. The\n"
+      << "                          output is the same as with one thread. With --batch,\n"
+      << "                          N pairs of files are compared at a time instead.\n"
+      << "                          (default 1, not used with --stream)\n"
+      << "   --max-diffs <N>     -> Stop after writing N differences. The counts are the\n"
+      << "                          counts up to there. Compares on one thread\n"
+      << "   --mmap              -> Map the input files into memory instead of reading them\n"
+      << "                          into a buffer (less memory for very large files)\n"
+      << "   --output <file>     -> Write the output to this file instead of the screen. The\n"
+      << "                          output is written in large blocks either way, and all of\n"
+      << "                          it when the program ends\n"
+      << "   --quick             -> Only find out if the files are the same: files that are\n"
+      << "                          the same byte for byte are not read as XML, otherwise\n"
+      << "                          the comparison stops at the first difference (or after\n"
+      << "                          --max-diffs differences). The exit\n"
+      << "                          status is 0 if the same, 2 if they differ, 3 if --timeout\n"
+      << "                          ran out first and 1 on an error\n"
       << "   --ref               -> Reformat the input files and print as 'xmldiff_file1.xml\n"
-      << "                          and 'xmldiff_file2.xml\n"
+      << "                          and 'xmldiff_file2.xml (not used with --batch)\n"
       << "   --side              -> Display file1 and file2 side by side during the comparison\n"
+      << "                          (every pair of elements, see --context)\n"
+      << "   --skip-same         -> Fingerprint every subtree after loading and skip the ones\n"
+      << "                          that are the same in both files. Much faster when the\n"
+      << "                          files are mostly the same. (not used with --side or\n"
+      << "                          --stream)\n"
+      << "   --snapshot          -> Keep each file 1 as a binary snapshot of its parsed\n"
+      << "                          document in '<file1>.xdsnap', and load it from there\n"
+      << "                          without parsing while file 1 has the same size and time.\n"
+      << "                          A snapshot can also be given in place of either file.\n"
+      << "                          Records have no offsets for a snapshot (not used with\n"
+      << "                          --stream)\n"
+      << "   --stats text|json   -> When done, write where the time and memory went to\n"
+      << "                          stderr: the wall and CPU time of each phase (load,\n"
+      << "                          parse, compare, output), bytes and elements per second,\n"
+      << "                          tokens and numbers compared, the tinyxml2 memory pools\n"
+      << "                          of the documents and the peak resident memory\n"
+      << "   --stream            -> Compare the files while reading them instead of loading\n"
+      << "                          them first. Memory use no longer depends on file size.\n"
+      << "                          Cannot be used with --ref\n"
+      << "   --timeout <seconds> -> Stop comparing after this many seconds (of the whole run\n"
+      << "                          with --batch). The counts are the counts up to there\n"
       << "   --total <file>      -> Append total number of differences to this file\n"
       << "   --version           -> Print program version and exit\n"
       << "   --v                 -> Same as --version\n"
@@ -71,7 +134,8 @@ void Usage(const char* progName)
       << "<XmlDiff>\n"
       << "   <Case>false</Case>\n"
       << "   <Delim>|{, \\n</Delim>\n"
-      << "   <Delta>1.0e-8</Delta>\n"
+      << "   <Delta rel=\"0\" ulp=\"0\">1.0e-8</Delta>\n"
+      << "   <Attribs>name, type, units</Attribs>\n"
       << "   <Ignore>\n"
       << "      <FilterText name=\"test\" type=\"double\"/>\n"
       << "      <VarTag name = \"MyVar\"/>\n"
@@ -79,11 +143,16 @@ void Usage(const char* progName)
       << "</XmlDiff>\n"
       << "\n";
 
-   text = "The above example sets the values for the --case, --delim, and --delta flags and two element"
-      " filters that are part of the 'ignore' list. Case-sensitivity in string comparisons is turned"
+   text = "The above example sets the values for the --case, --delim, --delta and --attribs flags and two"
+      " element filters that are part of the 'ignore' list. Case-sensitivity in string comparisons is turned"
       " off. Token delimiters are set to vertical bar, left brace, comma, space, and newline. The delta"
-      " value for comparing two numbers as the same is 1.0e-8, and two filters are added to the list of"
-      " tags to ignore.\n";
+      " value for comparing two numbers as the same is 1.0e-8, the units attribute is compared as well as"
+      " the name and type, and two filters are added to the list of tags to ignore.\n";
+   marginOutput(cout, text);
+   text = "Two numbers are the same if they differ by no more than the delta, or if the optional"
+      " 'rel' attribute is set, by no more than rel times the larger of the two, or if the optional"
+      " 'ulp' attribute is set, if there are no more than that many doubles between them (units in the"
+      " last place). Zero turns the 'rel' and 'ulp' tests off.\n";
    marginOutput(cout, text);
    text = "Any elements in file1 that"
       " match one of these filter elements will not be used for differencing."
@@ -93,6 +162,30 @@ void Usage(const char* progName)
       " be considered a match. The config file filter can have zero or more attributes.  I"
       " 'case' is set true the match is done case sensitive.";
    marginOutput(cout, text);
+   std::cout
+      << "\n"
+      << "Batch manifest\n"
+      << "==============\n";
+   text = "Each line of the manifest has the two files to compare separated by spaces, or by a tab"
+      " if the file names have spaces in them. Blank lines and lines starting with '#' are skipped."
+      " The config file and command-line settings apply to every pair. With --total, one line per"
+      " pair is appended to the total file, the same as comparing the pairs one per run.";
+   marginOutput(cout, text);
+   std::cout
+      << "\n"
+      << "Record formats\n"
+      << "==============\n";
+   text = "With --format jsonl or binary each difference is a record with its kind (tag, attributeName,"
+      " attributeValue, content, or with --align deleted or inserted), the id of its path, the two values, the difference of the values if"
+      " both are numbers, and the byte offset of each value in its file (not with --stream). The text of"
+      " a path is written once, in a path record before the first difference with that path. A files"
+      " record starts each pair of files, and the path ids start again from 0. A summary record has the"
+      " totals, after a stopped record if --quick, --max-diffs or --timeout stopped the comparison;"
+      " errors are error records. A binary record is a 4 byte little endian length, a type byte"
+      " (H header, F files, P path, D difference, T stopped, S summary, B batch, E error) and the fields; strings"
+      " are a 4 byte length and the bytes, offsets are 8 bytes (-1 if not known) and the difference is"
+      " an 8 byte double (NaN if the values are not numbers).";
+   marginOutput(cout, text);
 
    exit(0);
 }
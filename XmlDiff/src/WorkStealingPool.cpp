@@ -0,0 +1,115 @@
+/**
+ *
+ * @file WorkStealingPool.cpp
+ * @brief This file contains the member function definitions for class WorkStealingPool
+ */
+
+#include <thread>
+
+#include "WorkStealingPool.h"
+
+
+
+
+// ==========================================================================
+WorkStealingPool::WorkStealingPool(unsigned int aThreads)
+   : mQueues()
+   , mPending()
+{
+   if (aThreads == 0)
+      aThreads = 1;
+   for (unsigned int i = 0; i < aThreads; ++i)
+      mQueues.push_back(new Queue);
+}
+
+
+
+
+// ==========================================================================
+WorkStealingPool::~WorkStealingPool()
+{
+   for (size_t i = 0; i < mQueues.size(); ++i)
+      delete mQueues[i];
+   mQueues.clear();
+}
+
+
+
+
+// ==========================================================================
+void WorkStealingPool::run()
+{
+   const size_t nThreads = mQueues.size();
+   const size_t nTasks = mPending.size();
+
+   // hand out the tasks in contiguous blocks so neighbouring tasks run on the same thread
+   for (size_t i = 0; i < nTasks; ++i)
+   {
+      mQueues[i * nThreads / nTasks]->tasks.push_back(mPending[i]);
+   }
+   mPending.clear();
+
+   std::vector<std::thread> threads;
+   for (unsigned int id = 1; id < nThreads; ++id)
+   {
+      threads.push_back(std::thread(&WorkStealingPool::work, this, id));
+   }
+   work(0);
+
+   for (size_t i = 0; i < threads.size(); ++i)
+   {
+      threads[i].join();
+   }
+}
+
+
+
+
+// ==========================================================================
+void WorkStealingPool::work(unsigned int id)
+{
+   Task task;
+   while (takeOwn(id, task) || steal(id, task))
+   {
+      task();
+   }
+}
+
+
+
+
+// ==========================================================================
+bool WorkStealingPool::takeOwn(unsigned int id, Task& task)
+{
+   Queue& q = *mQueues[id];
+   std::lock_guard<std::mutex> guard(q.lock);
+   if (q.tasks.empty())
+      return false;
+
+   task = q.tasks.front();
+   q.tasks.pop_front();
+   return true;
+}
+
+
+
+
+// ==========================================================================
+bool WorkStealingPool::steal(unsigned int id, Task& task)
+{
+   // all tasks are queued before the threads start, so once every queue has
+   // been seen empty there is nothing left to do
+   const size_t nThreads = mQueues.size();
+   for (size_t i = 1; i < nThreads; ++i)
+   {
+      Queue& q = *mQueues[(id + i) % nThreads];
+      std::lock_guard<std::mutex> guard(q.lock);
+      if (!q.tasks.empty())
+      {
+         task = q.tasks.back();
+         q.tasks.pop_back();
+         return true;
+      }
+   }
+   return false;
+}
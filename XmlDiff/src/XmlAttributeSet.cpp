@@ -0,0 +1,227 @@
+/**
+ *
+ * @file XmlAttributeSet.cpp
+ * @brief This file contains the member function definitions for class XmlAttributeSet
+ */
+
+#include <cstring>
+
+#include "XmlAttributeSet.h"
+#include "MU_Hash.h"
+#include "MU_StringUtil.h"
+
+using namespace std;
+
+
+namespace
+{
+   // seeds tried for each size of the table before it is made bigger
+   const unsigned long long SeedsPerSize = 32;
+}
+
+
+
+
+// ==========================================================================
+XmlAttributeSet::XmlAttributeSet()
+   : mNames()
+   , mAll(false)
+   , mCaseSensitive(false)
+   , mSlots()
+   , mMask(0)
+   , mSeed(0)
+   , mLengths(0)
+{
+   set("name,type");
+}
+
+
+
+
+// ==========================================================================
+void XmlAttributeSet::set(const std::string& aList)
+{
+   vector<string> names;
+   MU_StringUtil::Tokenize(aList, names, ", \t\r\n");
+
+   mAll = (names.size() == 1 && (MU_StringUtil::Strcasecmp(names[0], "all") || names[0] == "*"));
+   mNames.clear();
+   if (!mAll)
+   {
+      for (size_t i = 0; i < names.size(); ++i)
+      {
+         size_t j = 0;
+         while (j < mNames.size() && mNames[j] != names[i])
+            ++j;
+         if (j == mNames.size())
+            mNames.push_back(names[i]);
+      }
+   }
+   build();
+}
+
+
+
+
+// ==========================================================================
+void XmlAttributeSet::caseSensitive(bool aFlag)
+{
+   if (aFlag != mCaseSensitive)
+   {
+      mCaseSensitive = aFlag;
+      build();
+   }
+}
+
+
+
+
+// ==========================================================================
+bool XmlAttributeSet::contains(const char* aName) const
+{
+   if (mAll)
+      return true;
+   if (mSlots.empty())
+      return false;
+
+   size_t length = 0;
+   const unsigned long long hash = hashName(aName, length);
+   if ((mLengths & lengthBit(length)) == 0)
+      return false;
+
+   const string& slot = mSlots[slotOf(hash, mSeed, mMask)];
+   if (slot.size() != length)
+      return false;
+   if (mCaseSensitive)
+      return memcmp(slot.c_str(), aName, length) == 0;
+   for (size_t i = 0; i < length; ++i)
+   {
+      if (lower(aName[i]) != slot[i])
+         return false;
+   }
+   return true;
+}
+
+
+
+
+// ==========================================================================
+void XmlAttributeSet::show(std::ostream& stream) const
+{
+   stream << "Attributes compared: ";
+   if (mAll)
+   {
+      stream << "all";
+   }
+   else
+   {
+      for (size_t i = 0; i < mNames.size(); ++i)
+         stream << (i ? ", " : "") << mNames[i];
+      if (mNames.empty())
+         stream << "none";
+   }
+   stream << std::endl;
+}
+
+
+
+
+// ==========================================================================
+unsigned long long XmlAttributeSet::hashName(const char* aName, size_t& length) const
+{
+   unsigned long long hash = MU_Hash::Start;
+   const char* p = aName;
+   if (mCaseSensitive)
+   {
+      for (; *p; ++p)
+         hash = MU_Hash::AddByte(hash, static_cast<unsigned char>(*p));
+   }
+   else
+   {
+      for (; *p; ++p)
+         hash = MU_Hash::AddByte(hash, static_cast<unsigned char>(lower(*p)));
+   }
+   length = static_cast<size_t>(p - aName);
+   return hash;
+}
+
+
+
+
+// ==========================================================================
+size_t XmlAttributeSet::slotOf(unsigned long long hash, unsigned long long seed, size_t mask) const
+{
+   return static_cast<size_t>(MU_Hash::Mix(hash ^ seed)) & mask;
+}
+
+
+
+
+// ==========================================================================
+void XmlAttributeSet::build()
+{
+   mSlots.clear();
+   mMask = 0;
+   mSeed = 0;
+   mLengths = 0;
+
+   // the names as they are compared; without case "Name" and "name" are one name
+   vector<string> keys;
+   for (size_t i = 0; i < mNames.size(); ++i)
+   {
+      string key = mNames[i];
+      if (!mCaseSensitive)
+      {
+         for (size_t c = 0; c < key.size(); ++c)
+            key[c] = lower(key[c]);
+      }
+      if (key.empty())
+         continue;
+      size_t k = 0;
+      while (k < keys.size() && keys[k] != key)
+         ++k;
+      if (k == keys.size())
+         keys.push_back(key);
+   }
+   if (mAll || keys.empty())
+      return;
+
+   vector<unsigned long long> hashes(keys.size());
+   for (size_t k = 0; k < keys.size(); ++k)
+   {
+      size_t length = 0;
+      hashes[k] = hashName(keys[k].c_str(), length);
+      mLengths |= lengthBit(length);
+   }
+
+   // try seeds until every name has a slot of its own, making the table bigger
+   // if none of them works.  A table of n*n slots works for most seeds
+   vector<char> used;
+   for (size_t nSlots = 4; ; nSlots *= 2)
+   {
+      if (nSlots < 2 * keys.size())
+         continue;
+      used.assign(nSlots, 0);
+      for (unsigned long long seed = 0; seed < SeedsPerSize; ++seed)
+      {
+         size_t k = 0;
+         for (; k < keys.size(); ++k)
+         {
+            char& slot = used[slotOf(hashes[k], seed, nSlots - 1)];
+            if (slot)
+               break;
+            slot = 1;
+         }
+         if (k == keys.size())
+         {
+            mSlots.assign(nSlots, string());
+            mMask = nSlots - 1;
+            mSeed = seed;
+            for (k = 0; k < keys.size(); ++k)
+               mSlots[slotOf(hashes[k], seed, mMask)] = keys[k];
+            return;
+         }
+         used.assign(nSlots, 0);
+      }
+   }
+}
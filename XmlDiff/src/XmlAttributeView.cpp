@@ -0,0 +1,125 @@
+/**
+ *
+ * @file XmlAttributeView.cpp
+ * @brief This file contains the member function definitions for class XmlAttributeView
+ */
+
+#include <ctype.h>
+
+#include "XmlAttributeView.h"
+
+using namespace tinyxml2;
+
+
+namespace
+{
+   inline int LowerChar(const char* p)
+   {
+      return tolower(static_cast<unsigned char>(*p));
+   }
+}
+
+
+
+
+// ==========================================================================
+XmlAttributeView::XmlAttributeView(const XMLElement* elem)
+   : mMore()
+   , mData(mInline)
+   , mSize(0)
+{
+   for (const XMLAttribute* attrib = elem ? elem->FirstAttribute() : 0; attrib; attrib = attrib->Next())
+   {
+      const char* name = attrib->Name();
+
+      // a later attribute with the same name (without case) replaces the value of the earlier one
+      size_t i = 0;
+      while (i < mSize && !equalNoCase(mData[i].name, name))
+         ++i;
+      if (i < mSize)
+      {
+         mData[i].value = attrib->Value();
+         continue;
+      }
+
+      Attribute a = { name, attrib->Value() };
+      if (mSize < MaxInline)
+      {
+         mInline[mSize] = a;
+      }
+      else
+      {
+         // too many to keep inline: move them all to mMore
+         if (mSize == MaxInline)
+            mMore.assign(mInline, mInline + MaxInline);
+         mMore.push_back(a);
+         mData = &mMore[0];
+      }
+      ++mSize;
+   }
+}
+
+
+
+
+// ==========================================================================
+const char* XmlAttributeView::find(const char* name) const
+{
+   for (size_t i = 0; i < mSize; ++i)
+   {
+      if (equalNoCase(mData[i].name, name))
+         return mData[i].value;
+   }
+   return 0;
+}
+
+
+
+
+// ==========================================================================
+void XmlAttributeView::sortByName()
+{
+   // insertion sort, elements rarely have more than a few attributes
+   for (size_t i = 1; i < mSize; ++i)
+   {
+      Attribute a = mData[i];
+      size_t j = i;
+      for (; j > 0 && compareNoCase(mData[j - 1].name, a.name) > 0; --j)
+         mData[j] = mData[j - 1];
+      mData[j] = a;
+   }
+}
+
+
+
+
+// ==========================================================================
+// static
+bool XmlAttributeView::equalNoCase(const char* a, const char* b)
+{
+   return compareNoCase(a, b) == 0;
+}
+
+
+
+
+// ==========================================================================
+// static
+bool XmlAttributeView::equalLowered(const char* name, const char* lowerName)
+{
+   for (; *name && LowerChar(name) == static_cast<unsigned char>(*lowerName); ++name, ++lowerName)
+      ;
+   return *name == 0 && *lowerName == 0;
+}
+
+
+
+
+// ==========================================================================
+// static
+int XmlAttributeView::compareNoCase(const char* a, const char* b)
+{
+   for (; *a && LowerChar(a) == LowerChar(b); ++a, ++b)
+      ;
+   return LowerChar(a) - LowerChar(b);
+}
@@ -0,0 +1,174 @@
+/**
+ *
+ * @file XmlBatch.cpp
+ * @brief This file contains the member function definitions for class XmlBatch
+ */
+
+#include <fstream>
+#include <list>
+
+#include "XmlBatch.h"
+#include "MU_StringUtil.h"
+#include "WorkStealingPool.h"
+
+using namespace tinyxml2;
+using namespace std;
+
+
+// ==========================================================================
+XmlBatch::XmlBatch(const RunSettings& aRunSettings, const PairCompare& aCompare, MU_RunStats* aStats)
+   : mRunSettings(aRunSettings)
+   , mCompare(aCompare)
+   , mStats(aStats)
+{
+}
+
+
+
+
+// ==========================================================================
+int XmlBatch::run(std::ostream& out, const DiffRecordWriter* records, const DiffBudget::Clock::time_point* deadline)
+{
+   vector<pair<string, string> > files;
+   unsigned int nBadLines = 0;
+   if (readManifest(files, nBadLines, out, records))
+   {
+      DiffRecordWriter::writeError(out, records, "Error: unable to open batch file '" + mRunSettings.getBatchFile() + "'");
+      return 1;
+   }
+
+   // the line for each pair is appended the same as when the pairs are compared one per run
+   const string totFile = mRunSettings.totalFile();
+   ofstream totalOut;
+   if (!totFile.empty())
+   {
+      totalOut.open(totFile.c_str(), ios_base::app);
+      if (!totalOut)
+         DiffRecordWriter::writeError(out, records, "Error: unable to open total file '" + totFile + "'");
+   }
+
+   // the pairs are compared a chunk at a time so the output waiting to be written stays small
+   const unsigned int jobs = mRunSettings.getJobs();
+   const size_t chunkSize = 16 * jobs;
+   WorkStealingPool pool(jobs);
+   XmlDocumentPool docs;
+   XmlDifferences batchDiff;
+   unsigned int nWithDiff = 0;
+   unsigned int nError = 0;
+   unsigned int nTimedOut = 0;
+
+   for (size_t first = 0; first < files.size(); first += chunkSize)
+   {
+      list<FilePair> chunk;
+      for (size_t i = first; i < files.size() && i < first + chunkSize; ++i)
+      {
+         chunk.emplace_back(records ? records->format() : DiffRecordWriter::Text);
+         FilePair& filePair = chunk.back();
+         filePair.filename1 = files[i].first;
+         filePair.filename2 = files[i].second;
+         pool.add(std::bind(&XmlBatch::comparePair, this, &filePair, &docs, deadline));
+      }
+      pool.run();
+
+      for (list<FilePair>::const_iterator p_it = chunk.begin(); p_it != chunk.end(); ++p_it)
+      {
+         out << p_it->out.str();
+         if (!records)
+            out << endl;
+         if (p_it->error)
+         {
+            ++nError;
+            continue;
+         }
+         batchDiff.addFile(p_it->totDiff);
+         if (p_it->totDiff.Total() > 0)
+            ++nWithDiff;
+         if (p_it->stopped == DiffBudget::Timeout)
+            ++nTimedOut;
+         if (totalOut)
+            totalOut << p_it->filename1 << "," << p_it->filename2 << "," << p_it->totDiff.Total() << endl;
+      }
+   }
+
+   if (records)
+   {
+      records->batch(out, static_cast<unsigned int>(files.size()), nWithDiff, nError);
+   }
+   else
+   {
+      out << "Batch totals for " << files.size() << " file pairs: " << nWithDiff << " with differences, "
+         << nError << " not compared" << endl;
+   }
+   batchDiff.write(out, records);
+   if (mStats)
+      docs.addMemPoolStats(*mStats);
+
+   if (nError > 0 || nBadLines > 0)
+      return 1;
+   return (mRunSettings.getQuick() ? DiffBudget::quickStatus(nWithDiff > 0, nTimedOut > 0) : 0);
+}
+
+
+
+
+// ==========================================================================
+bool XmlBatch::readManifest(std::vector<std::pair<std::string, std::string> >& files, unsigned int& nBadLines,
+   std::ostream& out, const DiffRecordWriter* records) const
+{
+   const string& filename = mRunSettings.getBatchFile();
+   ifstream in(filename.c_str());
+   if (!in)
+      return true;
+
+   string line;
+   unsigned int lineNumber = 0;
+   while (getline(in, line))
+   {
+      ++lineNumber;
+      MU_StringUtil::TrimWhiteSpace(line);
+      if (line.empty() || line[0] == '#')
+         continue;
+
+      vector<string> names;
+      MU_StringUtil::Tokenize(line, names, (line.find('\t') != string::npos ? "\t" : " \r"));
+      for (size_t i = 0; i < names.size(); ++i)
+         MU_StringUtil::TrimWhiteSpace(names[i]);
+      if (names.size() != 2 || names[0].empty() || names[1].empty())
+      {
+         ostringstream message;
+         message << "Error: line " << lineNumber << " of batch file '" << filename << "' does not have two file names";
+         DiffRecordWriter::writeError(out, records, message.str());
+         ++nBadLines;
+         continue;
+      }
+      files.push_back(make_pair(names[0], names[1]));
+   }
+   return false;
+}
+
+
+
+
+// ==========================================================================
+void XmlBatch::comparePair(FilePair* filePair, XmlDocumentPool* docs, const DiffBudget::Clock::time_point* deadline) const
+{
+   XMLDocument* doc1 = docs->take();
+   XMLDocument* doc2 = docs->take();
+   DiffBudget budget(mRunSettings.diffLimit(), deadline);
+
+   // records start with a files record instead
+   DiffRecordWriter* records = (filePair->records.format() == DiffRecordWriter::Text ? nullptr : &filePair->records);
+   if (!records)
+      filePair->out << "Comparing '" << filePair->filename1 << "' and '" << filePair->filename2 << "'" << endl;
+   filePair->error = mCompare(filePair->filename1, filePair->filename2, *doc1, *doc2, filePair->totDiff, filePair->out,
+      records, &budget);
+   filePair->stopped = budget.reason();
+   if (!filePair->error)
+   {
+      budget.writeStopped(filePair->out, records);
+      filePair->totDiff.write(filePair->out, records);
+   }
+
+   docs->give(doc1);
+   docs->give(doc2);
+}
@@ -1,19 +1,50 @@
+#include <cctype>
+#include <cstdio>
+#include <cstring>
 
 #include <fstream>
+#include <functional>
+#include <limits>
 #include <iostream>
 #include <list>
-#include <map>
+#include <mutex>
 #include <ostream>
 #include <algorithm>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "tinyxml2.h"
+#include "MU_Hash.h"
+#include "MU_RunStats.h"
 #include "MU_StringUtil.h"
-
+#include "MU_StringView.h"
+#include "MU_Tolerance.h"
+
+#include "DiffBudget.h"
+#include "DiffRecordWriter.h"
+#include "DiffWork.h"
+#include "DiffWorkCursor.h"
+#include "FingerprintCache.h"
 #include "MyGetOpt.h"
+#include "OutputSink.h"
+#include "PairAtoms.h"
 #include "ProgramVersion.h"
+#include "SiblingAligner.h"
+#include "SideBySideWriter.h"
+#include "SidecarFile.h"
 #include "Usage.h"
+#include "WorkStealingPool.h"
+#include "XmlAttributeSet.h"
+#include "XmlAttributeView.h"
+#include "XmlBatch.h"
+#include "XmlDifferences.h"
+#include "XmlDocumentPool.h"
 #include "XmlFilter.h"
+#include "XmlFilterSet.h"
+#include "XmlFingerprint.h"
+#include "XmlPathStack.h"
+#include "XmlPullParser.h"
 
 using namespace tinyxml2;
 using namespace std;
@@ -37,73 +68,144 @@ using namespace std;
 
 
 
-// use delta when comparing two numbers to determine if they are equal.  if (a-b)<gNumberDelta then same
-// this value can be changed by command-line switch or config file
-static double gNumberDelta = 1.0e-07;
+// tolerance used when comparing two numbers to determine if they are equal.  if |a-b|<=delta then same
+// (or within the relative or ULP tolerance, if set).  the delta can be changed by command-line switch
+// or config file, the others by the config file
+static MU_Tolerance gTolerance(1.0e-07);
 // determines if strings are matched with case sensitivity or not
 // this value can be changed by command-line switch or config file
 static bool gCaseSensitive = false;
 // delimiter characters used to break text into tokens (attribute value and xml element content)
 static string gDelimiters = " ";
+// pairs of elements shown before and after each difference with --side, -1 to show every pair.
+// this value can be changed by command-line switch
+static int gSideContext = -1;
+// where the time and memory go (--stats), null when not asked for.  set in main
+static MU_RunStats* gRunStats = nullptr;
 
 //! config file sets filters for XML elements to ignore, based on tag name and attributes
-static list<XmlFilter> gXmlFilters;
-
-//! keep track of XML tree as we work down and across. it will contain the element tag name
-//! unless the element has 'name="value"' as an attribute.  If so, the "value" will be used.
-static list<string> gModelTree;
+static XmlFilterSet gXmlFilters;
+//! the attributes that are compared, all others are ignored.  set by command-line switch or config file
+static XmlAttributeSet gDesiredAttributes;
 
 
 
 /**
- * @class XmlDifferences
- * @brief contains count on the number of differences between the two files
+ * @class DiffContext
+ * @brief the state of one walk through the two XML trees
+ *
+ * Holds where in the tree the comparison is and where the differences get
+ * written.  Each thread comparing part of the trees has its own context.
+ * The state only some modes use is kept in the small structs below.
  */
-class XmlDifferences
+class DiffContext
 {
 public:
-   XmlDifferences() :
-      totalElemCompared(0),
-      totalDifferentTypeElem(0), extraElemFile1(0), extraElemFile2(0), elemWithAttribNameDiff(0), elemWithAttribValueDiff(0),
-      elemWithTextDiff(0), totalTagNumbContentDiff(0), totalTagTextContentDiff(0)
+   //! the differences written as records (--format)
+   struct RecordOutput
+   {
+      RecordOutput(DiffRecordWriter* aWriter)
+         : writer(aWriter)
+         , piece(nullptr)
+         , pathChanges(0)
+         , pathId(0)
+         , pathKnown(false)
+      {}
+
+      //! write the differences as records in this format, null for the text lines
+      DiffRecordWriter* writer;
+      //! the piece the records are kept in until it is written, null to write them now (a --jobs piece)
+      DiffWork* piece;
+      //! path id of the model tree when it had pathChanges changes (if pathKnown), an id within the piece if there is one
+      unsigned long long pathChanges;
+      unsigned int pathId;
+      bool pathKnown;
+   };
+
+   //! the child elements paired by key instead of by position (--align)
+   struct Alignment
+   {
+      Alignment(bool aEnabled)
+         : enabled(aEnabled)
+         , aligner(gCaseSensitive)
+         , pairs()
+      {}
+
+      bool enabled;
+      SiblingAligner aligner;
+      //! the pairs of siblings of each level of the model tree
+      vector<vector<SiblingAligner::Pair> > pairs;
+   };
+
+   //! pairs of number tokens waiting to be compared as a batch (kept to reuse the memory)
+   struct NumberBatch
+   {
+      NumberBatch()
+         : values1()
+         , values2()
+         , tokens1()
+         , tokens2()
+         , differIndex()
+      {}
+
+      //! empty the batch, keeping the memory
+      void clear()
+      {
+         values1.clear();
+         values2.clear();
+         tokens1.clear();
+         tokens2.clear();
+      }
+
+      vector<double> values1;
+      vector<double> values2;
+      vector<MU_StringView> tokens1;
+      vector<MU_StringView> tokens2;
+      vector<size_t> differIndex;
+   };
+
+   DiffContext(ostream& aOut, DiffRecordWriter* aRecords = nullptr, bool aAlign = false)
+      : modelTree()
+      , out(&aOut)
+      , doc1(nullptr)
+      , doc2(nullptr)
+      , budget(nullptr)
+      , budgetCalls(0)
+      , records(aRecords)
+      , align(aAlign)
+      , side(gSideContext)
+      , numbers()
    {}
-   ~XmlDifferences() {}
 
-   unsigned int Total() const                // return total number of differences
+   //! keep the differences in aPiece from now on (a --jobs piece)
+   void writeTo(DiffWork& aPiece)
    {
-      return totalDifferentTypeElem + extraElemFile1 + extraElemFile2 + elemWithAttribNameDiff + elemWithAttribValueDiff + elemWithTextDiff;
+      out = &aPiece.out;
+      records.piece = &aPiece;
+      records.pathKnown = false;
    }
 
-   unsigned int totalElemCompared;           // total number of elements compared
-   unsigned int totalDifferentTypeElem;      // encountered tags of different type (e.g. <var> vs <group>)
-   unsigned int extraElemFile1;              // number of extra elements in file 1 after file 2 hits eof
-   unsigned int extraElemFile2;              // number of extra elements in file 2 after file 1 hits eof
-   unsigned int elemWithAttribNameDiff;      // number of tags with one or more attribute name differences
-   unsigned int elemWithAttribValueDiff;     // number of tags with one or more attribute value differences
-   unsigned int elemWithTextDiff;            // number of tags with inner text differs
-   unsigned int totalTagNumbContentDiff;     // number of number token differences inside a tag
-   unsigned int totalTagTextContentDiff;     // number of text token differences inside a tag
-
-private:
-   friend std::ostream& operator<<(std::ostream &os, const XmlDifferences& p);
+   //! true if the comparison should stop (--quick, --max-diffs or --timeout)
+   bool stopping() { return budget && budget->stopped(budgetCalls); }
+
+   //! keep track of XML tree as we work down and across. it will contain the element tag name
+   //! unless the element has 'name="value"' as an attribute.  If so, the "value" will be used.
+   XmlPathStack modelTree;
+   //! differences are written here
+   ostream* out;
+   //! the documents being compared, to find where a value is in its file (null when streaming)
+   const XMLDocument* doc1;
+   const XMLDocument* doc2;
+   //! limits on the differences written and the time taken, null for none
+   DiffBudget* budget;
+   unsigned int budgetCalls;
+
+   RecordOutput records;
+   Alignment align;
+   //! the pairs of elements shown side by side (--side)
+   SideBySideWriter side;
+   NumberBatch numbers;
 };
-std::ostream& operator<<(std::ostream &os, const XmlDifferences& p)
-{
-   os << "Total number of elements compared:        " << p.totalElemCompared << endl;
-   if (p.extraElemFile1)
-      os << "Extra elements in file 1: " << p.extraElemFile1 << endl;
-   if (p.extraElemFile2)
-      os << "Extra elements in file 2: " << p.extraElemFile2 << endl;
-   os << "Number of tags with name differences:     " << p.totalDifferentTypeElem << endl;
-   os << "# of tags with an attribute name diff:    " << p.elemWithAttribNameDiff << endl;
-   os << "# of tags with an attribute value diff:   " << p.elemWithAttribValueDiff << endl;
-   os << "Total # of tags with content differences: " << p.elemWithTextDiff << endl;
-   os << "Total # of content diffs [as numbers]:    " << p.totalTagNumbContentDiff << endl;
-   os << "Total # of content diffs [as text]:       " << p.totalTagTextContentDiff << endl;
-   os << "Total differences:                        " << p.Total() << endl;
-   return os;
-}
-
 
 
 
@@ -125,22 +227,43 @@ inline bool matchString(const string& a, const string& b)
 
 
 
+//! function determines if the two strings match.  will use flags to see if case sensitivity is used
+inline bool matchString(const MU_StringView& a, const MU_StringView& b)
+{
+   return (gCaseSensitive ? a.equals(b) : a.equalsNoCase(b));
+}
+
+
+
+
+//! function determines if two element or attribute names match.  Names interned in the atom table
+//! of the pair (see compareXmlPair) are matched by their atoms, others by their characters
+inline bool matchName(const char* a, const XMLAtom& atomA, const char* b, const XMLAtom& atomB)
+{
+   if (atomA.id && atomB.id)
+      return (gCaseSensitive ? atomA.id == atomB.id : atomA.folded == atomB.folded);
+   return matchString(a, b);
+}
+
+
+
+
 /**
  * Push a new element name onto the model tree.  This is done right before
  * processing the child elements.
  * The tag name will be pushed unless attribute 'name="value"' exists
  * in which case "value" will be pushed.
  */
-void pushToModelTree(const string& tagName,map<string,string>& attribs)
+void pushToModelTree(DiffContext& ctx, const char* tagName, const XmlAttributeView& attribs)
 {
-   map<string, string>::const_iterator a_it = attribs.find("name");
-   if (a_it == attribs.end())
+   const char* name = attribs.find("name");
+   if (!name)
    {
-      gModelTree.push_back(tagName);   // no attribute "name" so use element tag
+      ctx.modelTree.push(tagName);   // no attribute "name" so use element tag
    }
    else
    {
-      gModelTree.push_back(a_it->second);  // push back value of name="value"
+      ctx.modelTree.push(name);  // push back value of name="value"
    }
 }
 /**
@@ -148,225 +271,128 @@ void pushToModelTree(const string& tagName,map<string,string>& attribs)
  * and continuing on with the parent.
  * TODO: error checking if pop attempted when map is empty
  */
-void popFromModelTree()
+void popFromModelTree(DiffContext& ctx)
 {
-   gModelTree.pop_back();
+   ctx.modelTree.pop();
 }
 /**
  * Output the model tree in form of level1.level2.[level3...].
  * This is used when outputting XML elements that show differences.
  */
-void outputModelTree(std::ostream &os)
+void outputModelTree(const DiffContext& ctx, std::ostream &os)
 {
-   unsigned int counter = 0;
-#if (_MSC_VER < 1800)
-   for (list<string>::const_iterator g_it=gModelTree.begin(); g_it != gModelTree.end(); ++g_it)
-   {
-      const string& s = *g_it;
-#else
-   for (const string s : gModelTree)
-   {
-#endif
-      os << (counter++ == 0 ? "" : ".") << s;
-      //os << s << ".";
-   }
+   // the text of the levels above is kept from the last time, only new levels are added
+   os << ctx.modelTree.text();
 }
 
 
 
 
 /**
- * Get a list of XML attributes from an XML element.
+ * Find out if an XML element matches any of the filters in gXmlFilters.
  *
- * @param elem the XML element to extract attributes from
- * @param attribs returns map with all attribute names and values in 'elem'
+ * @param tagName the tag for the element
+ * @param attribs the attributes of the XML element
+ * @return true if tagname and attributes match one of the filters
  */
-void getXmlAttributesFromElem(const XMLElement* elem, map<string,string>& attribs)
+bool checkXmlFilter(const char* tagName, const XmlAttributeView& attribs)
 {
-   attribs.clear();
-   const XMLAttribute* attrib = elem->FirstAttribute();
-   while (attrib)
-   {
-      // save off attribute name as all lower case to make comparison easier
-      string attribName = attrib->Name();
-      MU_StringUtil::ToLower(attribName);
-      attribs[attribName] = attrib->Value();
-
-      attrib = attrib->Next();
-   }
+   return gXmlFilters.match(tagName, attribs);
 }
 
 
 
 
-string elementToString(const XMLElement* elem1)
+void showXmlFilters(ostream& os)
 {
-   if (elem1)
-   {
-      string tag = elem1->Value();
-      string retStr = "<" + tag;
-
-      map<string, string> attribs;
-      getXmlAttributesFromElem(elem1, attribs);
-      for (map<string, string>::const_iterator a_it = attribs.begin(); a_it != attribs.end(); ++a_it)
-      {
-         retStr += " ";
-         retStr += a_it->first + "=\"" + a_it->second + "\"";
-      }
-
-      const char* text = elem1->GetText();
-      if (text)
-      {
-         retStr += ">";
-         retStr += text;
-         retStr += "</" + tag + ">";
-      }
-      else
-      {
-         retStr += "/>";
-      }
-
-      return retStr;
-   }
-
-   return "";
+   gXmlFilters.show(os);
 }
 
 
 
 
-void outputElementsSideBySide(const XMLElement* elem1, const XMLElement* elem2, size_t margin)
+/**
+* Set the case-sensitivity of the filters in gXmlFilters.
+*
+* @param aCaseSensitive true for case sensitive, false for case-INsensitive
+*/
+void setXmlFilterCase(bool aCaseSensitive)
 {
-   size_t len;
-   if (elem1 && elem2)
-   {
-      //XMLPrinter printer;
-      //elem1->Accept(&printer);
-      //string testStr = printer.CStr();
-
-      string elem1Str = elementToString(elem1);
-      string elem2Str = elementToString(elem2);
-      std::replace(elem1Str.begin(), elem1Str.end(), '\n', ' ');  // replace '\n' with printable char
-      std::replace(elem2Str.begin(), elem2Str.end(), '\n', ' ');
-      list<string> lines1 = MU_StringUtil::WrapTextHard(elem1Str, margin);
-      list<string> lines2 = MU_StringUtil::WrapTextHard(elem2Str, margin);
-      //cout << "lines1 size=" << lines1.size() << ", lines2 size=" << lines2.size() << endl;
-
-      list<string>::const_iterator l1 = lines1.begin();
-      list<string>::const_iterator l2 = lines2.begin();
-      while (l1 != lines1.end() || l2 != lines2.end())
-      {
-         cout << "|";
-         size_t underLen = margin;
-         if (l1 != lines1.end())
-         {
-            cout << *l1;
-            if ((len = (*l1).length()) <= margin)
-               underLen = margin - len;
-            else
-               underLen = 0;
-
-            ++l1;
-         }
-
-         if (underLen > 0)
-         {
-            string spaces(underLen, ' ');
-            cout << spaces;
-         }
-         cout << "|";
-
-         underLen = margin;
-         if (l2 != lines2.end())
-         {
-            cout << *l2;
-            if ((len = (*l2).length()) <= margin)
-               underLen = margin - len;
-            else
-               underLen = 0;
-
-            ++l2;
-         }
-
-         if (underLen > 0)
-         {
-            string spaces(underLen, ' ');
-            cout << spaces;
-         }
-         cout << "|";
-
-         cout << endl;
-      }
-   }
+   gXmlFilters.caseSensitive(aCaseSensitive);
 }
 
 
 
 
 /**
- * Find out if an XML element matches any of the filters in gXmlFilters.
+ * @class DiffTitle
+ * @brief the kind and title of a difference, put together only when the difference is output
  *
- * @param tagName the tag for the element
- * @param attribs a set of name/value pairs from the XML element
- * @return true if tagname and attributes match one of the filters
+ * A title is a plain string such as "content difference", or a prefix, a name
+ * and a suffix such as "attribute '" name "'=".  Nothing is copied until write().
  */
-bool checkXmlFilter(const string& tagName, const map<string,string>& attribs)
+class DiffTitle
 {
-#if (_MSC_VER < 1800)
-   for (list<XmlFilter>::const_iterator g_it=gXmlFilters.begin(); g_it != gXmlFilters.end(); ++g_it)
-   {
-      const XmlFilter& f = *g_it;
-#else
-   for (const XmlFilter& f : gXmlFilters)
-   {
-#endif
-      if (f.match(tagName,attribs))
-      {
-         return true;
-      }
-   }
-   return false;
-}
-
-
+public:
+   DiffTitle(DiffRecordWriter::Kind aKind, const char* aText) : kind(aKind), prefix(aText), name(nullptr), suffix(nullptr) {}
+   DiffTitle(DiffRecordWriter::Kind aKind, const char* aPrefix, const char* aName, const char* aSuffix)
+      : kind(aKind), prefix(aPrefix), name(aName), suffix(aSuffix) {}
 
+   //! what differs
+   DiffRecordWriter::Kind getKind() const { return kind; }
+   //! the name in the title (the attribute name), or null
+   const char* getName() const { return name; }
 
-void showXmlFilters(ostream& os)
-{
-#if (_MSC_VER < 1800)
-   for (list<XmlFilter>::const_iterator g_it=gXmlFilters.begin(); g_it != gXmlFilters.end(); ++g_it)
-   {
-      const XmlFilter& f = *g_it;
-#else
-   for (const XmlFilter& f : gXmlFilters)
+   //! write the title to the stream
+   void write(ostream& os) const
    {
-#endif
-      os << f;
+      os << prefix;
+      if (name)
+         os << name << suffix;
    }
-}
 
+private:
+   DiffRecordWriter::Kind kind;
+   const char* prefix;
+   const char* name;
+   const char* suffix;
+};
 
 
 
 /**
-* Set the case-sensitivity of the filters in gXmlFilters.
-*
-* @param aCaseSensitive true for case sensitive, false for case-INsensitive
-*/
-void setXmlFilterCase(bool aCaseSensitive)
+ * Output a difference as a record (--format).  The path record is written
+ * first if this is the first difference with this path.  In a --jobs piece the
+ * record is kept in the piece, with the path, until the pieces are written in order.
+ */
+void outputRecord(DiffContext& ctx, const DiffTitle& title, const MU_StringView& d1, const MU_StringView& d2, double delta)
 {
-#if (_MSC_VER < 1800)
-   for (list<XmlFilter>::iterator g_it=gXmlFilters.begin(); g_it != gXmlFilters.end(); ++g_it)
-   {
-      XmlFilter& f = *g_it;
-#else
-   for (XmlFilter& f : gXmlFilters)
+   DiffRecordWriter& records = *ctx.records.writer;
+   if (!ctx.records.pathKnown || ctx.records.pathChanges != ctx.modelTree.changes())
    {
-#endif
-      f.caseSensitive(aCaseSensitive);
+      if (ctx.records.piece)
+      {
+         ctx.records.pathId = ctx.records.piece->addPath(ctx.modelTree.text());
+      }
+      else
+      {
+         bool isNew;
+         ctx.records.pathId = records.pathId(ctx.modelTree.text(), isNew);
+         if (isNew && records.markWritten(ctx.records.pathId))
+            records.path(*ctx.out, ctx.records.pathId);
+      }
+      ctx.records.pathChanges = ctx.modelTree.changes();
+      ctx.records.pathKnown = true;
    }
-}
 
+   const long long offset1 = (ctx.doc1 ? ctx.doc1->TextOffset(d1.data()) : -1);
+   const long long offset2 = (ctx.doc2 ? ctx.doc2->TextOffset(d2.data()) : -1);
+   const char* attribute = (title.getKind() == DiffRecordWriter::AttributeValue ? title.getName() : nullptr);
+   if (ctx.records.piece)
+      ctx.records.piece->addRecord(title.getKind(), ctx.records.pathId, attribute, d1, d2, delta, offset1, offset2);
+   else
+      records.diff(*ctx.out, title.getKind(), ctx.records.pathId, attribute, d1, d2, delta, offset1, offset2);
+}
 
 
 
@@ -374,26 +400,62 @@ void setXmlFilterCase(bool aCaseSensitive)
  * Output the difference between the two files.
  * Currently this is done by outputing the XML tree, a title, and the two different
  * strings.  These are separated by commas.
- * @param os the stream to write to
+ * @param ctx the comparison context, gives the model tree and the stream to write to
  * @param title a title such as "content difference" or "attibute name"
  * @param d1 the string from file 1 that differs from d2
  * @param d2 the string from file 2 that differs from d1
+ * @param delta d2 - d1 if both are numbers, else NaN (only used in the records)
+ * @return true if the difference was written, false if past --max-diffs.  Only the differences
+ *    written are counted, so the counts are those up to where the comparison stopped
  */
-void outputDiff(ostream& os, const string& title, const string& d1, const string& d2)
+bool outputDiff(DiffContext& ctx, const DiffTitle& title, const MU_StringView& d1, const MU_StringView& d2,
+   double delta = std::numeric_limits<double>::quiet_NaN())
 {
+   // past --max-diffs nothing more is written, the walk stops at the next element
+   if (ctx.budget && !ctx.budget->takeDiff())
+      return false;
+
+   if (ctx.records.writer)
+   {
+      outputRecord(ctx, title, d1, d2, delta);
+      return true;
+   }
+
+   // tag names are shown as <tag>, also the tag of an element only in one file
+   const bool isTag = (title.getKind() == DiffRecordWriter::TagName || title.getKind() == DiffRecordWriter::Deleted ||
+      title.getKind() == DiffRecordWriter::Inserted);
+   const char* open1 = (isTag && d1.size() > 0 ? "<" : "");
+   const char* close1 = (isTag && d1.size() > 0 ? ">" : "");
+   const char* open2 = (isTag && d2.size() > 0 ? "<" : "");
+   const char* close2 = (isTag && d2.size() > 0 ? ">" : "");
+
+   ostream& os = *ctx.out;
+   // with --side --context the pairs held back are shown now, ahead of the difference
+   ctx.side.difference(os);
    /*
    os << title << "\n"
       << "< " << d1 << "\n"
       << "---" << "\n"
       << "> " << d2 << endl;
       */
-   outputModelTree(os);
-   os << "," << title << "," << d1 << "," << d2 << endl;
+   outputModelTree(ctx, os);
+   os << ",";
+   title.write(os);
+   os << "," << open1;
+   os.write(d1.data(), d1.size());
+   os << close1 << "," << open2;
+   os.write(d2.data(), d2.size());
+   os << close2 << endl;
+   return true;
 }
-void outputDiffcptr(ostream& os, const string& title, const char* d1, const char* d2)
+bool outputDiffcptr(DiffContext& ctx, const DiffTitle& title, const char* d1, const char* d2)
 {
    // turn null pointers into "" 
-   outputDiff(os, title, (d1 ? d1 : ""), (d2 ? d2 : ""));
+   if (!d1)
+      d1 = "";
+   if (!d2)
+      d2 = "";
+   return outputDiff(ctx, title, MU_StringView(d1, strlen(d1)), MU_StringView(d2, strlen(d2)));
 }
 
 
@@ -420,97 +482,96 @@ unsigned int countElement(XMLElement* rootElement)
 
 
 
+/**
+ * Compare the batch of number pairs collected in ctx by countTextAsNumberTokenDiff(),
+ * output the ones that differ, and empty the batch.
+ *
+ * @return the number of pairs that differ and were written (see outputDiff)
+ */
+unsigned int compareNumberBatch(DiffContext& ctx, const DiffTitle& outDiffMsg)
+{
+   size_t n = ctx.numbers.values1.size();
+   if (n == 0)
+      return 0;
+
+   ctx.numbers.differIndex.resize(n);
+   size_t nDiff = gTolerance.compare(&ctx.numbers.values1[0], &ctx.numbers.values2[0], n, &ctx.numbers.differIndex[0]);
+   unsigned int nWritten = 0;
+   for (size_t k = 0; k < nDiff; ++k)
+   {
+      size_t i = ctx.numbers.differIndex[k];
+      if (outputDiff(ctx, outDiffMsg, ctx.numbers.tokens1[i], ctx.numbers.tokens2[i], ctx.numbers.values2[i] - ctx.numbers.values1[i]))
+         ++nWritten;
+   }
+
+   ctx.numbers.clear();
+   return nWritten;
+}
+
+
+
+
 /**
  * Count the number of text differences inside tag content.
  *
  * The text that is compared is that within tags as in <Tag>hello world</Tag>.  (text is "hello world").
  * The text is broken up into tokens based on the delimiters passed in.  Each token is compared
  * separately and will be compared as a number if possible.  Numbers are considered equal if they
- * are within some small tolerance of each other.
+ * are within some small tolerance of each other.  Runs of number pairs are collected and compared
+ * as a batch with gTolerance, and the differences are still output in token order.
  * The differences are counted by incrementing within parameter totDiff: totalTagNumbContentDiff and
- * totalTagTextContentDiff are incremented.
+ * totalTagTextContentDiff are incremented.  Only the differences written are counted (see outputDiff).
  *
+ * @param ctx the comparison context
  * @param text1 string 1 to use in comparison
  * @param text2 string 2 to use in comparison against string 1
  * @param totDiff the number of differences is incremented in this object
- * @param delim string containing the characters to use as delimiters in text1 and text2 to break them into tokens (e.g. "{,\n ")
+ * @param delim set of characters to use as delimiters in text1 and text2 to break them into tokens (e.g. "{,\n ")
  * @param outDiffMsg a message to put in the output if differences are found
  * @param nNumberDiff returns the number of content differences compared as numbers
  * @param nTextDiff returns the number of content differences compared as strings
- * @return true if there are differences
+ * @param totDiff the number of tokens and numbers compared is incremented in this object
+ * @return true if there are differences that were written
  */
-bool countTextAsNumberTokenDiff(const char* text1, const char* text2, const string& delim,
-   const string& outDiffMsg, unsigned int& nNumberDiff, unsigned int& nTextDiff)
+bool countTextAsNumberTokenDiff(DiffContext& ctx, const char* text1, const char* text2, const MU_CharSet& delim,
+   const DiffTitle& outDiffMsg, unsigned int& nNumberDiff, unsigned int& nTextDiff, XmlDifferences& totDiff)
 {
    //cout << "compare |" << text1 << "| with |" << text2 << "|" << endl;
 
-   unsigned int diffCount = 0;
    nNumberDiff = nTextDiff = 0;
 
-   vector<string> tokens1, tokens2;
-   MU_StringUtil::Tokenize(text1, tokens1, delim);
-   MU_StringUtil::Tokenize(text2, tokens2, delim);
-
-   // get number of tokens in each string of text (using delimters)
-   unsigned int n1 = tokens1.size();
-   unsigned int n2 = tokens2.size();
-   // if different number of delimiters it means there are abs(n1-n2) different tokens
-   if (n1 != n2)
-   {
-      diffCount += abs((int)(n1-n2));
-      //cout << "n1=" << n1 << " n2=" << n2 << "  increment diffCount by " << abs((int)(n1 - n2)) << endl;
-   }
-   unsigned int nmin = n1;   // nmin=min(n1,n2)
-   if (n2 < nmin)
-      nmin = n2;
+   // the tokens are views into text1 and text2, nothing is copied.  if one string has
+   // more tokens than the other the extra ones are not compared
+   MU_Tokenizer tokens1(text1, delim);
+   MU_Tokenizer tokens2(text2, delim);
+   MU_StringView s1, s2;
 
    double d1, d2;
-   bool isNumber;
 
    // loop through tokens comparing the two
-   for (unsigned int n = 0; n < nmin; ++n)
+   while (tokens1.next(s1) && tokens2.next(s2))
    {
-      string& s1 = tokens1[n];
-      string& s2 = tokens2[n];
-      bool isDiff = false;
-
-      // try to convert token into a number, if so we can compare it as a number
-      isNumber = false;
-      try
-      {
-         d1 = MU_StringUtil::ToDoubleEx(s1);
-         d2 = MU_StringUtil::ToDoubleEx(s2);
-         isNumber = true;
-      }
-      catch (std::runtime_error e)
-      {
-         d1 = 0.0;
-         d2 = 0.0;
-      }
+      ++totDiff.totalTokensCompared;
 
-      if (isNumber)
+      // try to convert token into a number, if so add it to the batch to compare as numbers
+      if (MU_StringUtil::TryToDouble(s1.begin(), s1.end(), d1) && MU_StringUtil::TryToDouble(s2.begin(), s2.end(), d2))
       {
-         if (abs(d1 - d2) > gNumberDelta)
-         {
-            ++nNumberDiff;
-            isDiff = true;
-         }
+         ++totDiff.totalNumbersCompared;
+         ctx.numbers.values1.push_back(d1);
+         ctx.numbers.values2.push_back(d2);
+         ctx.numbers.tokens1.push_back(s1);
+         ctx.numbers.tokens2.push_back(s2);
       }
       else
       {
-         if (!matchString(s1,s2))
-         {
-            ++nTextDiff;
-            isDiff = true;
-         }
-      }
+         // numbers before this token are output first to keep the order
+         nNumberDiff += compareNumberBatch(ctx, outDiffMsg);
 
-      if (isDiff)
-      {
-         //string msg = "content difference";
-         outputDiff(cout, outDiffMsg, s1, s2);
+         if (!matchString(s1,s2) && outputDiff(ctx, outDiffMsg, s1, s2))
+            ++nTextDiff;
       }
    }
+   nNumberDiff += compareNumberBatch(ctx, outDiffMsg);
 
    return (nTextDiff > 0 || nNumberDiff > 0) ? true : false;
 }
@@ -518,14 +579,10 @@ bool countTextAsNumberTokenDiff(const char* text1, const char* text2, const stri
 
 
 
-// focus on specific attributes and ignore others, based on the attribute name
+// focus on specific attributes and ignore others, based on the attribute name (see gDesiredAttributes)
 bool isDesiredAttribute(const char* name)
 {
-   return (
-         matchString(name, "name")
-      || matchString(name, "type")
-      //|| matchString(name, "units")
-      );
+   return gDesiredAttributes.contains(name);
 }
 
 // get the next attribute after this one but only if matches 'desired attribute name'
@@ -571,12 +628,13 @@ const XMLAttribute* getFirstDesiredAttribute(const XMLElement* elem)
  * The content will be broken into tokens using 'delim' and each of those will get compared as
  * text or as numbers if possible.
  *
+ * @param ctx the comparison context
  * @param elem1 XML element 1 to use in comparison
  * @param elem2 XML element 2 to use in comparison against element 1
  * @param totDiff the number of differences is incremented in this object
- * @param delim string containing the characters to use as delimiters in text1 and text2 to break them into tokens (e.g. "{,\n ")
+ * @param delim set of characters to use as delimiters in text1 and text2 to break them into tokens (e.g. "{,\n ")
  */
-void compareXmlText(XMLElement* elem1, XMLElement* elem2, XmlDifferences& totDiff, const string& delim)
+void compareXmlText(DiffContext& ctx, XMLElement* elem1, XMLElement* elem2, XmlDifferences& totDiff, const MU_CharSet& delim)
 {
    const char* subtext1 = elem1->GetText();
    const char* subtext2 = elem2->GetText();
@@ -584,7 +642,8 @@ void compareXmlText(XMLElement* elem1, XMLElement* elem2, XmlDifferences& totDif
    {
       unsigned int nNumberDiff;
       unsigned int nTextDiff;
-      if (countTextAsNumberTokenDiff(subtext1, subtext2, delim, "content difference", nNumberDiff, nTextDiff))
+      if (countTextAsNumberTokenDiff(ctx, subtext1, subtext2, delim,
+            DiffTitle(DiffRecordWriter::Content, "content difference"), nNumberDiff, nTextDiff, totDiff))
       {
          totDiff.totalTagNumbContentDiff += nNumberDiff;
          totDiff.totalTagTextContentDiff += nTextDiff;
@@ -595,8 +654,8 @@ void compareXmlText(XMLElement* elem1, XMLElement* elem2, XmlDifferences& totDif
    else if (subtext1 || subtext2)
    {
       // here it means one element has text but not both
-      outputDiffcptr(cout, "content difference", subtext1, subtext2);
-      ++totDiff.elemWithTextDiff;
+      if (outputDiffcptr(ctx, DiffTitle(DiffRecordWriter::Content, "content difference"), subtext1, subtext2))
+         ++totDiff.elemWithTextDiff;
    }
 }
 
@@ -608,12 +667,13 @@ void compareXmlText(XMLElement* elem1, XMLElement* elem2, XmlDifferences& totDif
 * The value of attributes will be broken into tokens using 'delim' and each of those will get compared as
 * text or as numbers if possible.
 *
+* @param ctx the comparison context
 * @param elem1 XML element 1 to use in comparison
 * @param elem2 XML element 2 to use in comparison against element 1
 * @param totDiff the number of differences is incremented in this object
-* @param delim string containing the characters to use as delimiters to break attribute value into tokens (e.g. "{,\n ")
+* @param delim set of characters to use as delimiters to break attribute value into tokens (e.g. "{,\n ")
 */
-void compareXmlAttribs(XMLElement* elem1, XMLElement* elem2, XmlDifferences& totDiff, const string& delim)
+void compareXmlAttribs(DiffContext& ctx, XMLElement* elem1, XMLElement* elem2, XmlDifferences& totDiff, const MU_CharSet& delim)
 {
    const XMLAttribute* attrib1 = getFirstDesiredAttribute(elem1);
    const XMLAttribute* attrib2 = getFirstDesiredAttribute(elem2);
@@ -622,24 +682,18 @@ void compareXmlAttribs(XMLElement* elem1, XMLElement* elem2, XmlDifferences& tot
    unsigned int nNumberDiff;
    unsigned int nTextDiff;
 
-   string msg = " in element <";
-   msg += elem1->Value();
-   msg += ">";
-
    while (attrib1 && attrib2)
    {
       const char* attribName1 = attrib1->Name();
-      if (!matchString(attribName1, attrib2->Name()))
+      if (!matchName(attribName1, attrib1->NameAtom(), attrib2->Name(), attrib2->NameAtom())
+         && outputDiffcptr(ctx, DiffTitle(DiffRecordWriter::AttributeName, "attribute name"), attribName1, attrib2->Name()))
       {
-         outputDiff(cout, "attribute name", attribName1, attrib2->Name());
          ++attributeNameCount;
       }
 
-      // compare attribute values
-      string out = "attribute '";
-      out += attribName1;
-      out += "'=";
-      if (countTextAsNumberTokenDiff(attrib1->Value(), attrib2->Value(), delim, out, nNumberDiff, nTextDiff))
+      // compare attribute values.  the title is only put together if a difference is output
+      if (countTextAsNumberTokenDiff(ctx, attrib1->Value(), attrib2->Value(), delim,
+            DiffTitle(DiffRecordWriter::AttributeValue, "attribute '", attribName1, "'="), nNumberDiff, nTextDiff, totDiff))
       {
          ++totDiff.elemWithAttribValueDiff;    // this element had one or more differences in an attribute value contents
       }
@@ -655,8 +709,8 @@ void compareXmlAttribs(XMLElement* elem1, XMLElement* elem2, XmlDifferences& tot
    {
       const char* attribName1 = (attrib1 ? attrib1->Name() : "");
       const char* attribName2 = (attrib2 ? attrib2->Name() : "");
-      outputDiff(cout, "attribute name", attribName1, attribName2);
-      ++attributeNameCount;
+      if (outputDiffcptr(ctx, DiffTitle(DiffRecordWriter::AttributeName, "attribute name"), attribName1, attribName2))
+         ++attributeNameCount;
 
       if (attrib1)
          attrib1 = getNextDesiredAttribute(attrib1);
@@ -674,73 +728,171 @@ void compareXmlAttribs(XMLElement* elem1, XMLElement* elem2, XmlDifferences& tot
 
 
 
+/**
+ * Compare one pair of XML elements: the tag, the attributes and the text, but not the child elements.
+ * The model tree gets the element pushed onto it, the caller must pop it when done with the children.
+ *
+ * @param ctx the comparison context
+ * @param element1 XML element 1 to use in comparison
+ * @param element2 XML element 2 to use in comparison against element 1
+ * @param totDiff the number of differences is incremented in this object
+ * @param sideBySide output the two elements side by side before comparing them (or hold them for --context)
+ * @param delim set of characters to use as delimiters to break attribute value into tokens (e.g. "{,\n ")
+ */
+void compareXmlElement(DiffContext& ctx, XMLElement* element1, XMLElement* element2, XmlDifferences& totDiff, bool sideBySide, const MU_CharSet& delim)
+{
+   if (sideBySide)
+      ctx.side.pair(*ctx.out, element1, element2);
+
+   ++totDiff.totalElemCompared;
+   const char* tagValue1 = element1->Value();   // tag 1 value: <tag>
+   if (!matchName(tagValue1, element1->NameAtom(), element2->Value(), element2->NameAtom())
+      && outputDiffcptr(ctx, DiffTitle(DiffRecordWriter::TagName, "XML Tag difference"), tagValue1, element2->Value()))
+   {
+      ++totDiff.totalDifferentTypeElem;
+   }
+
+   // see if element 1 matches the 'ignore' filters.  if so then skip the attribute and content checks
+   XmlAttributeView attribs(element1);
+   // keep track of model tree
+   pushToModelTree(ctx, tagValue1, attribs);
+   //outputModelTree(ctx, cout);
+   if (checkXmlFilter(tagValue1, attribs))
+   {
+      // matched filter so ignore further checks
+   }
+   else
+   {
+      // check attributes for differences
+      compareXmlAttribs(ctx, element1, element2, totDiff, delim);
+
+      // compare the text within the <tag>...</tag>
+      compareXmlText(ctx, element1, element2, totDiff, delim);
+   }
+}
+
+
+
+
+/**
+ * See if two subtrees can be skipped because their fingerprints (--skip-same) say they
+ * are the same.  If so their elements are counted as compared, the same as if they had
+ * been compared and no differences found.
+ *
+ * @param elem1 XML element 1, the top of its subtree
+ * @param elem2 XML element 2, the top of its subtree
+ * @param totDiff the number of elements compared is incremented in this object
+ * @return true if the subtrees are the same.  false if they differ or have no fingerprints
+ */
+bool sameSubtree(const XMLElement* elem1, const XMLElement* elem2, XmlDifferences& totDiff)
+{
+   const XmlFingerprint::Entry* fingerprint1 = XmlFingerprint::get(elem1);
+   const XmlFingerprint::Entry* fingerprint2 = XmlFingerprint::get(elem2);
+   if (!fingerprint1 || !fingerprint2 || fingerprint1->hash != fingerprint2->hash || fingerprint1->elements != fingerprint2->elements)
+      return false;
+
+   totDiff.totalElemCompared += fingerprint1->elements;
+   return true;
+}
+
+
+
+
+/**
+ * Output an element that is only in one of the files (--align) as deleted or inserted.
+ * The path given is that of the element itself.  Its child elements are not reported.
+ *
+ * @param ctx the comparison context
+ * @param element the element
+ * @param inFile1 true if the element is in file 1, false if in file 2
+ * @param totDiff the number of deleted or inserted elements is incremented in this object, if it was written
+ */
+void outputOnlyInOneFile(DiffContext& ctx, XMLElement* element, bool inFile1, XmlDifferences& totDiff)
+{
+   const char* tagName = element->Value();
+   pushToModelTree(ctx, tagName, XmlAttributeView(element));
+   if (inFile1)
+   {
+      if (outputDiffcptr(ctx, DiffTitle(DiffRecordWriter::Deleted, "element deleted"), tagName, ""))
+         ++totDiff.elemDeleted;
+   }
+   else
+   {
+      if (outputDiffcptr(ctx, DiffTitle(DiffRecordWriter::Inserted, "element inserted"), "", tagName))
+         ++totDiff.elemInserted;
+   }
+   popFromModelTree(ctx);
+}
+
+
+
+
 /**
  * Compare two XML files for differences.
  * The two elements passed in are the starting point.  Child elements will be compared and then siblings.
+ * The siblings are paired by position, or with --align by the SiblingAligner.
  *
+ * @param ctx the comparison context
  * @param elem1 XML element 1 to use in comparison
  * @param elem2 XML element 2 to use in comparison against element 1
  * @param totDiff the number of differences is incremented in this object
- * @param delim string containing the characters to use as delimiters to break attribute value into tokens (e.g. "{,\n ")
- * @return true if there is a major difference that should require stopping
+ * @param delim set of characters to use as delimiters to break attribute value into tokens (e.g. "{,\n ")
+ * @return true if the comparison stopped early (ctx.stopping()).  The model tree is left as it was then
  */
-bool compareXmlFiles(XMLElement* elem1, XMLElement* elem2, XmlDifferences& totDiff, bool sideBySide, const string& delim = " ")
+bool compareXmlFiles(DiffContext& ctx, XMLElement* elem1, XMLElement* elem2, XmlDifferences& totDiff, bool sideBySide, const MU_CharSet& delim)
 {
-   const bool stopOnMajorDiff = false;
-   const size_t margin = 80;
    XMLElement* element1 = elem1;
    XMLElement* element2 = elem2;
-   map<string, string> attribs;
 
-   while (element1 && element2)
+   if (ctx.align.enabled && (element1 || element2))
    {
-      if (sideBySide)
-         outputElementsSideBySide(element1, element2, margin);
-
-      ++totDiff.totalElemCompared;
-      const char* tagValue1 = element1->Value();   // tag 1 value: <tag>
-      if (!matchString(tagValue1, element2->Value()))
+      // the pairs of each level are kept in ctx so their memory is used again.  the
+      // list may move when a deeper level is added, so it is indexed every time
+      const size_t level = ctx.modelTree.depth();
+      if (ctx.align.pairs.size() <= level)
+         ctx.align.pairs.resize(level + 1);
+      ctx.align.pairs[level].clear();
+      ctx.align.aligner.align(element1, element2, ctx.align.pairs[level]);
+
+      for (size_t i = 0; i < ctx.align.pairs[level].size(); ++i)
       {
-         string s1 = "<";
-         s1 += tagValue1;
-         s1 += ">";
-         string s2 = "<";
-         s2 += element2->Value();
-         s2 += ">";
-         outputDiff(cout, "XML Tag difference", s1, s2);
-
-         ++totDiff.totalDifferentTypeElem;
-         //if (stopOnMajorDiff)
-         //   return true;  // return here will cause comparison to stop if different tags encountered
+         element1 = ctx.align.pairs[level][i].element1;
+         element2 = ctx.align.pairs[level][i].element2;
+         if (!element1 || !element2)
+         {
+            outputOnlyInOneFile(ctx, (element1 ? element1 : element2), (element1 != nullptr), totDiff);
+         }
+         else if (!sameSubtree(element1, element2, totDiff))
+         {
+            compareXmlElement(ctx, element1, element2, totDiff, sideBySide, delim);
+            if (compareXmlFiles(ctx, element1->FirstChildElement(), element2->FirstChildElement(), totDiff, sideBySide, delim))
+               return true;
+            popFromModelTree(ctx);
+         }
+         if (ctx.stopping())
+            return true;
       }
+      return false;
+   }
 
-      // see if element 1 matches the 'ignore' filters.  if so then skip the attribute and content checks
-      getXmlAttributesFromElem(element1, attribs);
-      // keep track of model tree
-      pushToModelTree(tagValue1, attribs);
-      //outputModelTree(cout);
-      if (checkXmlFilter(tagValue1, attribs))
-      {
-         // matched filter so ignore further checks
-      }
-      else
+   while (element1 && element2)
+   {
+      if (!sameSubtree(element1, element2, totDiff))
       {
-         // check attributes for differences
-         compareXmlAttribs(element1, element2, totDiff, delim);
+         compareXmlElement(ctx, element1, element2, totDiff, sideBySide, delim);
 
-         // compare the text within the <tag>...</tag>
-         compareXmlText(element1, element2, totDiff, delim);
-      }
+         // check out child elements.  if it returns true the comparison is stopping so stop
+         if (compareXmlFiles(ctx, element1->FirstChildElement(), element2->FirstChildElement(), totDiff, sideBySide, delim))
+            return true;
 
-      // check out child elements.  if it returns true it means fatal error so stop
-      if (compareXmlFiles(element1->FirstChildElement(), element2->FirstChildElement(), totDiff, sideBySide, delim) && stopOnMajorDiff)
+         popFromModelTree(ctx);
+      }
+      if (ctx.stopping())
          return true;
 
       // go to next sibling element and continue the comparison
       element1 = element1->NextSiblingElement();
       element2 = element2->NextSiblingElement();
-
-      popFromModelTree();
    }
 
    // see if more sibling elements for file 1 or 2
@@ -759,72 +911,764 @@ bool compareXmlFiles(XMLElement* elem1, XMLElement* elem2, XmlDifferences& totDi
 
 
 /**
- * Compare two XML documents for differences.
- * Starts with the first child of each document (ignores the root element).
+ * Count how many element pairs are found 'depth' levels below elem1 and elem2
+ * (including their siblings).  Used to pick how far down to split the work.
  */
-bool compareXmlFiles(XMLDocument& doc1, XMLDocument& doc2, XmlDifferences& totDiff, bool sideBySide, const string& delim = " ")
-{
-   XMLElement* element1 = doc1.FirstChildElement();
-   XMLElement* element2 = doc2.FirstChildElement();
-   return compareXmlFiles(element1, element2, totDiff, sideBySide, delim);
-}
-
-
-
-
-void writeXmlFile(const std::string& filename, XMLDocument& doc)
-{
-   doc.SaveFile(filename.c_str());
-}
-
-
-
-
-void writeXmlFiles(XMLDocument& doc1, XMLDocument& doc2)
+unsigned int countXmlPairs(XMLElement* elem1, XMLElement* elem2, unsigned int depth)
 {
-   writeXmlFile("xmldiff_file1.xml", doc1);
-   writeXmlFile("xmldiff_file2.xml", doc2);
+   unsigned int count = 0;
+   for (; elem1 && elem2; elem1 = elem1->NextSiblingElement(), elem2 = elem2->NextSiblingElement())
+   {
+      if (depth == 0)
+         ++count;
+      else
+         count += countXmlPairs(elem1->FirstChildElement(), elem2->FirstChildElement(), depth - 1);
+   }
+   return count;
 }
 
 
 
 
 /**
- * Output differences, both summary of all differences and optional total appended to a file.
+ * Split the comparison into pieces that can run on separate threads.
+ * Element pairs 'depth' levels down become one piece each.  The elements above
+ * them are compared here as the tree is walked, and their output goes into
+ * pieces of their own so the order of the output is kept.
  */
-void outputDiff(const std::string& compare1, const std::string& compare2, XmlDifferences& totDiff, ostream& out, const std::string& totFile)
+void splitXmlCompare(DiffContext& ctx, XMLElement* elem1, XMLElement* elem2, unsigned int depth,
+   bool sideBySide, const MU_CharSet& delim, list<DiffWork>& work)
 {
-   out << totDiff;
+   XMLElement* element1 = elem1;
+   XMLElement* element2 = elem2;
 
-   if (!totFile.empty())
+   // the same pairs as compareXmlFiles() makes.  with --align none are left over at the end
+   vector<SiblingAligner::Pair> pairs;
+   if (ctx.align.enabled)
    {
-      ofstream aout(totFile, ios_base::app);
-      if (aout)
+      ctx.align.aligner.align(element1, element2, pairs);
+      element1 = nullptr;
+      element2 = nullptr;
+   }
+   for (; element1 && element2; element1 = element1->NextSiblingElement(), element2 = element2->NextSiblingElement())
+      pairs.push_back(SiblingAligner::Pair(element1, element2));
+
+   for (size_t i = 0; i < pairs.size() && !ctx.stopping(); ++i)
+   {
+      XMLElement* pair1 = pairs[i].element1;
+      XMLElement* pair2 = pairs[i].element2;
+      work.emplace_back();
+      DiffWork& piece = work.back();
+      if (!pair1 || !pair2)
       {
-         aout << compare1 << "," << compare2 << "," << totDiff.Total() << endl;
-         aout.close();
+         ctx.writeTo(piece);
+         outputOnlyInOneFile(ctx, (pair1 ? pair1 : pair2), (pair1 != nullptr), piece.totDiff);
       }
-      else
+      else if (depth == 0)
+      {
+         piece.element1 = pair1;
+         piece.element2 = pair2;
+         for (size_t level = 0; level < ctx.modelTree.depth(); ++level)
+            piece.modelTree.push_back(ctx.modelTree.name(level));
+      }
+      else if (!sameSubtree(pair1, pair2, piece.totDiff))
       {
-         cout << "Error: unable to open total file '" << totFile << "'" << endl;
+         ctx.writeTo(piece);
+         compareXmlElement(ctx, pair1, pair2, piece.totDiff, sideBySide, delim);
+         splitXmlCompare(ctx, pair1->FirstChildElement(), pair2->FirstChildElement(), depth - 1, sideBySide, delim, work);
+         popFromModelTree(ctx);
       }
    }
+
+   // see if more sibling elements for file 1 or 2
+   if ((element1 || element2) && !ctx.stopping())
+   {
+      work.emplace_back();
+      DiffWork& piece = work.back();
+      if (element1)
+         piece.totDiff.extraElemFile1 = countElement(element1);
+      if (element2)
+         piece.totDiff.extraElemFile2 = countElement(element2);
+   }
 }
 
 
 
 
 /**
- * Process the settings from optional config file (to change defaults, etc).
- *
- * @param configXml an XMLDocument containing the config file after reading it in
+ * Compare the element pair of one piece and everything below it.  Runs on a pool thread.
  */
-void processConfigFile(const XMLDocument* configXml)
+void compareXmlWork(DiffWork* piece, bool sideBySide, const MU_CharSet* delim, DiffRecordWriter* records, bool align,
+   DiffBudget* budget)
 {
-   if (!configXml)
+   if (sameSubtree(piece->element1, piece->element2, piece->totDiff))
       return;
-   const XMLElement* root = configXml->FirstChildElement();
-   if (!root)
+
+   DiffContext ctx(piece->out, records, align);
+   ctx.budget = budget;
+   if (ctx.stopping())
+      return;
+   ctx.writeTo(*piece);
+   ctx.doc1 = piece->element1->GetDocument();
+   ctx.doc2 = piece->element2->GetDocument();
+   for (size_t i = 0; i < piece->modelTree.size(); ++i)
+      ctx.modelTree.push(piece->modelTree[i].c_str());
+
+   compareXmlElement(ctx, piece->element1, piece->element2, piece->totDiff, sideBySide, *delim);
+   if (!compareXmlFiles(ctx, piece->element1->FirstChildElement(), piece->element2->FirstChildElement(), piece->totDiff, sideBySide, *delim))
+      popFromModelTree(ctx);
+}
+
+
+
+
+/**
+ * Compare one piece, then write it and the finished pieces after it if its turn has come.  Runs on a pool thread.
+ */
+void compareXmlPiece(DiffWork* piece, bool sideBySide, const MU_CharSet* delim, DiffRecordWriter* records, bool align,
+   DiffBudget* budget, DiffWorkCursor* cursor)
+{
+   compareXmlWork(piece, sideBySide, delim, records, align, budget);
+   cursor->finish(piece);
+}
+
+
+
+
+/**
+ * Compare two XML documents for differences.
+ * Starts with the first child of each document (ignores the root element).
+ *
+ * With more than one job the subtrees a few levels down are compared on a
+ * pool of threads.  The output and totals are the same as with one job, and
+ * each piece is written as soon as the pieces before it are.
+ * The differences are written to 'out', as records if 'records' is not null.
+ * With 'align' the child elements are paired by key instead of by position.  The comparison
+ * stops early if 'budget' (if not null) says so; with a limit on the differences it runs on
+ * one thread so the differences written are the first ones in the files.  So does --side with
+ * --context, as the pairs shown around a difference may be in another piece.
+ */
+bool compareXmlFiles(XMLDocument& doc1, XMLDocument& doc2, XmlDifferences& totDiff, bool sideBySide, const MU_CharSet& delim,
+   ostream& out, DiffRecordWriter* records, bool align, DiffBudget* budget, unsigned int jobs = 1)
+{
+   XMLElement* element1 = doc1.FirstChildElement();
+   XMLElement* element2 = doc2.FirstChildElement();
+
+   if (jobs <= 1 || (budget && budget->maxDiffs() > 0) || (sideBySide && gSideContext >= 0))
+   {
+      DiffContext ctx(out, records, align);
+      ctx.budget = budget;
+      ctx.doc1 = &doc1;
+      ctx.doc2 = &doc2;
+      return compareXmlFiles(ctx, element1, element2, totDiff, sideBySide, delim);
+   }
+
+   // split at the first level that gives each thread several pieces to share out
+   const unsigned int maxSplitDepth = 4;
+   unsigned int depth = 1;
+   while (depth < maxSplitDepth && countXmlPairs(element1, element2, depth) < 4 * jobs)
+      ++depth;
+
+   list<DiffWork> work;
+   DiffContext ctx(out, records, align);
+   ctx.budget = budget;
+   ctx.doc1 = &doc1;
+   ctx.doc2 = &doc2;
+   splitXmlCompare(ctx, element1, element2, depth, sideBySide, delim, work);
+
+   // the pieces are written in document order by the cursor as they finish, and the paths
+   // of the records are given their ids then, so they are the same as with one thread.  they
+   // are handed to the pool a window at a time so the pieces waiting to be written stay few
+   DiffWorkCursor cursor(work, out, records, totDiff);
+   cursor.writeFinished();
+   const size_t windowSize = 16 * jobs;
+   WorkStealingPool pool(jobs);
+   list<DiffWork>::iterator w_it = work.begin();
+   while (w_it != work.end())
+   {
+      // stops at the first piece to compare that is not in the window.  the cursor removes
+      // the pieces before it while the pool runs, but not that one
+      size_t n = 0;
+      for (; w_it != work.end(); ++w_it)
+      {
+         if (!w_it->element1)
+            continue;
+         if (n == windowSize)
+            break;
+         pool.add(std::bind(compareXmlPiece, &*w_it, sideBySide, &delim, records, align, budget, &cursor));
+         ++n;
+      }
+      pool.run();
+   }
+
+   return (budget && budget->reason() != DiffBudget::NotStopped);
+}
+
+
+
+
+/**
+ * Compare two files byte for byte (--quick).
+ *
+ * @return true if both files could be read and are the same
+ */
+bool sameFileBytes(const string& filename1, const string& filename2)
+{
+   FILE* file1 = fopen(filename1.c_str(), "rb");
+   FILE* file2 = fopen(filename2.c_str(), "rb");
+   bool same = (file1 && file2);
+
+   const size_t blockSize = 1024 * 1024;
+   vector<char> block1(same ? blockSize : 0);
+   vector<char> block2(same ? blockSize : 0);
+   while (same)
+   {
+      const size_t n1 = fread(&block1[0], 1, blockSize, file1);
+      const size_t n2 = fread(&block2[0], 1, blockSize, file2);
+      if (n1 != n2 || memcmp(&block1[0], &block2[0], n1) != 0)
+         same = false;
+      else if (n1 < blockSize)
+         break;
+   }
+   // a read error is not the same
+   if (same && (ferror(file1) || ferror(file2)))
+      same = false;
+
+   if (file1)
+      fclose(file1);
+   if (file2)
+      fclose(file2);
+   return same;
+}
+
+
+
+
+/**
+ * Read an XML file into a document, either by reading it into a buffer or by
+ * mapping it into memory.  A snapshot (XMLDocument::SaveSnapshot()) is loaded
+ * as one.  Check doc.Error() afterwards.
+ */
+void loadXmlFile(XMLDocument& doc, const char* filename, bool memoryMapped)
+{
+   MU_RunStats::Times start = (gRunStats ? MU_RunStats::now() : MU_RunStats::Times());
+   if (XMLDocument::IsSnapshot(filename))
+   {
+      doc.LoadSnapshot(filename);
+      if (gRunStats)
+         gRunStats->addPhase("load", start);
+      return;
+   }
+
+   // read, then parse, so --stats can time them apart
+   doc.ReadFile(filename, memoryMapped);
+   if (gRunStats)
+      start = gRunStats->addPhase("load", start);
+   doc.ParseLoaded();
+   if (gRunStats)
+      gRunStats->addPhase("parse", start);
+}
+
+
+
+
+/**
+ * Add the size of a file read to the "bytes" count of --stats.
+ */
+void addFileBytes(const string& filename)
+{
+   unsigned long long size = 0;
+   long long modified = 0;
+   if (gRunStats && SidecarFile::fileKey(filename, size, modified))
+      gRunStats->addCount("bytes", size, "");
+}
+
+
+
+
+/**
+ * Add the memory pools of a document to --stats.
+ */
+void addMemPoolStats(const XMLDocument& doc)
+{
+   if (gRunStats)
+      XmlDocumentPool::addMemPoolStats(*gRunStats, doc);
+}
+
+
+
+
+/**
+ * Add the counts of a comparison to --stats.
+ */
+void addCompareStats(const XmlDifferences& totDiff)
+{
+   if (!gRunStats)
+      return;
+   gRunStats->addCount("elements", totDiff.totalElemCompared, "compare");
+   gRunStats->addCount("token pairs", totDiff.totalTokensCompared, "compare");
+   gRunStats->addCount("number pairs", totDiff.totalNumbersCompared, "compare");
+   gRunStats->addCount("differences", totDiff.Total());
+}
+
+
+
+
+/**
+ * The key a snapshot of an XML file is saved with (--snapshot), from the size and
+ * modification time of the file (see SidecarFile::fileKey).  The time is set in 'modified'.
+ *
+ * @return false if the file cannot be found
+ */
+bool snapshotKey(const string& filename, unsigned long long& key, long long& modified)
+{
+   unsigned long long size = 0;
+   if (!SidecarFile::fileKey(filename, size, modified))
+      return false;
+   key = MU_Hash::Mix(size ^ MU_Hash::Mix(static_cast<unsigned long long>(modified)));
+   return true;
+}
+
+
+
+
+/**
+ * Load one of the files to compare.  An error is written to 'out'.  With 'snapshot' the
+ * document is loaded from the snapshot '<file>.xdsnap' if it was made from this version
+ * of the file, else the file is parsed and the snapshot saved for the next run.  A snapshot
+ * not newer than the file may have missed a change in the same clock tick, so it is neither
+ * used nor saved (see SidecarFile).
+ *
+ * @return true if the file could not be loaded
+ */
+bool loadXmlFileToCompare(XMLDocument& doc, const string& filename, bool memoryMapped, bool snapshot,
+   const DiffRecordWriter* records, ostream& out)
+{
+   const string sidecar = filename + ".xdsnap";
+   unsigned long long key = 0;
+   unsigned long long savedKey = 0;
+   long long modified = 0;
+   const bool useSnapshot = snapshot && snapshotKey(filename, key, modified);
+   MU_RunStats::Times start = (gRunStats ? MU_RunStats::now() : MU_RunStats::Times());
+   if (useSnapshot && XMLDocument::IsSnapshot(sidecar.c_str(), &savedKey) && savedKey == key
+      && SidecarFile::writtenAfter(sidecar, modified) && doc.LoadSnapshot(sidecar.c_str()) == XML_NO_ERROR)
+   {
+      if (gRunStats)
+         gRunStats->addPhase("load", start);
+      addFileBytes(sidecar);
+      return false;
+   }
+
+   loadXmlFile(doc, filename.c_str(), memoryMapped);
+   if (doc.Error())
+   {
+      DiffRecordWriter::writeError(out, records, "Error opening file '" + filename + "': " + doc.ErrorName());
+      return true;
+   }
+   addFileBytes(filename);
+
+   // a file given as a snapshot already is one
+   if (useSnapshot && !XMLDocument::IsSnapshot(filename.c_str()))
+   {
+      start = (gRunStats ? MU_RunStats::now() : start);
+      const string temporary = SidecarFile::temporaryName(sidecar);
+      FILE* file = SidecarFile::create(temporary);
+      if (file)
+      {
+         const bool saved = (doc.SaveSnapshot(file, key) == XML_NO_ERROR);
+         if (fclose(file) == 0 && saved && SidecarFile::writtenAfter(temporary, modified))
+            SidecarFile::replace(temporary, sidecar);
+         else
+            remove(temporary.c_str());
+      }
+      if (gRunStats)
+         gRunStats->addPhase("save snapshot", start);
+   }
+   return false;
+}
+
+
+
+
+/**
+ * Hash of the settings the fingerprints of a file depend on: case sensitivity, the
+ * delimiters and the attributes compared.  Fingerprints kept from a run with other
+ * settings (--cache) are not used.
+ */
+unsigned long long fingerprintSettings(const MU_CharSet& delim)
+{
+   unsigned long long hash = MU_Hash::AddByte(MU_Hash::Start, gCaseSensitive ? 'c' : 'i');
+   for (int c = 0; c < 256; ++c)
+      hash = MU_Hash::AddByte(hash, delim.contains(static_cast<char>(c)) ? 1 : 0);
+   if (gDesiredAttributes.all())
+      hash = MU_Hash::AddByte(hash, '*');
+   const vector<string>& attributes = gDesiredAttributes.names();
+   for (size_t i = 0; i < attributes.size(); ++i)
+      hash = MU_Hash::AddByte(MU_Hash::AddChars(hash, attributes[i].c_str(), attributes[i].size()), 0);
+   return MU_Hash::Mix(hash);
+}
+
+
+
+
+/**
+ * Move a pull parser to the next element at the current level.  Text and other
+ * nodes in between are passed over.
+ *
+ * @return true if positioned on a START_ELEMENT, false if the end of the parent
+ *         element (or the document) was read instead
+ */
+bool nextStreamSibling(XmlPullParser& parser)
+{
+   for (;;)
+   {
+      XmlPullParser::Event ev = parser.next();
+      if (ev == XmlPullParser::START_ELEMENT)
+         return true;
+      if (ev != XmlPullParser::TEXT)
+         return false;
+   }
+}
+
+
+
+/**
+ * Skip over the rest of the element the parser is in, up to and including its end tag.
+ */
+void skipStreamElement(XmlPullParser& parser)
+{
+   size_t level = 0;
+   for (;;)
+   {
+      XmlPullParser::Event ev = parser.next();
+      if (ev == XmlPullParser::START_ELEMENT)
+         ++level;
+      else if (ev == XmlPullParser::END_ELEMENT && level-- == 0)
+         return;
+      else if (ev == XmlPullParser::END_DOCUMENT || ev == XmlPullParser::PARSE_ERROR)
+         return;
+   }
+}
+
+
+
+/**
+ * Same as countElement() but for a pull parser sitting on a START_ELEMENT: count
+ * it and the siblings that follow, reading up to the end of the parent.
+ */
+unsigned int countStreamElement(XmlPullParser& parser)
+{
+   unsigned int count = 0;
+   do
+   {
+      ++count;
+      skipStreamElement(parser);
+   } while (nextStreamSibling(parser));
+   return count;
+}
+
+
+
+/**
+ * Build a stand-alone copy of the element the parser is sitting on (tag,
+ * attributes and the text if it is the first child) in a scratch document, so
+ * the usual element compare functions can be used on it.  The children are
+ * not included.  Remove it with doc.DeleteNode() when done.
+ */
+XMLElement* makeStreamElement(XmlPullParser& parser, XMLDocument& doc)
+{
+   XMLElement* elem = doc.NewElement(parser.name());
+   for (size_t i = 0; i < parser.attributeCount(); ++i)
+   {
+      elem->SetAttribute(parser.attributeName(i), parser.attributeValue(i));
+   }
+
+   if (parser.next() == XmlPullParser::TEXT && parser.firstChild())
+   {
+      elem->InsertEndChild(doc.NewText(parser.text()));
+   }
+   else
+   {
+      parser.unread();
+   }
+   return elem;
+}
+
+
+
+/**
+ * Streaming version of compareXmlFiles().  The two parsers are moved along
+ * together and each pair of elements is compared as soon as it has been read, so
+ * only the elements on the current path are ever held in memory.  The output is
+ * the same as comparing the two documents.
+ *
+ * Both parsers must be at the start of a level (document or just inside an
+ * element); they are left after the end of that level, unless it returns true
+ * because the comparison stopped early.
+ */
+bool compareXmlStreams(DiffContext& ctx, XmlPullParser& parser1, XmlPullParser& parser2, XMLDocument& scratch1, XMLDocument& scratch2,
+   XmlDifferences& totDiff, bool sideBySide, const MU_CharSet& delim)
+{
+   bool more1 = nextStreamSibling(parser1);
+   bool more2 = nextStreamSibling(parser2);
+
+   while (more1 && more2)
+   {
+      XMLElement* element1 = makeStreamElement(parser1, scratch1);
+      XMLElement* element2 = makeStreamElement(parser2, scratch2);
+      compareXmlElement(ctx, element1, element2, totDiff, sideBySide, delim);
+      scratch1.DeleteNode(element1);
+      scratch2.DeleteNode(element2);
+
+      if (compareXmlStreams(ctx, parser1, parser2, scratch1, scratch2, totDiff, sideBySide, delim) || ctx.stopping())
+         return true;
+
+      more1 = nextStreamSibling(parser1);
+      more2 = nextStreamSibling(parser2);
+
+      popFromModelTree(ctx);
+   }
+
+   // see if more sibling elements for file 1 or 2
+   if (more1)
+   {
+      totDiff.extraElemFile1 = countStreamElement(parser1);
+   }
+   if (more2)
+   {
+      totDiff.extraElemFile2 = countStreamElement(parser2);
+   }
+
+   return false;
+}
+
+
+
+/**
+ * Compare two XML files by streaming them instead of loading them into documents.
+ * The differences, and any error reading the files, are written to 'out' (as records
+ * if 'records' is not null).  The values of stream records have no offsets.
+ *
+ * @return true if one of the files could not be read or is not well formed
+ */
+bool compareXmlStreams(const char* filename1, const char* filename2, XmlDifferences& totDiff, bool sideBySide, const MU_CharSet& delim,
+   ostream& out, DiffRecordWriter* records, DiffBudget* budget)
+{
+   XmlPullParser parser1, parser2;
+   if (parser1.open(filename1))
+   {
+      DiffRecordWriter::writeError(out, records, string("Error opening file '") + filename1 + "': " + parser1.errorName());
+      return true;
+   }
+   if (parser2.open(filename2))
+   {
+      DiffRecordWriter::writeError(out, records, string("Error opening file '") + filename2 + "': " + parser2.errorName());
+      return true;
+   }
+
+   XMLDocument scratch1, scratch2;
+   DiffContext ctx(out, records);
+   ctx.budget = budget;
+   const MU_RunStats::Times start = (gRunStats ? MU_RunStats::now() : MU_RunStats::Times());
+   compareXmlStreams(ctx, parser1, parser2, scratch1, scratch2, totDiff, sideBySide, delim);
+   if (gRunStats)
+   {
+      // the files are read and parsed as they are compared, so that is all one phase
+      gRunStats->addPhase("compare", start);
+      addFileBytes(filename1);
+      addFileBytes(filename2);
+      addMemPoolStats(scratch1);
+      addMemPoolStats(scratch2);
+      addCompareStats(totDiff);
+   }
+
+   // a parse error shows up as the end of the data, so check for it here
+   if (parser1.errorID() != XML_NO_ERROR)
+   {
+      DiffRecordWriter::writeError(out, records, string("Error reading file '") + filename1 + "': " + parser1.errorName());
+      return true;
+   }
+   if (parser2.errorID() != XML_NO_ERROR)
+   {
+      DiffRecordWriter::writeError(out, records, string("Error reading file '") + filename2 + "': " + parser2.errorName());
+      return true;
+   }
+   return false;
+}
+
+
+
+
+void writeXmlFile(const std::string& filename, XMLDocument& doc)
+{
+   doc.SaveFile(filename.c_str());
+}
+
+
+
+
+void writeXmlFiles(XMLDocument& doc1, XMLDocument& doc2)
+{
+   writeXmlFile("xmldiff_file1.xml", doc1);
+   writeXmlFile("xmldiff_file2.xml", doc2);
+}
+
+
+
+
+/**
+ * Output differences, both summary of all differences and optional total appended to a file.
+ */
+void outputDiff(const std::string& compare1, const std::string& compare2, XmlDifferences& totDiff, ostream& out,
+   const DiffRecordWriter* records, const std::string& totFile)
+{
+   totDiff.write(out, records);
+
+   if (!totFile.empty())
+   {
+      ofstream aout(totFile, ios_base::app);
+      if (aout)
+      {
+         aout << compare1 << "," << compare2 << "," << totDiff.Total() << endl;
+         aout.close();
+      }
+      else
+      {
+         DiffRecordWriter::writeError(out, records, "Error: unable to open total file '" + totFile + "'");
+      }
+   }
+}
+
+
+
+
+/**
+ * Load two XML files and compare them, or compare them as they are read with --stream.
+ * The differences, and any error loading the files, are written to 'out'.  With records
+ * (--format) a files record comes first and --side is not used.
+ *
+ * @param filename1 XML file 1
+ * @param filename2 XML file 2 to compare against file 1
+ * @param runSettings the program settings
+ * @param delim set of characters to use as delimiters to break attribute value into tokens
+ * @param doc1 document to load file 1 into (not used with --stream)
+ * @param doc2 document to load file 2 into (not used with --stream)
+ * @param reformat write the two documents out reformatted after loading them (--ref)
+ * @param jobs number of threads to compare the subtrees on
+ * @param totDiff the number of differences is incremented in this object
+ * @param out where the differences are written
+ * @param records write the differences as records in this format, null for text lines
+ * @param budget stop the comparison early when this says so, null to always finish
+ * @return true if the files could not be compared
+ */
+bool compareXmlPair(const string& filename1, const string& filename2, const RunSettings& runSettings, const MU_CharSet& delim,
+   XMLDocument& doc1, XMLDocument& doc2, bool reformat, unsigned int jobs, XmlDifferences& totDiff, ostream& out,
+   DiffRecordWriter* records, DiffBudget* budget)
+{
+   // the side by side text would break up the records
+   const bool sideBySide = runSettings.getSideBySide() && !records;
+   if (records)
+      records->files(out, filename1, filename2);
+
+   // out of time already (--batch), nothing is compared
+   if (budget && budget->checkClock())
+      return false;
+
+   // the same bytes cannot differ as XML, so they need not be parsed
+   if (runSettings.getQuick() && !reformat && sameFileBytes(filename1, filename2))
+   {
+      if (!records)
+         out << "Files are the same byte for byte" << endl;
+      return false;
+   }
+
+   if (runSettings.getStreaming())
+   {
+      // never loads either file as a whole, so --ref is not available here
+      return compareXmlStreams(filename1.c_str(), filename2.c_str(), totDiff, sideBySide, delim, out, records, budget);
+   }
+
+   PairAtoms atoms(doc1, doc2);
+
+   // fingerprint the subtrees so the ones that are the same are skipped.  not with
+   // --side, which has to show every element.  with --cache the fingerprints of file 1
+   // may be kept from an earlier run
+   const bool memoryMapped = runSettings.getMemoryMapped();
+   const bool snapshot = runSettings.getSnapshot();
+   const bool fingerprints = (runSettings.getSkipSame() || runSettings.getFingerprintCache()) && !sideBySide;
+   const bool useCache = fingerprints && runSettings.getFingerprintCache();
+   FingerprintCache cache(filename1, fingerprintSettings(delim));
+   XmlFingerprint fingerprint1(delim, gCaseSensitive, isDesiredAttribute);
+   XmlFingerprint fingerprint2(delim, gCaseSensitive, isDesiredAttribute);
+   if (useCache && !reformat && cache.read())
+   {
+      // file 2 first: if its top subtrees are those of file 1, file 1 need not be read
+      if (loadXmlFileToCompare(doc2, filename2, memoryMapped, false, records, out))
+         return true;
+      fingerprint2.compute(&doc2);
+      unsigned int elements = 0;
+      if (cache.sameTop(doc2, elements))
+      {
+         totDiff.totalElemCompared += elements;
+         return false;
+      }
+
+      if (loadXmlFileToCompare(doc1, filename1, memoryMapped, snapshot, records, out))
+         return true;
+      if (!fingerprint1.attach(&doc1, cache.entries()))
+      {
+         fingerprint1.compute(&doc1);
+         cache.write(fingerprint1.entries());
+      }
+   }
+   else
+   {
+      if (loadXmlFileToCompare(doc1, filename1, memoryMapped, snapshot, records, out)
+         || loadXmlFileToCompare(doc2, filename2, memoryMapped, false, records, out))
+         return true;
+
+      if (reformat)
+         writeXmlFiles(doc1, doc2);
+
+      // the two files are done at the same time when there is more than one job
+      if (fingerprints)
+      {
+         const MU_RunStats::Times start = (gRunStats ? MU_RunStats::now() : MU_RunStats::Times());
+         WorkStealingPool pool(jobs > 1 ? 2 : 1);
+         pool.add(std::bind(&XmlFingerprint::compute, &fingerprint1, &doc1));
+         pool.add(std::bind(&XmlFingerprint::compute, &fingerprint2, &doc2));
+         pool.run();
+         if (gRunStats)
+            gRunStats->addPhase("fingerprint", start);
+      }
+      if (useCache)
+         cache.write(fingerprint1.entries());
+   }
+
+   const MU_RunStats::Times start = (gRunStats ? MU_RunStats::now() : MU_RunStats::Times());
+   compareXmlFiles(doc1, doc2, totDiff, sideBySide, delim, out, records, runSettings.getAlign(), budget, jobs);
+   if (gRunStats)
+   {
+      gRunStats->addPhase("compare", start);
+      addCompareStats(totDiff);
+   }
+   return false;
+}
+
+
+
+
+/**
+ * Process the settings from optional config file (to change defaults, etc).
+ *
+ * @param configXml an XMLDocument containing the config file after reading it in
+ */
+void processConfigFile(const XMLDocument* configXml)
+{
+   if (!configXml)
+      return;
+   const XMLElement* root = configXml->FirstChildElement();
+   if (!root)
       return;
 
    const XMLElement* elem = root->FirstChildElement();
@@ -838,13 +1682,21 @@ void processConfigFile(const XMLDocument* configXml)
          {
             try
             {
-               gNumberDelta = MU_StringUtil::ToDoubleEx(text);
+               gTolerance.absolute = MU_StringUtil::ToDoubleEx(text);
             }
             catch (std::runtime_error e)
             {
                // no need for anything here
             }
          }
+
+         // optional relative and ULP tolerances: <Delta rel="1e-9" ulp="4">1e-8</Delta>
+         double rel;
+         if (elem->QueryDoubleAttribute("rel", &rel) == XML_NO_ERROR)
+            gTolerance.relative = rel;
+         unsigned int ulp;
+         if (elem->QueryUnsignedAttribute("ulp", &ulp) == XML_NO_ERROR)
+            gTolerance.ulps = ulp;
       }
       else if (MU_StringUtil::Strcasecmp(tagValue, "case"))
       {
@@ -863,7 +1715,7 @@ void processConfigFile(const XMLDocument* configXml)
          while (ignElem)
          {
             XmlFilter filter(ignElem,gCaseSensitive);
-            gXmlFilters.push_back(filter);
+            gXmlFilters.add(filter);
 
             ignElem = ignElem->NextSiblingElement();
          }
@@ -878,6 +1730,12 @@ void processConfigFile(const XMLDocument* configXml)
          }
 
       }
+      else if (MU_StringUtil::Strcasecmp(tagValue, "attribs"))
+      {
+         // an empty list compares no attributes
+         const char* text = elem->GetText();
+         gDesiredAttributes.set(text ? text : "");
+      }
 
       elem = elem->NextSiblingElement();
    }
@@ -886,6 +1744,35 @@ void processConfigFile(const XMLDocument* configXml)
 
 
 
+/**
+ * Write what is left of the output, then the run statistics (--stats) to stderr.
+ *
+ * @param sink the output
+ * @param json write the statistics as JSON instead of text
+ * @param status the exit status of the program
+ * @return 'status', for main to return, or 1 if the output could not all be written
+ */
+int finishRun(OutputSink& sink, bool json, int status)
+{
+   const MU_RunStats::Times start = (gRunStats ? MU_RunStats::now() : MU_RunStats::Times());
+   const bool failed = sink.finish();
+   if (gRunStats)
+   {
+      gRunStats->addPhase("output", start);
+      gRunStats->write(cerr, json);
+   }
+   if (failed)
+   {
+      // the output itself may be what failed, so this goes to stderr
+      cerr << "Error: unable to write all of the output" << endl;
+      return 1;
+   }
+   return status;
+}
+
+
+
+
 int main(int argc, char**argv)
 {
    const char* progName = *argv;  // name of executable
@@ -894,6 +1781,8 @@ int main(int argc, char**argv)
    RunSettings runSettings(0.0, true, "|{, \n", false, false, false, false, "");
    // modify run-time settings based on user command-line arguments
    MyGetOpt(argc, argv, runSettings);
+   // the whole run is timed from here
+   MU_RunStats runStats;
 
    if (runSettings.showVersion())
    {
@@ -906,7 +1795,7 @@ int main(int argc, char**argv)
       return 1;
    }
 
-   if (runSettings.unswitchedSize() != 2)
+   if (runSettings.unswitchedSize() != 2 && runSettings.getBatchFile().empty())
    {
       UsageBasic(progName);
       return 1;
@@ -918,39 +1807,89 @@ int main(int argc, char**argv)
    processConfigFile(runSettings.getConfig());
 
    if (runSettings.getDelta() != 0.0)
-      gNumberDelta = runSettings.getDelta();
+      gTolerance.absolute = runSettings.getDelta();
 
    if (runSettings.caseSet())
       gCaseSensitive = runSettings.getCase();
    setXmlFilterCase(gCaseSensitive);
 
+   if (runSettings.attribsSet())
+      gDesiredAttributes.set(runSettings.getAttribs());
+   gDesiredAttributes.caseSensitive(gCaseSensitive);
+
    if (runSettings.delimSet())
       gDelimiters = runSettings.getDelim();
 
-   const char* filename1 = runSettings.getUnswitched(0).c_str();
-   const char* filename2 = runSettings.getUnswitched(1).c_str();
+   gSideContext = runSettings.getSideContext();
+   // lookup table of the delimiters, used for every token
+   MU_CharSet delimiters(gDelimiters);
 
-   XMLDocument doc1, doc2;
-   doc1.LoadFile(filename1);
-   if (doc1.Error())
+   // text lines, or records for other programs to read
+   DiffRecordWriter::Format format;
+   if (DiffRecordWriter::parseFormat(runSettings.getFormat(), format))
    {
-      cout << "Error opening file '" << filename1 << "': " << doc1.ErrorName() << endl;
+      cout << "Error: unknown format '" << runSettings.getFormat() << "', use text, jsonl or binary" << endl;
       return 1;
    }
-   doc2.LoadFile(filename2);
-   if (doc2.Error())
+   DiffRecordWriter recordWriter(format);
+   const string& statsFormat = runSettings.getStats();
+   if (!statsFormat.empty() && statsFormat != "text" && statsFormat != "json")
    {
-      cout << "Error opening file '" << filename2 << "': " << doc2.ErrorName() << endl;
+      cout << "Error: unknown stats format '" << statsFormat << "', use text or json" << endl;
       return 1;
    }
-
-   if (runSettings.getReformat())
-      writeXmlFiles(doc1, doc2);
+   if (!statsFormat.empty())
+      gRunStats = &runStats;
+   const bool statsJson = (statsFormat == "json");
+   DiffRecordWriter* records = (format == DiffRecordWriter::Text ? nullptr : &recordWriter);
+
+   // all of the output goes through the sink, which writes it in large blocks.  the
+   // ostream flushes (endl) do not write anything, finish() writes what is left
+   OutputSink sink;
+   if (!runSettings.getOutputFile().empty() && sink.open(runSettings.getOutputFile()))
+   {
+      cout << "Error: unable to open output file '" << runSettings.getOutputFile() << "'" << endl;
+      return 1;
+   }
+   if (format == DiffRecordWriter::Binary)
+      sink.setBinary();
+   if (runSettings.getAsyncOutput())
+      sink.startWriter();
+   ostream out(&sink);
+   if (records)
+      records->header(out);
+
+   // --timeout counts from here, for all the pairs of a --batch
+   const DiffBudget::Clock::time_point deadline = DiffBudget::Clock::now() +
+      std::chrono::duration_cast<DiffBudget::Clock::duration>(std::chrono::duration<double>(runSettings.getTimeout()));
+   const DiffBudget::Clock::time_point* deadlinePtr = (runSettings.getTimeout() > 0.0 ? &deadline : nullptr);
+
+   if (!runSettings.getBatchFile().empty())
+   {
+      XmlBatch batch(runSettings, std::bind(compareXmlPair, placeholders::_1, placeholders::_2, std::cref(runSettings),
+         std::cref(delimiters), placeholders::_3, placeholders::_4, false, 1u, placeholders::_5, placeholders::_6,
+         placeholders::_7, placeholders::_8), gRunStats);
+      int status = batch.run(out, records, deadlinePtr);
+      return finishRun(sink, statsJson, status);
+   }
 
    XmlDifferences totDiff;
-   compareXmlFiles(doc1, doc2, totDiff, runSettings.getSideBySide(), gDelimiters);
+   XMLDocument doc1, doc2;
+   DiffBudget budget(runSettings.diffLimit(), deadlinePtr);
+   const bool failed = compareXmlPair(runSettings.getUnswitched(0), runSettings.getUnswitched(1), runSettings, delimiters,
+      doc1, doc2, runSettings.getReformat(), runSettings.getJobs(), totDiff, out, records, &budget);
+   if (!runSettings.getStreaming())
+   {
+      addMemPoolStats(doc1);
+      addMemPoolStats(doc2);
+   }
+   if (failed)
+      return finishRun(sink, statsJson, 1);
 
-   outputDiff(runSettings.getUnswitched(0), runSettings.getUnswitched(1), totDiff, cout, runSettings.totalFile());
+   budget.writeStopped(out, records);
+   outputDiff(runSettings.getUnswitched(0), runSettings.getUnswitched(1), totDiff, out, records, runSettings.totalFile());
 
-   return 0;
+   if (runSettings.getQuick())
+      return finishRun(sink, statsJson, DiffBudget::quickStatus(totDiff.Total() > 0, budget.reason() == DiffBudget::Timeout));
+   return finishRun(sink, statsJson, 0);
 }
@@ -0,0 +1,131 @@
+/**
+ *
+ * @file XmlDifferences.cpp
+ * @brief This file contains the member function definitions for class XmlDifferences
+ */
+
+#include "XmlDifferences.h"
+
+using namespace std;
+
+
+// ==========================================================================
+XmlDifferences::XmlDifferences()
+   : totalElemCompared(0)
+   , totalDifferentTypeElem(0)
+   , extraElemFile1(0)
+   , extraElemFile2(0)
+   , elemWithAttribNameDiff(0)
+   , elemWithAttribValueDiff(0)
+   , elemWithTextDiff(0)
+   , totalTagNumbContentDiff(0)
+   , totalTagTextContentDiff(0)
+   , elemDeleted(0)
+   , elemInserted(0)
+   , totalTokensCompared(0)
+   , totalNumbersCompared(0)
+{
+}
+
+
+
+
+// ==========================================================================
+void XmlDifferences::add(const XmlDifferences& p)
+{
+   totalElemCompared += p.totalElemCompared;
+   totalDifferentTypeElem += p.totalDifferentTypeElem;
+   if (p.extraElemFile1)
+      extraElemFile1 = p.extraElemFile1;
+   if (p.extraElemFile2)
+      extraElemFile2 = p.extraElemFile2;
+   elemWithAttribNameDiff += p.elemWithAttribNameDiff;
+   elemWithAttribValueDiff += p.elemWithAttribValueDiff;
+   elemWithTextDiff += p.elemWithTextDiff;
+   totalTagNumbContentDiff += p.totalTagNumbContentDiff;
+   totalTagTextContentDiff += p.totalTagTextContentDiff;
+   elemDeleted += p.elemDeleted;
+   elemInserted += p.elemInserted;
+   totalTokensCompared += p.totalTokensCompared;
+   totalNumbersCompared += p.totalNumbersCompared;
+}
+
+
+
+
+// ==========================================================================
+void XmlDifferences::addFile(const XmlDifferences& p)
+{
+   totalElemCompared += p.totalElemCompared;
+   totalDifferentTypeElem += p.totalDifferentTypeElem;
+   extraElemFile1 += p.extraElemFile1;
+   extraElemFile2 += p.extraElemFile2;
+   elemWithAttribNameDiff += p.elemWithAttribNameDiff;
+   elemWithAttribValueDiff += p.elemWithAttribValueDiff;
+   elemWithTextDiff += p.elemWithTextDiff;
+   totalTagNumbContentDiff += p.totalTagNumbContentDiff;
+   totalTagTextContentDiff += p.totalTagTextContentDiff;
+   elemDeleted += p.elemDeleted;
+   elemInserted += p.elemInserted;
+   totalTokensCompared += p.totalTokensCompared;
+   totalNumbersCompared += p.totalNumbersCompared;
+}
+
+
+
+
+// ==========================================================================
+DiffRecordWriter::Summary XmlDifferences::summary() const
+{
+   DiffRecordWriter::Summary counts;
+   counts.elements = totalElemCompared;
+   counts.tagDiffs = totalDifferentTypeElem;
+   counts.extraElements1 = extraElemFile1;
+   counts.extraElements2 = extraElemFile2;
+   counts.attributeNameDiffs = elemWithAttribNameDiff;
+   counts.attributeValueDiffs = elemWithAttribValueDiff;
+   counts.contentDiffs = elemWithTextDiff;
+   counts.numberDiffs = totalTagNumbContentDiff;
+   counts.textDiffs = totalTagTextContentDiff;
+   counts.total = Total();
+   counts.deleted = elemDeleted;
+   counts.inserted = elemInserted;
+   return counts;
+}
+
+
+
+
+// ==========================================================================
+void XmlDifferences::write(std::ostream& os, const DiffRecordWriter* records) const
+{
+   if (records)
+      records->summary(os, summary());
+   else
+      os << *this;
+}
+
+
+
+
+// ==========================================================================
+std::ostream& operator<<(std::ostream &os, const XmlDifferences& p)
+{
+   os << "Total number of elements compared:        " << p.totalElemCompared << endl;
+   if (p.extraElemFile1)
+      os << "Extra elements in file 1: " << p.extraElemFile1 << endl;
+   if (p.extraElemFile2)
+      os << "Extra elements in file 2: " << p.extraElemFile2 << endl;
+   if (p.elemDeleted)
+      os << "Elements only in file 1 (deleted):        " << p.elemDeleted << endl;
+   if (p.elemInserted)
+      os << "Elements only in file 2 (inserted):       " << p.elemInserted << endl;
+   os << "Number of tags with name differences:     " << p.totalDifferentTypeElem << endl;
+   os << "# of tags with an attribute name diff:    " << p.elemWithAttribNameDiff << endl;
+   os << "# of tags with an attribute value diff:   " << p.elemWithAttribValueDiff << endl;
+   os << "Total # of tags with content differences: " << p.elemWithTextDiff << endl;
+   os << "Total # of content diffs [as numbers]:    " << p.totalTagNumbContentDiff << endl;
+   os << "Total # of content diffs [as text]:       " << p.totalTagTextContentDiff << endl;
+   os << "Total differences:                        " << p.Total() << endl;
+   return os;
+}
@@ -0,0 +1,77 @@
+/**
+ *
+ * @file XmlDocumentPool.cpp
+ * @brief This file contains the member function definitions for class XmlDocumentPool
+ */
+
+#include "XmlDocumentPool.h"
+
+using namespace tinyxml2;
+using namespace std;
+
+
+// ==========================================================================
+XmlDocumentPool::XmlDocumentPool()
+   : mLock()
+   , mFree()
+{
+}
+
+
+
+
+// ==========================================================================
+XmlDocumentPool::~XmlDocumentPool()
+{
+   for (size_t i = 0; i < mFree.size(); ++i)
+      delete mFree[i];
+}
+
+
+
+
+// ==========================================================================
+XMLDocument* XmlDocumentPool::take()
+{
+   lock_guard<mutex> guard(mLock);
+   if (mFree.empty())
+      return new XMLDocument();
+   XMLDocument* doc = mFree.back();
+   mFree.pop_back();
+   return doc;
+}
+
+
+
+
+// ==========================================================================
+void XmlDocumentPool::give(XMLDocument* doc)
+{
+   doc->Clear();
+   lock_guard<mutex> guard(mLock);
+   mFree.push_back(doc);
+}
+
+
+
+
+// ==========================================================================
+void XmlDocumentPool::addMemPoolStats(MU_RunStats& stats)
+{
+   lock_guard<mutex> guard(mLock);
+   for (size_t i = 0; i < mFree.size(); ++i)
+      addMemPoolStats(stats, *mFree[i]);
+}
+
+
+
+
+// ==========================================================================
+// static
+void XmlDocumentPool::addMemPoolStats(MU_RunStats& stats, const XMLDocument& doc)
+{
+   MemPoolStats pools[MEMPOOL_COUNT];
+   doc.GetMemPoolStats(pools);
+   for (int i = 0; i < MEMPOOL_COUNT; ++i)
+      stats.addPool(pools[i].name, pools[i].itemSize, pools[i].watermark, pools[i].blocks, pools[i].blockItems, pools[i].allocs);
+}
@@ -6,17 +6,33 @@
  */
 
 
+#include <algorithm>
+#include <ctype.h>
+
 #include "XmlFilter.h"
 #include "MU_StringUtil.h"
 
 using namespace std;
 
 
+namespace
+{
+   // the name in lower case, folded the same way as XmlAttributeView::compareNoCase()
+   std::string FoldName(const std::string& aName)
+   {
+      std::string folded(aName);
+      for (size_t i = 0; i < folded.size(); ++i)
+         folded[i] = static_cast<char>(tolower(static_cast<unsigned char>(folded[i])));
+      return folded;
+   }
+}
+
+
 // ==========================================================================
 XmlFilter::XmlFilter(bool aCaseSensitive)
 : mTagName()
 , mAttributes()
-, mAttributesLC()
+, mFolded()
 , mCaseSensitive(aCaseSensitive)
 {
 }
@@ -28,7 +44,7 @@ XmlFilter::XmlFilter(bool aCaseSensitive)
 XmlFilter::XmlFilter(const XMLElement* aElem, bool aCaseSensitive)
 : mTagName()
 , mAttributes()
-, mAttributesLC()
+, mFolded()
 , mCaseSensitive(aCaseSensitive)
 {
    if (aElem)
@@ -37,19 +53,47 @@ XmlFilter::XmlFilter(const XMLElement* aElem, bool aCaseSensitive)
       const XMLAttribute* attrib = aElem->FirstAttribute();
       while (attrib)
       {
-         std::string name = attrib->Name();
-         std::string value = attrib->Value();
-         mAttributes[name] = value;
-         mAttributesLC[name] = value;
+         // an attribute given again replaces the earlier one.  without case, names
+         // that differ only in case are the same attribute
+         for (size_t i = 0; i < mAttributes.size(); ++i)
+         {
+            if (mAttributes[i].name == attrib->Name())
+               mAttributes[i].hiddenCase = true;
+            if (XmlAttributeView::equalNoCase(mAttributes[i].name.c_str(), attrib->Name()))
+               mAttributes[i].hiddenNoCase = true;
+         }
+         mAttributes.push_back(Attribute(attrib->Name(), attrib->Value()));
 
          attrib = attrib->Next();
       }
+      std::stable_sort(mAttributes.begin(), mAttributes.end(), lessName);
+      buildFolded();
    }
 }
 
 
 
 
+// ==========================================================================
+// static
+bool XmlFilter::lessName(const Attribute& a, const Attribute& b)
+{
+   return a.name < b.name;
+}
+
+
+
+
+// ==========================================================================
+// static
+bool XmlFilter::lessFolded(const FoldedName& a, const FoldedName& b)
+{
+   return a.folded < b.folded;
+}
+
+
+
+
 // ==========================================================================
 XmlFilter::~XmlFilter()
 {
@@ -63,7 +107,7 @@ XmlFilter::~XmlFilter()
 XmlFilter::XmlFilter( const XmlFilter& p )
 : mTagName(p.mTagName)
 , mAttributes(p.mAttributes)
-, mAttributesLC(p.mAttributesLC)
+, mFolded(p.mFolded)
 , mCaseSensitive(p.mCaseSensitive)
 {
 }
@@ -83,7 +127,7 @@ XmlFilter& XmlFilter::operator = ( const XmlFilter& p )
       // now copy contents
       mTagName       = p.mTagName;
       mAttributes    = p.mAttributes;
-      mAttributesLC  = p.mAttributesLC;
+      mFolded        = p.mFolded;
       mCaseSensitive = p.mCaseSensitive;
    }
 
@@ -99,9 +143,10 @@ void XmlFilter::show( std::ostream& stream ) const
    stream << "class XmlFilter" << endl;
    stream << "  TagName: " << mTagName << endl;
    stream << "  Case: " << (mCaseSensitive ? "true" : "false") << endl;
-   for (mapCaseSen_t::const_iterator a_it = mAttributes.begin(); a_it != mAttributes.end(); ++a_it)
+   for (size_t i = 0; i < mAttributes.size(); ++i)
    {
-      stream << "  attrib: " << a_it->first << "," << a_it->second << endl;
+      if (!mAttributes[i].hiddenCase)
+         stream << "  attrib: " << mAttributes[i].name << "," << mAttributes[i].value << endl;
    }
 }
 
@@ -135,27 +180,127 @@ void XmlFilter::destroy()
 bool XmlFilter::matchAttrib(const std::string& attribName, const std::string& attribValue) const
 {
    //cout << "XmlFilter::match on " << attribName << "=" << attribValue << endl;
-   bool retFlag = false;
-   mapCaseSen_t::const_iterator a_it = mAttributes.find(attribName);
-   if (a_it != mAttributes.end())
+   const Attribute* a = findExact(attribName);
+   if (!a)
+      return false;
+   //cout << "   found attribName, checking for value '" << a->value << "'=='" << attribValue << "'" << endl;
+   return (mCaseSensitive ? a->value == attribValue : MU_StringUtil::Strcasecmp(a->value, attribValue));
+}
+
+
+
+
+// ==========================================================================
+const std::string* XmlFilter::findValue(const char* aName) const
+{
+   // the element attribute name is matched as if lower cased (an upper case
+   // filter name never matches when case sensitive)
+   if (mCaseSensitive)
+   {
+      const Attribute* a = findLowered(aName);
+      return (a ? &a->value : 0);
+   }
+
+   const FoldedName* f = findFolded(aName);
+   return (f ? &mAttributes[f->noCase].value : 0);
+}
+
+
+
+
+// ==========================================================================
+const XmlFilter::Attribute* XmlFilter::findLowered(const char* aName) const
+{
+   const FoldedName* f = findFolded(aName);
+   return (f && f->lowered >= 0 ? &mAttributes[f->lowered] : 0);
+}
+
+
+
+
+// ==========================================================================
+const XmlFilter::FoldedName* XmlFilter::findFolded(const char* aName) const
+{
+   // compareNoCase() lowers aName as it goes; the folded names are lower case already
+   size_t first = 0;
+   size_t last = mFolded.size();
+   while (first < last)
    {
-      //cout << "   found attribName, checking for value '" << a_it->second << "'=='" << attribValue << "'" << endl;
-      retFlag = (mCaseSensitive ? a_it->second == attribValue : MU_StringUtil::Strcasecmp(a_it->second, attribValue));
+      const size_t middle = first + (last - first) / 2;
+      const int order = XmlAttributeView::compareNoCase(aName, mFolded[middle].folded.c_str());
+      if (order == 0)
+         return &mFolded[middle];
+      if (order < 0)
+         last = middle;
+      else
+         first = middle + 1;
    }
+   return 0;
+}
 
-   return retFlag;
+
+
+
+// ==========================================================================
+const XmlFilter::Attribute* XmlFilter::findExact(const std::string& aName) const
+{
+   // first attribute not before aName; an attribute given more than once is there
+   // several times in a row and only the last of them is used
+   size_t first = 0;
+   size_t last = mAttributes.size();
+   while (first < last)
+   {
+      const size_t middle = first + (last - first) / 2;
+      if (mAttributes[middle].name < aName)
+         first = middle + 1;
+      else
+         last = middle;
+   }
+   for (; first < mAttributes.size() && mAttributes[first].name == aName; ++first)
+   {
+      if (!mAttributes[first].hiddenCase)
+         return &mAttributes[first];
+   }
+   return 0;
 }
 
 
 
 
 // ==========================================================================
-bool XmlFilter::matchAnyAttrib(const std::map<std::string, std::string>& attribs) const
+void XmlFilter::buildFolded()
 {
-   for (std::map<std::string, std::string>::const_iterator a_it = attribs.begin();
-      a_it != attribs.end(); ++a_it)
+   mFolded.clear();
+   for (size_t i = 0; i < mAttributes.size(); ++i)
    {
-      if (matchAttrib(a_it->first, a_it->second))
+      const Attribute& a = mAttributes[i];
+      const std::string folded = FoldName(a.name);
+      size_t f = 0;
+      while (f < mFolded.size() && mFolded[f].folded != folded)
+         ++f;
+      if (f == mFolded.size())
+         mFolded.push_back(FoldedName(folded));
+
+      // of the names that are the same without case, only the last one given is not hidden
+      if (!a.hiddenNoCase)
+         mFolded[f].noCase = static_cast<int>(i);
+      if (!a.hiddenCase && a.name == folded)
+         mFolded[f].lowered = static_cast<int>(i);
+   }
+   std::sort(mFolded.begin(), mFolded.end(), lessFolded);
+}
+
+
+
+
+// ==========================================================================
+bool XmlFilter::matchAnyAttrib(const XmlAttributeView& attribs) const
+{
+   for (size_t i = 0; i < attribs.size(); ++i)
+   {
+      // same as matchAttrib() with the lower case name
+      const Attribute* a = findLowered(attribs[i].name);
+      if (a && (mCaseSensitive ? a->value == attribs[i].value : MU_StringUtil::Strcasecmp(attribs[i].value, a->value)))
          return true;
    }
    return false;
@@ -165,38 +310,20 @@ bool XmlFilter::matchAnyAttrib(const std::map<std::string, std::string>& attribs
 
 
 // ==========================================================================
-bool XmlFilter::matchAllAttrib(const std::map<std::string, std::string>& attribs) const
+bool XmlFilter::matchAllAttrib(const XmlAttributeView& attribs) const
 {
    // loop through all attributes in the filter list and see if they match against
    // attributes in the incoming list.  Every attribute in filter must find a match
    //in incoming list in order for this function to return true
-   for (std::map<std::string, std::string>::const_iterator a_it = attribs.begin();
-      a_it != attribs.end(); ++a_it)
+   for (size_t i = 0; i < attribs.size(); ++i)
    {
-      if (mCaseSensitive)
+      const std::string* filterValue = findValue(attribs[i].name);
+      if (filterValue)
       {
-         mapCaseSen_t::const_iterator filter_it = mAttributes.find(a_it->first);
-         if (filter_it != mAttributes.end())
-         {
-            //cout << "case sensitive found match " << a_it->first << " = " << filter_it->first << endl;
-            if (a_it->second != filter_it->second)
-               return false;
-         }
-      }
-      else
-      {
-         mapCaseInsen_t::const_iterator filter_it = mAttributesLC.find(a_it->first);
-         if (filter_it != mAttributesLC.end())
-         {
-            //cout << "case INsensitive found match " << a_it->first << " = " << filter_it->first << endl;
-            if (!MU_StringUtil::Strcasecmp(a_it->second, filter_it->second))
-               return false;
-         }
+         if (mCaseSensitive ? *filterValue != attribs[i].value : !MU_StringUtil::Strcasecmp(attribs[i].value, *filterValue))
+            return false;
       }
    }
 
-
-
    return true;
 }
-
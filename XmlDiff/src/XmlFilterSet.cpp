@@ -0,0 +1,147 @@
+/**
+ *
+ * @file XmlFilterSet.cpp
+ * @brief This file contains the member function definitions for class XmlFilterSet
+ */
+
+#include <ctype.h>
+
+#include "XmlFilterSet.h"
+#include "MU_Hash.h"
+
+using namespace std;
+
+
+// ==========================================================================
+XmlFilterSet::XmlFilterSet()
+   : mFilters()
+   , mGroups()
+   , mSlots()
+{
+}
+
+
+
+
+// ==========================================================================
+void XmlFilterSet::add(const XmlFilter& aFilter)
+{
+   mFilters.push_back(aFilter);
+   const size_t index = mFilters.size() - 1;
+
+   const char* tag = aFilter.TagName().c_str();
+   size_t g = findGroup(tag);
+   if (g == mGroups.size())
+   {
+      mGroups.push_back(TagGroup());
+      TagGroup& group = mGroups.back();
+      group.hash = hashLower(tag);
+      for (const char* p = tag; *p; ++p)
+         group.lowerTag += static_cast<char>(tolower(static_cast<unsigned char>(*p)));
+
+      // keep the table no more than half full
+      if (2 * mGroups.size() > mSlots.size())
+         rehash(mSlots.empty() ? 16 : 2 * mSlots.size());
+      else
+         insertSlot(g);
+   }
+   mGroups[g].filters.push_back(index);
+}
+
+
+
+
+// ==========================================================================
+void XmlFilterSet::caseSensitive(bool aFlag)
+{
+   for (size_t i = 0; i < mFilters.size(); ++i)
+      mFilters[i].caseSensitive(aFlag);
+}
+
+
+
+
+// ==========================================================================
+bool XmlFilterSet::match(const char* aTag, const XmlAttributeView& attribs) const
+{
+   if (mFilters.empty())
+      return false;
+
+   // the group has every filter whose tag is the same without case; each filter
+   // still checks the tag with its own case sensitivity
+   size_t g = findGroup(aTag);
+   if (g == mGroups.size())
+      return false;
+
+   const vector<size_t>& filters = mGroups[g].filters;
+   for (size_t i = 0; i < filters.size(); ++i)
+   {
+      if (mFilters[filters[i]].match(aTag, attribs))
+         return true;
+   }
+   return false;
+}
+
+
+
+
+// ==========================================================================
+void XmlFilterSet::show(std::ostream& stream) const
+{
+   for (size_t i = 0; i < mFilters.size(); ++i)
+      stream << mFilters[i];
+}
+
+
+
+
+// ==========================================================================
+// static
+unsigned long long XmlFilterSet::hashLower(const char* p)
+{
+   return MU_Hash::AddLower(MU_Hash::Start, p);
+}
+
+
+
+
+// ==========================================================================
+size_t XmlFilterSet::findGroup(const char* aTag) const
+{
+   if (mSlots.empty())
+      return mGroups.size();
+
+   const unsigned long long hash = hashLower(aTag);
+   const size_t mask = mSlots.size() - 1;
+   for (size_t i = static_cast<size_t>(hash) & mask; mSlots[i] != 0; i = (i + 1) & mask)
+   {
+      const TagGroup& group = mGroups[mSlots[i] - 1];
+      if (group.hash == hash && XmlAttributeView::equalLowered(aTag, group.lowerTag.c_str()))
+         return mSlots[i] - 1;
+   }
+   return mGroups.size();
+}
+
+
+
+
+// ==========================================================================
+void XmlFilterSet::rehash(size_t nSlots)
+{
+   mSlots.assign(nSlots, 0);
+   for (size_t g = 0; g < mGroups.size(); ++g)
+      insertSlot(g);
+}
+
+
+
+
+// ==========================================================================
+void XmlFilterSet::insertSlot(size_t g)
+{
+   const size_t mask = mSlots.size() - 1;
+   size_t i = static_cast<size_t>(mGroups[g].hash) & mask;
+   while (mSlots[i] != 0)
+      i = (i + 1) & mask;
+   mSlots[i] = g + 1;
+}
@@ -0,0 +1,173 @@
+/**
+ *
+ * @file XmlFingerprint.cpp
+ * @brief This file contains the member function definitions for class XmlFingerprint
+ */
+
+#include <ctype.h>
+#include <string.h>
+
+#include "XmlFingerprint.h"
+#include "MU_Hash.h"
+
+using namespace tinyxml2;
+
+
+namespace
+{
+   // number of elements from elem on, including siblings and children
+   size_t CountElements(const XMLElement* elem)
+   {
+      size_t count = 0;
+      for (; elem; elem = elem->NextSiblingElement())
+         count += 1 + CountElements(elem->FirstChildElement());
+      return count;
+   }
+}
+
+
+
+
+// ==========================================================================
+XmlFingerprint::XmlFingerprint(const MU_CharSet& aDelimiters, bool aCaseSensitive, AttributeTest aIsDesired)
+   : mDelimiters(aDelimiters)
+   , mCaseSensitive(aCaseSensitive)
+   , mIsDesired(aIsDesired)
+   , mEntries()
+{
+}
+
+
+
+
+// ==========================================================================
+void XmlFingerprint::compute(XMLDocument* doc)
+{
+   // the elements point into mEntries, so it must never grow past this
+   mEntries.clear();
+   mEntries.reserve(CountElements(doc->FirstChildElement()));
+
+   for (XMLElement* elem = doc->FirstChildElement(); elem; elem = elem->NextSiblingElement())
+      computeSubtree(elem);
+}
+
+
+
+
+// ==========================================================================
+bool XmlFingerprint::attach(XMLDocument* doc, std::vector<Entry>& entries)
+{
+   if (entries.size() != CountElements(doc->FirstChildElement()))
+      return false;
+
+   mEntries.swap(entries);
+   entries.clear();
+   size_t next = 0;
+   for (XMLElement* elem = doc->FirstChildElement(); elem; elem = elem->NextSiblingElement())
+   {
+      if (!attachSubtree(elem, next))
+         return false;
+   }
+   return true;
+}
+
+
+
+
+// ==========================================================================
+const XmlFingerprint::Entry& XmlFingerprint::computeSubtree(XMLElement* elem)
+{
+   unsigned long long hash = hashElement(elem);
+   unsigned int elements = 1;
+   for (XMLElement* child = elem->FirstChildElement(); child; child = child->NextSiblingElement())
+   {
+      const Entry& childEntry = computeSubtree(child);
+      hash = MU_Hash::Mix(hash ^ childEntry.hash);   // in order, so swapped children differ
+      elements += childEntry.elements;
+   }
+
+   mEntries.push_back(Entry(hash, elements));
+   elem->SetUserData(&mEntries.back());
+   return mEntries.back();
+}
+
+
+
+
+// ==========================================================================
+bool XmlFingerprint::attachSubtree(XMLElement* elem, size_t& next)
+{
+   const size_t first = next;
+   for (XMLElement* child = elem->FirstChildElement(); child; child = child->NextSiblingElement())
+   {
+      if (!attachSubtree(child, next))
+         return false;
+   }
+
+   // the subtree is this element and the entries of its children
+   Entry& entry = mEntries[next++];
+   if (entry.elements != next - first)
+      return false;
+   elem->SetUserData(&entry);
+   return true;
+}
+
+
+
+
+// ==========================================================================
+unsigned long long XmlFingerprint::hashElement(const XMLElement* elem) const
+{
+   // a marker byte starts each part so tag, attributes and text cannot be mistaken for each other
+   const char* tag = elem->Value();
+   unsigned long long hash = hashChars(MU_Hash::AddByte(MU_Hash::Start, '<'), tag, strlen(tag));
+
+   for (const XMLAttribute* attrib = elem->FirstAttribute(); attrib; attrib = attrib->Next())
+   {
+      const char* name = attrib->Name();
+      if (mIsDesired(name))
+      {
+         hash = hashChars(MU_Hash::AddByte(hash, '@'), name, strlen(name));
+         hash = hashTokens(MU_Hash::AddByte(hash, '='), attrib->Value());
+      }
+   }
+
+   // the comparison only looks at the text before the first child
+   const char* text = elem->GetText();
+   if (text)
+      hash = hashTokens(MU_Hash::AddByte(hash, '>'), text);
+
+   return hash;
+}
+
+
+
+
+// ==========================================================================
+unsigned long long XmlFingerprint::hashTokens(unsigned long long hash, const char* text) const
+{
+   // a 0 after each token, which no token can hold, keeps "a b" apart from "ab"
+   MU_Tokenizer tokens(text, mDelimiters);
+   MU_StringView token;
+   while (tokens.next(token))
+      hash = MU_Hash::AddByte(hashChars(hash, token.data(), token.size()), 0);
+   return hash;
+}
+
+
+
+
+// ==========================================================================
+unsigned long long XmlFingerprint::hashChars(unsigned long long hash, const char* p, size_t n) const
+{
+   if (mCaseSensitive)
+   {
+      hash = MU_Hash::AddChars(hash, p, n);
+   }
+   else
+   {
+      for (size_t i = 0; i < n; ++i)
+         hash = MU_Hash::AddByte(hash, static_cast<unsigned char>(tolower(static_cast<unsigned char>(p[i]))));
+   }
+   return hash;
+}
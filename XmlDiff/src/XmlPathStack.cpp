@@ -0,0 +1,121 @@
+/**
+ *
+ * @file XmlPathStack.cpp
+ * @brief This file contains the member function definitions for class XmlPathStack
+ */
+
+#include <string.h>
+
+#include "XmlPathStack.h"
+#include "MU_Hash.h"
+
+using namespace std;
+
+
+// ==========================================================================
+XmlPathStack::XmlPathStack()
+   : mNames()
+   , mHashes()
+   , mSlots()
+   , mIds()
+   , mChanges(0)
+   , mText()
+   , mTextEnd()
+{
+}
+
+
+
+
+// ==========================================================================
+void XmlPathStack::push(const char* aName)
+{
+   mIds.push_back(intern(aName));
+   ++mChanges;
+}
+
+
+
+
+// ==========================================================================
+void XmlPathStack::pop()
+{
+   mIds.pop_back();
+   ++mChanges;
+
+   // the text of the level removed is no good, another name may be pushed in its place
+   if (mTextEnd.size() > mIds.size())
+      mTextEnd.pop_back();
+}
+
+
+
+
+// ==========================================================================
+const std::string& XmlPathStack::text() const
+{
+   // the levels still in mTextEnd are the same as when the text was made
+   mText.resize(mTextEnd.empty() ? 0 : mTextEnd.back());
+   for (size_t i = mTextEnd.size(); i < mIds.size(); ++i)
+   {
+      if (i > 0)
+         mText += '.';
+      mText += mNames[mIds[i]];
+      mTextEnd.push_back(mText.size());
+   }
+   return mText;
+}
+
+
+
+
+// ==========================================================================
+unsigned int XmlPathStack::intern(const char* aName)
+{
+   const unsigned long long hash = MU_Hash::String(aName);
+   if (!mSlots.empty())
+   {
+      const size_t mask = mSlots.size() - 1;
+      for (size_t i = static_cast<size_t>(hash) & mask; mSlots[i] != 0; i = (i + 1) & mask)
+      {
+         const unsigned int id = mSlots[i] - 1;
+         if (mHashes[id] == hash && strcmp(mNames[id].c_str(), aName) == 0)
+            return id;
+      }
+   }
+
+   const unsigned int id = static_cast<unsigned int>(mNames.size());
+   mNames.push_back(aName);
+   mHashes.push_back(hash);
+
+   // keep the table no more than half full
+   if (2 * mNames.size() > mSlots.size())
+      rehash(mSlots.empty() ? 64 : 2 * mSlots.size());
+   else
+      insertSlot(id);
+   return id;
+}
+
+
+
+
+// ==========================================================================
+void XmlPathStack::rehash(size_t nSlots)
+{
+   mSlots.assign(nSlots, 0);
+   for (unsigned int id = 0; id < mNames.size(); ++id)
+      insertSlot(id);
+}
+
+
+
+
+// ==========================================================================
+void XmlPathStack::insertSlot(unsigned int id)
+{
+   const size_t mask = mSlots.size() - 1;
+   size_t i = static_cast<size_t>(mHashes[id]) & mask;
+   while (mSlots[i] != 0)
+      i = (i + 1) & mask;
+   mSlots[i] = id + 1;
+}
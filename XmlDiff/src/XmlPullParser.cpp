@@ -0,0 +1,511 @@
+
+
+/**
+ *
+ * @file XmlPullParser.cpp
+ * @brief This file contains the member function definitions for class XmlPullParser
+ */
+
+#include <cstring>
+
+#include "XmlPullParser.h"
+
+using namespace std;
+
+
+// ==========================================================================
+XmlPullParser::XmlPullParser(size_t aChunkSize)
+   : mFile(0)
+   , mChunkSize(aChunkSize > 16 ? aChunkSize : 16)
+   , mBuffer(1, 0)
+   , mPos(0)
+   , mEnd(0)
+   , mEof(true)
+   , mStarted(false)
+   , mEvent(END_DOCUMENT)
+   , mUnread(false)
+   , mPendingEnd(false)
+   , mFirstChild(false)
+   , mHasChild()
+   , mOpenTags()
+   , mName()
+   , mAttribCount(0)
+   , mAttribNames()
+   , mAttribValues()
+   , mText()
+   , mDecoder()
+   , mErrorID(XML_NO_ERROR)
+{
+}
+
+
+
+
+// ==========================================================================
+XmlPullParser::~XmlPullParser()
+{
+   close();
+}
+
+
+
+
+// ==========================================================================
+bool XmlPullParser::open(const char* filename)
+{
+   close();
+   mPos = mEnd = 0;
+   mBuffer[0] = 0;
+   mStarted = false;
+   mUnread = false;
+   mPendingEnd = false;
+   mHasChild.clear();
+   mOpenTags.clear();
+   mErrorID = XML_NO_ERROR;
+   mEvent = END_DOCUMENT;
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1400 )
+   if (fopen_s(&mFile, filename, "rb") != 0)
+      mFile = 0;
+#else
+   mFile = fopen(filename, "rb");
+#endif
+   if (!mFile)
+   {
+      setError(XML_ERROR_FILE_NOT_FOUND);
+      return true;
+   }
+   mEof = false;
+
+   // same as XMLDocument: a file with nothing but white space is an error
+   size_t k = 0;
+   for (;;)
+   {
+      if (mPos + k >= mEnd && !fill())
+      {
+         setError(mErrorID == XML_NO_ERROR ? XML_ERROR_EMPTY_DOCUMENT : mErrorID);
+         return true;
+      }
+      if (!XMLUtil::IsWhiteSpace(mBuffer[mPos + k]))
+         break;
+      ++k;
+   }
+   return false;
+}
+
+
+
+
+// ==========================================================================
+void XmlPullParser::close()
+{
+   if (mFile)
+   {
+      fclose(mFile);
+      mFile = 0;
+   }
+   mEof = true;
+}
+
+
+
+
+// ==========================================================================
+const char* XmlPullParser::errorName() const
+{
+   switch (mErrorID)
+   {
+   case XML_NO_ERROR:                  return "XML_NO_ERROR";
+   case XML_ERROR_FILE_NOT_FOUND:      return "XML_ERROR_FILE_NOT_FOUND";
+   case XML_ERROR_FILE_READ_ERROR:     return "XML_ERROR_FILE_READ_ERROR";
+   case XML_ERROR_PARSING_ELEMENT:     return "XML_ERROR_PARSING_ELEMENT";
+   case XML_ERROR_PARSING_ATTRIBUTE:   return "XML_ERROR_PARSING_ATTRIBUTE";
+   case XML_ERROR_PARSING_TEXT:        return "XML_ERROR_PARSING_TEXT";
+   case XML_ERROR_PARSING_CDATA:       return "XML_ERROR_PARSING_CDATA";
+   case XML_ERROR_PARSING_COMMENT:     return "XML_ERROR_PARSING_COMMENT";
+   case XML_ERROR_PARSING_DECLARATION: return "XML_ERROR_PARSING_DECLARATION";
+   case XML_ERROR_PARSING_UNKNOWN:     return "XML_ERROR_PARSING_UNKNOWN";
+   case XML_ERROR_EMPTY_DOCUMENT:      return "XML_ERROR_EMPTY_DOCUMENT";
+   case XML_ERROR_MISMATCHED_ELEMENT:  return "XML_ERROR_MISMATCHED_ELEMENT";
+   default:                            return "XML_ERROR_PARSING";
+   }
+}
+
+
+
+
+// ==========================================================================
+XmlPullParser::Event XmlPullParser::setError(XMLError err)
+{
+   mErrorID = err;
+   mEvent = PARSE_ERROR;
+   close();
+   return mEvent;
+}
+
+
+
+
+// ==========================================================================
+bool XmlPullParser::fill()
+{
+   if (mEof || !mFile)
+      return false;
+
+   // drop what has been parsed already, keeping everything from mPos on
+   if (mPos > 0)
+   {
+      memmove(&mBuffer[0], &mBuffer[mPos], mEnd - mPos);
+      mEnd -= mPos;
+      mPos = 0;
+   }
+   if (mBuffer.size() < mEnd + mChunkSize + 1)
+      mBuffer.resize(mEnd + mChunkSize + 1);
+
+   size_t n = fread(&mBuffer[mEnd], 1, mChunkSize, mFile);
+   mEnd += n;
+   mBuffer[mEnd] = 0;
+   if (n < mChunkSize)
+   {
+      if (ferror(mFile))
+         mErrorID = XML_ERROR_FILE_READ_ERROR;
+      mEof = true;
+   }
+   return n > 0;
+}
+
+
+
+
+// ==========================================================================
+bool XmlPullParser::ensure(size_t n)
+{
+   while (mEnd - mPos < n)
+   {
+      if (!fill())
+         return false;
+   }
+   return true;
+}
+
+
+
+
+// ==========================================================================
+size_t XmlPullParser::find(size_t from, const char* pattern)
+{
+   const size_t len = strlen(pattern);
+   for (;;)
+   {
+      // offsets are relative to mPos since fill() can move the data
+      const char* base = &mBuffer[mPos];
+      const size_t avail = mEnd - mPos;
+      while (from + len <= avail)
+      {
+         const char* hit = static_cast<const char*>(memchr(base + from, pattern[0], avail - from - len + 1));
+         if (!hit)
+         {
+            from = avail - len + 1;
+            break;
+         }
+         if (memcmp(hit, pattern, len) == 0)
+            return hit - base;
+         from = hit - base + 1;
+      }
+      if (!fill())
+         return string::npos;
+   }
+}
+
+
+
+
+// ==========================================================================
+size_t XmlPullParser::findTagEnd(size_t from)
+{
+   char quote = 0;
+   size_t k = from;
+   for (;;)
+   {
+      if (mPos + k >= mEnd && !fill())
+         return string::npos;
+
+      const char c = mBuffer[mPos + k];
+      if (quote)
+      {
+         if (c == quote)
+            quote = 0;
+      }
+      else if (c == '"' || c == '\'')
+      {
+         quote = c;
+      }
+      else if (c == '>')
+      {
+         return k;
+      }
+      ++k;
+   }
+}
+
+
+
+
+// ==========================================================================
+void XmlPullParser::decode(std::string& s, int flags)
+{
+   // let tinyxml2 do the work so the result is exactly what the DOM would hold
+   char* start = &s[0];
+   mDecoder.Set(start, start + s.size(), flags);
+   const char* out = mDecoder.GetStr();
+   s.resize(strlen(out));
+}
+
+
+
+
+// ==========================================================================
+void XmlPullParser::addChildNode()
+{
+   if (mHasChild.empty())
+   {
+      mFirstChild = false;   // document level
+   }
+   else
+   {
+      mFirstChild = !mHasChild.back();
+      mHasChild.back() = true;
+   }
+}
+
+
+
+
+// ==========================================================================
+XmlPullParser::Event XmlPullParser::next()
+{
+   if (mUnread)
+   {
+      mUnread = false;
+      return mEvent;
+   }
+   if (mEvent == PARSE_ERROR || (mEvent == END_DOCUMENT && mEof && mStarted))
+      return mEvent;
+
+   mEvent = readEvent();
+   return mEvent;
+}
+
+
+
+
+// ==========================================================================
+XmlPullParser::Event XmlPullParser::readEvent()
+{
+   if (mPendingEnd)
+   {
+      // second half of an empty element <tag/>
+      mPendingEnd = false;
+      mName.swap(mOpenTags.back());
+      mOpenTags.pop_back();
+      mHasChild.pop_back();
+      return END_ELEMENT;
+   }
+
+   if (!mStarted)
+   {
+      mStarted = true;
+      size_t k = 0;
+      while ((mPos + k < mEnd || fill()) && XMLUtil::IsWhiteSpace(mBuffer[mPos + k]))
+         ++k;
+      mPos += k;
+      if (ensure(3) && (unsigned char)mBuffer[mPos] == 0xefU && (unsigned char)mBuffer[mPos + 1] == 0xbbU
+         && (unsigned char)mBuffer[mPos + 2] == 0xbfU)
+      {
+         mPos += 3;
+      }
+   }
+
+   for (;;)
+   {
+      // white space in front of markup is dropped, in front of text it is part of the text
+      size_t k = 0;
+      while ((mPos + k < mEnd || fill()) && XMLUtil::IsWhiteSpace(mBuffer[mPos + k]))
+         ++k;
+      if (mPos + k >= mEnd)
+      {
+         mPos += k;
+         if (mErrorID != XML_NO_ERROR)
+            return setError(mErrorID);
+         if (!mOpenTags.empty())
+            return setError(XML_ERROR_PARSING);   // file ended inside an element
+         close();
+         return END_DOCUMENT;
+      }
+
+      if (mBuffer[mPos + k] != '<')
+      {
+         size_t off = find(k, "<");
+         if (off == string::npos)
+            return setError(XML_ERROR_PARSING_TEXT);
+         mText.assign(&mBuffer[mPos], off);
+         decode(mText, StrPair::TEXT_ELEMENT);
+         mPos += off;
+         addChildNode();
+         return TEXT;
+      }
+
+      mPos += k;
+      ensure(9);
+      const char* p = &mBuffer[mPos];
+      if (strncmp(p, "<?", 2) == 0)
+      {
+         size_t off = find(2, "?>");
+         if (off == string::npos)
+            return setError(XML_ERROR_PARSING_DECLARATION);
+         mPos += off + 2;
+         addChildNode();
+      }
+      else if (strncmp(p, "<!--", 4) == 0)
+      {
+         size_t off = find(4, "-->");
+         if (off == string::npos)
+            return setError(XML_ERROR_PARSING_COMMENT);
+         mPos += off + 3;
+         addChildNode();
+      }
+      else if (strncmp(p, "<![CDATA[", 9) == 0)
+      {
+         size_t off = find(9, "]]>");
+         if (off == string::npos)
+            return setError(XML_ERROR_PARSING_CDATA);
+         mText.assign(&mBuffer[mPos + 9], off - 9);
+         decode(mText, StrPair::NEEDS_NEWLINE_NORMALIZATION);
+         mPos += off + 3;
+         addChildNode();
+         return TEXT;
+      }
+      else if (strncmp(p, "<!", 2) == 0)
+      {
+         size_t off = find(2, ">");
+         if (off == string::npos)
+            return setError(XML_ERROR_PARSING_UNKNOWN);
+         mPos += off + 1;
+         addChildNode();
+      }
+      else
+      {
+         size_t off = findTagEnd(1);
+         if (off == string::npos)
+            return setError(XML_ERROR_PARSING_ELEMENT);
+         const char* start = &mBuffer[mPos + 1];
+         const char* end = &mBuffer[mPos + off];
+         mPos += off + 1;
+         return parseTag(start, end);
+      }
+   }
+}
+
+
+
+
+// ==========================================================================
+XmlPullParser::Event XmlPullParser::parseTag(const char* p, const char* end)
+{
+   while (p < end && XMLUtil::IsWhiteSpace(*p))
+      ++p;
+   bool closing = false;
+   if (p < end && *p == '/')
+   {
+      closing = true;
+      ++p;
+   }
+
+   const char* nameStart = p;
+   if (p < end && XMLUtil::IsNameStartChar(*p))
+   {
+      ++p;
+      while (p < end && XMLUtil::IsNameChar(*p))
+         ++p;
+   }
+   if (p == nameStart)
+      return setError(XML_ERROR_PARSING_ELEMENT);
+   mName.assign(nameStart, p - nameStart);
+
+   // attributes, same rules as XMLElement::ParseAttributes()
+   bool sealed = false;
+   mAttribCount = 0;
+   for (;;)
+   {
+      while (p < end && XMLUtil::IsWhiteSpace(*p))
+         ++p;
+      if (p == end)
+         break;
+
+      if (XMLUtil::IsNameStartChar(*p))
+      {
+         const char* attrStart = p;
+         ++p;
+         while (p < end && XMLUtil::IsNameChar(*p))
+            ++p;
+         const char* attrEnd = p;
+         while (p < end && XMLUtil::IsWhiteSpace(*p))
+            ++p;
+         if (p == end || *p != '=')
+            return setError(XML_ERROR_PARSING_ATTRIBUTE);
+         ++p;
+         while (p < end && XMLUtil::IsWhiteSpace(*p))
+            ++p;
+         if (p == end || (*p != '"' && *p != '\''))
+            return setError(XML_ERROR_PARSING_ATTRIBUTE);
+         const char quote = *p++;
+         const char* valueStart = p;
+         while (p < end && *p != quote)
+            ++p;
+         if (p == end)
+            return setError(XML_ERROR_PARSING_ATTRIBUTE);
+
+         if (mAttribNames.size() <= mAttribCount)
+         {
+            mAttribNames.resize(mAttribCount + 1);
+            mAttribValues.resize(mAttribCount + 1);
+         }
+         string& attrName = mAttribNames[mAttribCount];
+         attrName.assign(attrStart, attrEnd - attrStart);
+         for (size_t i = 0; i < mAttribCount; ++i)
+         {
+            if (mAttribNames[i] == attrName)
+               return setError(XML_ERROR_PARSING_ATTRIBUTE);   // duplicate attribute
+         }
+         string& attrValue = mAttribValues[mAttribCount];
+         attrValue.assign(valueStart, p - valueStart);
+         decode(attrValue, StrPair::ATTRIBUTE_VALUE);
+         ++mAttribCount;
+         ++p;   // closing quote
+      }
+      else if (*p == '/' && p + 1 == end)
+      {
+         sealed = true;
+         break;
+      }
+      else
+      {
+         return setError(XML_ERROR_PARSING_ELEMENT);
+      }
+   }
+
+   if (closing)
+   {
+      if (mOpenTags.empty() || mOpenTags.back() != mName)
+         return setError(XML_ERROR_MISMATCHED_ELEMENT);
+      mOpenTags.pop_back();
+      mHasChild.pop_back();
+      return END_ELEMENT;
+   }
+
+   addChildNode();
+   mOpenTags.push_back(mName);
+   mHasChild.push_back(false);
+   mPendingEnd = sealed;
+   return START_ELEMENT;
+}
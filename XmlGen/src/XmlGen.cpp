@@ -0,0 +1,614 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "MU_Hash.h"
+#include "MU_StringUtil.h"
+
+using namespace std;
+
+
+/**
+ * @file XmlGen.cpp
+ *
+ * Writes a synthetic XML file for performance testing, and optionally a
+ * "candidate" twin of it with a known rate of differences.  The files look
+ * like the ones XmlDiff is used on: groups of groups, each element keyed by a
+ * name attribute, and leaf elements holding arrays of numbers or a little
+ * text.  The shape is set by the options, and the same seed always gives the
+ * same files, so a workload of any size can be made again on any machine.
+ *
+ * The candidate has the same elements with some of the leaves changed:
+ * numbers moved by less than --delta (which xmldiff does not count) or by more,
+ * words and type attributes changed, elements inserted and neighbouring
+ * elements swapped.  What was changed is counted and printed at the end.
+ *
+ * The files are written as they are made, so memory use does not depend on
+ * their size.
+ *
+ * Usage: XmlGen [options] <file> [candidate file]
+ */
+
+
+
+/**
+ * @class GenRandom
+ * @brief a small random number generator (splitmix64) that gives the same numbers everywhere
+ *
+ * rand() and the standard distributions may differ between libraries, which
+ * would make different files from the same seed.
+ */
+class GenRandom
+{
+public:
+   GenRandom(unsigned long long aSeed) : mState(aSeed) {}
+
+   //! the next 64 random bits
+   unsigned long long next()
+   {
+      mState += 0x9E3779B97F4A7C15ULL;
+      return MU_Hash::Mix(mState);
+   }
+
+   //! a number in [0,1)
+   double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+   //! a number in [0,n)
+   unsigned int below(unsigned int n) { return n ? static_cast<unsigned int>(next() % n) : 0; }
+
+   //! true with probability p
+   bool chance(double p) { return uniform() < p; }
+
+private:
+   unsigned long long mState;
+};
+
+
+
+
+/**
+ * @class GenSettings
+ * @brief the shape of the files to write, from the command line
+ */
+class GenSettings
+{
+public:
+   GenSettings() : seed(1), depth(2), fanout(5), groups(100), size(0), attribs(1), keyed(1.0), numbers(0.8),
+      arraySize(8), textSize(40), diffRate(0.01), insertRate(0.0), reorderRate(0.0), delta(1.0e-7) {}
+
+   unsigned long long seed;
+   unsigned int depth;              //!< levels of groups, the leaves are below the last one
+   unsigned int fanout;             //!< child elements of each group
+   unsigned int groups;             //!< groups at the top level (if size is 0)
+   unsigned long long size;         //!< write top level groups until the file is this big, 0 to use groups
+   unsigned int attribs;            //!< attributes of each element besides name and type
+   double keyed;                    //!< fraction of the elements with a name attribute
+   double numbers;                  //!< fraction of the leaves holding numbers instead of text
+   unsigned int arraySize;          //!< numbers in each leaf holding numbers
+   unsigned int textSize;           //!< characters of text in each leaf holding text
+   double diffRate;                 //!< fraction of the leaves changed in the candidate
+   double insertRate;               //!< fraction of the leaves followed by an extra one in the candidate
+   double reorderRate;              //!< fraction of the leaves swapped with the next one in the candidate
+   double delta;                    //!< xmldiff --delta, the jitter of the numbers is made around it
+};
+
+
+
+
+/**
+ * @class GenCounts
+ * @brief what the generator wrote and changed
+ */
+class GenCounts
+{
+public:
+   GenCounts() : elements(0), leaves(0), jitterWithin(0), jitterBeyond(0), words(0), attributes(0), inserted(0), swapped(0),
+      bytes1(0), bytes2(0) {}
+
+   unsigned long long elements;
+   unsigned long long leaves;
+   unsigned long long jitterWithin;    //!< numbers moved by less than delta, not differences to xmldiff
+   unsigned long long jitterBeyond;    //!< numbers moved by more than delta
+   unsigned long long words;           //!< words of text changed
+   unsigned long long attributes;      //!< type attributes changed
+   unsigned long long inserted;        //!< elements only in the candidate
+   unsigned long long swapped;         //!< pairs of leaves in the other order in the candidate
+   unsigned long long bytes1;
+   unsigned long long bytes2;
+};
+
+
+
+
+/**
+ * @class XmlGenerator
+ * @brief writes the file and its candidate twin
+ *
+ * The content of the elements comes from one random sequence and the changes
+ * made to the candidate from another, so the first file is the same whatever
+ * the rates of change.  Each group of leaves is made in memory (in strings
+ * that are reused) and then written to both files.
+ */
+class XmlGenerator
+{
+public:
+   XmlGenerator(const GenSettings& aSettings)
+      : mSettings(aSettings), mContent(aSettings.seed), mChange(MU_Hash::Mix(aSettings.seed ^ 0x5C0FFEEULL)),
+        mFile1(nullptr), mFile2(nullptr), mFailed(false), mOut1(), mOut2(), mLeaves1(), mLeaves2(), mCounts() {}
+
+   //! write the files.  file2 may be null for no candidate.  Returns true on a write error
+   bool write(FILE* file1, FILE* file2);
+
+   //! what was written and changed
+   const GenCounts& counts() const { return mCounts; }
+
+private:
+   XmlGenerator(const XmlGenerator&);             // not supported
+   void operator=(const XmlGenerator&);           // not supported
+
+   //! write a group and everything below it
+   void group(unsigned int level, unsigned int index);
+   //! make the leaves of a group at the last level into mLeaves1 and mLeaves2 and write them
+   void leaves(unsigned int level);
+   //! make one leaf for both files
+   void leaf(unsigned int level, unsigned int index, string& text1, string& text2);
+   //! the start tag of an element, up to the '>'.  The extra attributes are made here
+   void startTag(string& out, unsigned int level, const char* tag, const char* key, unsigned int index, const char* type);
+   //! write what is in the buffers if there is a lot of it (or all of it with 'all').  Returns true if a write has failed
+   bool flush(bool all);
+
+   const GenSettings& mSettings;
+   GenRandom mContent;              //!< the content of the elements
+   GenRandom mChange;               //!< the changes made to the candidate
+   FILE* mFile1;
+   FILE* mFile2;
+   bool mFailed;                    //!< a write failed
+   string mOut1;                    //!< waiting to be written to each file
+   string mOut2;
+   vector<string> mLeaves1;         //!< the leaves of a group, reused
+   vector<string> mLeaves2;
+   GenCounts mCounts;
+};
+
+
+
+
+//! append a number with enough digits that a change smaller than the delta still shows
+void appendNumber(string& out, double value)
+{
+   char buffer[40];
+   sprintf(buffer, "%.15g", value);
+   out += buffer;
+}
+
+
+
+
+//! append an unsigned number
+void appendUnsigned(string& out, unsigned long long value)
+{
+   char buffer[24];
+   sprintf(buffer, "%llu", value);
+   out += buffer;
+}
+
+
+
+
+bool XmlGenerator::write(FILE* file1, FILE* file2)
+{
+   mFile1 = file1;
+   mFile2 = file2;
+   const char* header = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<root>\n";
+   mOut1 = header;
+   mOut2 = header;
+   ++mCounts.elements;
+
+   for (unsigned int g = 0; mSettings.size > 0 ? mCounts.bytes1 + mOut1.size() < mSettings.size : g < mSettings.groups; ++g)
+   {
+      group(1, g);
+      if (flush(false))
+         return true;
+   }
+
+   mOut1 += "</root>\n";
+   mOut2 += "</root>\n";
+   return flush(true);
+}
+
+
+
+
+void XmlGenerator::group(unsigned int level, unsigned int index)
+{
+   ++mCounts.elements;
+   string start;
+   startTag(start, level, "group", "g", index, "grp");
+   start += ">\n";
+   mOut1 += start;
+   mOut2 += start;
+
+   if (level < mSettings.depth)
+   {
+      for (unsigned int i = 0; i < mSettings.fanout; ++i)
+         group(level + 1, i);
+   }
+   else
+   {
+      leaves(level + 1);
+   }
+
+   const string end = string(2 * level, ' ') + "</group>\n";
+   mOut1 += end;
+   mOut2 += end;
+   flush(false);
+}
+
+
+
+
+void XmlGenerator::leaves(unsigned int level)
+{
+   const unsigned int n = mSettings.fanout;
+   if (mLeaves1.size() < n)
+   {
+      mLeaves1.resize(n);
+      mLeaves2.resize(n);
+   }
+   for (unsigned int i = 0; i < n; ++i)
+      leaf(level, i, mLeaves1[i], mLeaves2[i]);
+
+   for (unsigned int i = 0; i < n; ++i)
+   {
+      mOut1 += mLeaves1[i];
+
+      // the candidate may have this leaf and the next one the other way round
+      if (i + 1 < n && mChange.chance(mSettings.reorderRate))
+      {
+         mOut2 += mLeaves2[i + 1];
+         mOut2 += mLeaves2[i];
+         mOut1 += mLeaves1[i + 1];
+         ++i;
+         ++mCounts.swapped;
+      }
+      else
+      {
+         mOut2 += mLeaves2[i];
+      }
+
+      // and an element of its own after it
+      if (mChange.chance(mSettings.insertRate))
+      {
+         const unsigned long long id = mCounts.inserted++;
+         mOut2 += string(2 * level, ' ');
+         mOut2 += "<var name=\"inserted";
+         appendUnsigned(mOut2, id);
+         mOut2 += "\" type=\"double\" units=\"m\">0</var>\n";
+      }
+   }
+}
+
+
+
+
+void XmlGenerator::leaf(unsigned int level, unsigned int index, string& text1, string& text2)
+{
+   static const char* const Words[] =
+   {
+      "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel", "india", "juliet",
+      "kilo", "lima", "mike", "november", "oscar", "papa", "quebec", "romeo", "sierra", "tango",
+   };
+   const unsigned int NumWords = sizeof(Words) / sizeof(Words[0]);
+
+   ++mCounts.elements;
+   ++mCounts.leaves;
+   const bool isNumbers = mContent.chance(mSettings.numbers);
+   const bool change = mChange.chance(mSettings.diffRate);
+   // a quarter of the changes are to an attribute, the rest to the content
+   const bool changeAttribute = change && mChange.below(4) == 0;
+
+   text1.clear();
+   if (isNumbers)
+      startTag(text1, level, "var", "v", index, "double");
+   else
+      startTag(text1, level, "Text", "t", index, "string");
+   text2 = text1;
+   if (changeAttribute)
+   {
+      // the type, which xmldiff compares (the extra attributes are not)
+      const size_t type = text2.find(" type=\"");
+      text2.insert(text2.find('"', type + 7), "_changed");
+      ++mCounts.attributes;
+   }
+   if (isNumbers)
+   {
+      text1 += " units=\"m\"";
+      text2 += " units=\"m\"";
+   }
+   text1 += ">";
+   text2 += ">";
+
+   if (isNumbers)
+   {
+      const unsigned int changed = (change && !changeAttribute ? mChange.below(mSettings.arraySize) : mSettings.arraySize);
+      for (unsigned int i = 0; i < mSettings.arraySize; ++i)
+      {
+         const double value = (mContent.uniform() - 0.5) * 200.0;
+         if (i)
+         {
+            text1 += ", ";
+            text2 += ", ";
+         }
+         appendNumber(text1, value);
+         if (i == changed)
+         {
+            // half of the jitter is within the delta, half is two to ten times it
+            const double sign = (mChange.below(2) ? 1.0 : -1.0);
+            if (mChange.below(2))
+            {
+               appendNumber(text2, value + sign * 0.5 * mSettings.delta);
+               ++mCounts.jitterWithin;
+            }
+            else
+            {
+               appendNumber(text2, value + sign * (2.0 + 8.0 * mChange.uniform()) * mSettings.delta);
+               ++mCounts.jitterBeyond;
+            }
+         }
+         else
+         {
+            appendNumber(text2, value);
+         }
+      }
+      text1 += "</var>\n";
+      text2 += "</var>\n";
+   }
+   else
+   {
+      const bool changeWord = change && !changeAttribute;
+      bool changed = false;
+      size_t length = 0;
+      while (length < mSettings.textSize)
+      {
+         const char* word = Words[mContent.below(NumWords)];
+         if (length)
+         {
+            text1 += ' ';
+            text2 += ' ';
+            ++length;
+         }
+         text1 += word;
+         if (changeWord && !changed && (length + strlen(word) >= mSettings.textSize || mChange.below(4) == 0))
+         {
+            // a word that is not in the list
+            text2 += "zulu";
+            changed = true;
+            ++mCounts.words;
+         }
+         else
+         {
+            text2 += word;
+         }
+         length += strlen(word);
+      }
+      text1 += "</Text>\n";
+      text2 += "</Text>\n";
+   }
+}
+
+
+
+
+void XmlGenerator::startTag(string& out, unsigned int level, const char* tag, const char* key, unsigned int index, const char* type)
+{
+   out.append(2 * level, ' ');
+   out += '<';
+   out += tag;
+   if (mContent.chance(mSettings.keyed))
+   {
+      out += " name=\"";
+      out += key;
+      appendUnsigned(out, index);
+      out += '"';
+   }
+   out += " type=\"";
+   out += type;
+   out += '"';
+   for (unsigned int a = 1; a <= mSettings.attribs; ++a)
+   {
+      out += " a";
+      appendUnsigned(out, a);
+      out += "=\"x";
+      appendUnsigned(out, mContent.below(1000));
+      out += '"';
+   }
+}
+
+
+
+
+bool XmlGenerator::flush(bool all)
+{
+   const size_t blockSize = 1 << 20;
+   if (all || mOut1.size() >= blockSize)
+   {
+      if (fwrite(mOut1.data(), 1, mOut1.size(), mFile1) != mOut1.size())
+         mFailed = true;
+      mCounts.bytes1 += mOut1.size();
+      mOut1.clear();
+   }
+   if (all || mOut2.size() >= blockSize)
+   {
+      if (mFile2 && fwrite(mOut2.data(), 1, mOut2.size(), mFile2) != mOut2.size())
+         mFailed = true;
+      mCounts.bytes2 += mOut2.size();
+      mOut2.clear();
+   }
+   return mFailed;
+}
+
+
+
+
+void usage(const char* progName)
+{
+   printf("\n"
+      "%s - write a synthetic XML file, and a candidate twin with known differences\n"
+      "\n"
+      "Usage:  %s [options] <file> [candidate file]\n"
+      "\n"
+      "The same options and seed always give the same files.\n"
+      "\n"
+      "Optional arguments (not case sensitive) are:\n"
+      "   --array <N>         -> Numbers in each leaf holding numbers [8]\n"
+      "   --attribs <N>       -> Attributes of each element besides name and type [1]\n"
+      "   --delta <d>         -> The xmldiff --delta the numbers are moved around: half of\n"
+      "                          the changed numbers move by half of it, half by 2 to 10\n"
+      "                          times it [1e-7]\n"
+      "   --depth <N>         -> Levels of groups, the leaves are below the last one [2]\n"
+      "   --diff-rate <r>     -> Fraction of the leaves changed in the candidate: a number,\n"
+      "                          a word or the type attribute [0.01]\n"
+      "   --fanout <N>        -> Child elements of each group [5]\n"
+      "   --groups <N>        -> Groups at the top level [100]\n"
+      "   --insert-rate <r>   -> Fraction of the leaves followed by an extra element in\n"
+      "                          the candidate [0]\n"
+      "   --keyed <r>         -> Fraction of the elements with a name attribute [1]\n"
+      "   --numbers <r>       -> Fraction of the leaves holding numbers, the others hold\n"
+      "                          text [0.8]\n"
+      "   --reorder-rate <r>  -> Fraction of the leaves swapped with the next one in the\n"
+      "                          candidate [0]\n"
+      "   --seed <N>          -> Seed of the random numbers [1]\n"
+      "   --size <N>[k|m|g]   -> Write top level groups until the file is this big,\n"
+      "                          instead of --groups\n"
+      "   --text <N>          -> Characters of text in each leaf holding text [40]\n"
+      "\n", progName, progName);
+}
+
+
+
+
+//! a size with an optional k, m or g after it
+unsigned long long parseSize(const char* text)
+{
+   char* end = nullptr;
+   double value = strtod(text, &end);
+   switch (end ? *end : 0)
+   {
+   case 'k': case 'K': value *= 1024.0; break;
+   case 'm': case 'M': value *= 1024.0 * 1024.0; break;
+   case 'g': case 'G': value *= 1024.0 * 1024.0 * 1024.0; break;
+   default: break;
+   }
+   return value > 0.0 ? static_cast<unsigned long long>(value) : 0;
+}
+
+
+
+
+int main(int argc, char** argv)
+{
+   const char* progName = argv[0];
+   GenSettings settings;
+   vector<const char*> files;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      const char* arg = argv[i];
+      if (arg[0] != '-')
+      {
+         files.push_back(arg);
+         continue;
+      }
+      if (MU_StringUtil::Strcasecmp(arg, "--help") || MU_StringUtil::Strcasecmp(arg, "-h"))
+      {
+         usage(progName);
+         return 1;
+      }
+      if (i + 1 >= argc)
+      {
+         printf("Option %s needs a value\n", arg);
+         return 1;
+      }
+      const char* value = argv[++i];
+      if (MU_StringUtil::Strcasecmp(arg, "--array"))
+         settings.arraySize = atoi(value);
+      else if (MU_StringUtil::Strcasecmp(arg, "--attribs"))
+         settings.attribs = atoi(value);
+      else if (MU_StringUtil::Strcasecmp(arg, "--delta"))
+         settings.delta = atof(value);
+      else if (MU_StringUtil::Strcasecmp(arg, "--depth"))
+         settings.depth = atoi(value);
+      else if (MU_StringUtil::Strcasecmp(arg, "--diff-rate"))
+         settings.diffRate = atof(value);
+      else if (MU_StringUtil::Strcasecmp(arg, "--fanout"))
+         settings.fanout = atoi(value);
+      else if (MU_StringUtil::Strcasecmp(arg, "--groups"))
+         settings.groups = atoi(value);
+      else if (MU_StringUtil::Strcasecmp(arg, "--insert-rate"))
+         settings.insertRate = atof(value);
+      else if (MU_StringUtil::Strcasecmp(arg, "--keyed"))
+         settings.keyed = atof(value);
+      else if (MU_StringUtil::Strcasecmp(arg, "--numbers"))
+         settings.numbers = atof(value);
+      else if (MU_StringUtil::Strcasecmp(arg, "--reorder-rate"))
+         settings.reorderRate = atof(value);
+      else if (MU_StringUtil::Strcasecmp(arg, "--seed"))
+         settings.seed = strtoull(value, nullptr, 10);
+      else if (MU_StringUtil::Strcasecmp(arg, "--size"))
+         settings.size = parseSize(value);
+      else if (MU_StringUtil::Strcasecmp(arg, "--text"))
+         settings.textSize = atoi(value);
+      else
+      {
+         printf("Unknown option %s, try --help\n", arg);
+         return 1;
+      }
+   }
+
+   if (files.empty() || files.size() > 2)
+   {
+      usage(progName);
+      return 1;
+   }
+   if (settings.depth < 1)
+      settings.depth = 1;
+   if (settings.fanout < 1)
+      settings.fanout = 1;
+
+   FILE* file1 = fopen(files[0], "wb");
+   FILE* file2 = (files.size() > 1 ? fopen(files[1], "wb") : nullptr);
+   if (!file1 || (files.size() > 1 && !file2))
+   {
+      printf("Error: unable to open '%s' for writing\n", (file1 ? files[1] : files[0]));
+      if (file1)
+         fclose(file1);
+      return 1;
+   }
+
+   XmlGenerator generator(settings);
+   bool failed = generator.write(file1, file2);
+   failed = (fclose(file1) != 0) || failed;
+   if (file2)
+      failed = (fclose(file2) != 0) || failed;
+   if (failed)
+   {
+      printf("Error: unable to write the files\n");
+      return 1;
+   }
+
+   const GenCounts& counts = generator.counts();
+   printf("%s: %llu bytes, %llu elements, %llu leaves\n", files[0], counts.bytes1, counts.elements, counts.leaves);
+   if (file2)
+   {
+      printf("%s: %llu bytes\n", files[1], counts.bytes2);
+      printf("   numbers moved within the delta: %llu\n", counts.jitterWithin);
+      printf("   numbers moved beyond the delta: %llu\n", counts.jitterBeyond);
+      printf("   words changed:                  %llu\n", counts.words);
+      printf("   type attributes changed:        %llu\n", counts.attributes);
+      printf("   elements inserted:              %llu\n", counts.inserted);
+      printf("   pairs of leaves swapped:        %llu\n", counts.swapped);
+   }
+   return 0;
+}
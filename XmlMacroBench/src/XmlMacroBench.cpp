@@ -0,0 +1,650 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "MU_StringUtil.h"
+
+using namespace std;
+
+
+/**
+ * @file XmlMacroBench.cpp
+ *
+ * Runs xmldiff and xmlsort from start to end on generated files of several
+ * sizes and records, for each run, the wall time, the peak resident memory,
+ * the page faults and the bytes of output.  The results are written to a
+ * file, one JSON object per line, so the way the programs scale with the
+ * size of the files can be compared from one release to the next.
+ *
+ * The files are made by xmlgen (a file and a candidate with differences) and
+ * kept in the work directory; as xmlgen always makes the same files, they are
+ * only made if they are not there already.  The xmldiff runs vary the
+ * delimiters, the number of filters in a config file, --side and --case: by
+ * default one at a time from a base run, with --all every combination.
+ *
+ * Each run is a separate process, so its peak memory and page faults are its
+ * own and not those of the runs before it.  The output is read through a pipe
+ * and counted, not kept.
+ *
+ * Usage: XmlMacroBench [options]
+ */
+
+
+
+/**
+ * @class RunResult
+ * @brief what one run of a program measured
+ */
+class RunResult
+{
+public:
+   RunResult() : exitStatus(-1), wallSeconds(0.0), peakResidentBytes(0), pageFaults(0), outputBytes(0) {}
+
+   int exitStatus;                        //!< -1 if it did not exit normally
+   double wallSeconds;
+   unsigned long long peakResidentBytes;
+   unsigned long long pageFaults;         //!< hard and soft
+   unsigned long long outputBytes;        //!< written to stdout
+};
+
+
+
+
+// ======================================================================
+// running a program
+// ======================================================================
+
+//! run a program with its standard output read through a pipe and counted.  If 'output' is not
+//! null the output is also kept there.  Returns true if the program could not be run
+bool runProgram(const vector<string>& args, RunResult& result, string* output = nullptr)
+{
+   result = RunResult();
+   const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   char buffer[64 * 1024];
+
+#ifdef _WIN32
+   // the command line, with each argument quoted if it has a space or a tab in it
+   string commandLine;
+   for (size_t i = 0; i < args.size(); ++i)
+   {
+      if (i)
+         commandLine += ' ';
+      if (args[i].empty() || args[i].find_first_of(" \t\n\"") != string::npos)
+      {
+         commandLine += '"';
+         for (size_t c = 0; c < args[i].size(); ++c)
+         {
+            if (args[i][c] == '"')
+               commandLine += '\\';
+            commandLine += args[i][c];
+         }
+         commandLine += '"';
+      }
+      else
+      {
+         commandLine += args[i];
+      }
+   }
+   vector<char> commandBuffer(commandLine.begin(), commandLine.end());
+   commandBuffer.push_back('\0');
+
+   SECURITY_ATTRIBUTES security = { sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+   HANDLE readPipe = nullptr, writePipe = nullptr;
+   if (!CreatePipe(&readPipe, &writePipe, &security, 0))
+      return true;
+   SetHandleInformation(readPipe, HANDLE_FLAG_INHERIT, 0);
+
+   STARTUPINFOA startup;
+   ZeroMemory(&startup, sizeof(startup));
+   startup.cb = sizeof(startup);
+   startup.dwFlags = STARTF_USESTDHANDLES;
+   startup.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+   startup.hStdOutput = writePipe;
+   startup.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+   PROCESS_INFORMATION process;
+   const BOOL started = CreateProcessA(nullptr, &commandBuffer[0], nullptr, nullptr, TRUE, 0, nullptr, nullptr, &startup, &process);
+   CloseHandle(writePipe);
+   if (!started)
+   {
+      CloseHandle(readPipe);
+      return true;
+   }
+
+   DWORD n = 0;
+   while (ReadFile(readPipe, buffer, sizeof(buffer), &n, nullptr) && n > 0)
+   {
+      result.outputBytes += n;
+      if (output)
+         output->append(buffer, n);
+   }
+   CloseHandle(readPipe);
+   WaitForSingleObject(process.hProcess, INFINITE);
+   result.wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+   DWORD exitCode = 0;
+   if (GetExitCodeProcess(process.hProcess, &exitCode))
+      result.exitStatus = static_cast<int>(exitCode);
+   PROCESS_MEMORY_COUNTERS counters;
+   if (GetProcessMemoryInfo(process.hProcess, &counters, sizeof(counters)))
+   {
+      result.peakResidentBytes = counters.PeakWorkingSetSize;
+      result.pageFaults = counters.PageFaultCount;
+   }
+   CloseHandle(process.hThread);
+   CloseHandle(process.hProcess);
+   return false;
+#else
+   int fds[2];
+   if (pipe(fds) != 0)
+      return true;
+   vector<char*> argv;
+   for (size_t i = 0; i < args.size(); ++i)
+      argv.push_back(const_cast<char*>(args[i].c_str()));
+   argv.push_back(nullptr);
+
+   const pid_t pid = fork();
+   if (pid < 0)
+   {
+      close(fds[0]);
+      close(fds[1]);
+      return true;
+   }
+   if (pid == 0)
+   {
+      dup2(fds[1], 1);
+      close(fds[0]);
+      close(fds[1]);
+      execvp(argv[0], &argv[0]);
+      _exit(127);
+   }
+   close(fds[1]);
+
+   ssize_t n = 0;
+   while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+   {
+      result.outputBytes += n;
+      if (output)
+         output->append(buffer, n);
+   }
+   close(fds[0]);
+
+   int status = 0;
+   struct rusage usage;
+   if (wait4(pid, &status, 0, &usage) < 0)
+      return true;
+   result.wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+   if (WIFEXITED(status))
+      result.exitStatus = WEXITSTATUS(status);
+   // the shell's status for a program that could not be started
+   if (result.exitStatus == 127)
+      return true;
+#ifdef __APPLE__
+   result.peakResidentBytes = static_cast<unsigned long long>(usage.ru_maxrss);          // bytes
+#else
+   result.peakResidentBytes = static_cast<unsigned long long>(usage.ru_maxrss) * 1024;   // kilobytes
+#endif
+   result.pageFaults = static_cast<unsigned long long>(usage.ru_minflt) + usage.ru_majflt;
+   return false;
+#endif
+}
+
+
+
+
+//! true if the file can be opened for reading
+bool fileExists(const string& filename)
+{
+   FILE* file = fopen(filename.c_str(), "rb");
+   if (!file)
+      return false;
+   fclose(file);
+   return true;
+}
+
+
+
+
+//! the size of a file in bytes, 0 if it cannot be read
+unsigned long long fileSize(const string& filename)
+{
+#ifdef _WIN32
+   WIN32_FILE_ATTRIBUTE_DATA data;
+   if (!GetFileAttributesExA(filename.c_str(), GetFileExInfoStandard, &data))
+      return 0;
+   return (static_cast<unsigned long long>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+#else
+   struct stat info;
+   if (stat(filename.c_str(), &info) != 0)
+      return 0;
+   return static_cast<unsigned long long>(info.st_size);
+#endif
+}
+
+
+
+
+// ======================================================================
+// the runs
+// ======================================================================
+
+/**
+ * @class MacroSettings
+ * @brief the programs, files and runs, from the command line
+ */
+class MacroSettings
+{
+public:
+   MacroSettings() : xmldiff("XmlDiff"), xmlsort("XmlSort"), xmlgen("XmlGen"), dir("."), out("macrobench.jsonl"),
+      sizes(), all(false) {}
+
+   string xmldiff;                 //!< the programs, found on the PATH if there is no directory
+   string xmlsort;
+   string xmlgen;
+   string dir;                     //!< where the generated files are kept
+   string out;                     //!< the results
+   vector<string> sizes;           //!< the sizes of the generated files, as given to xmlgen --size
+   bool all;                       //!< every combination of the xmldiff settings, not one at a time
+};
+
+
+
+
+/**
+ * @class DiffScenario
+ * @brief the settings of one xmldiff run
+ */
+class DiffScenario
+{
+public:
+   DiffScenario(const char* aDelim, unsigned int aFilters, bool aSide, bool aCase)
+      : delim(aDelim), filters(aFilters), side(aSide), caseSensitive(aCase) {}
+
+   string delim;
+   unsigned int filters;           //!< filters in the config file, none of them matching
+   bool side;
+   bool caseSensitive;
+};
+
+
+
+
+//! the delimiter sets and filter counts the xmldiff runs use.  The first of each is the base run
+const char* const DelimSets[] = { " ", " ,", "|{, \t" };
+const unsigned int FilterCounts[] = { 0, 16, 256 };
+const size_t NumDelimSets = sizeof(DelimSets) / sizeof(DelimSets[0]);
+const size_t NumFilterCounts = sizeof(FilterCounts) / sizeof(FilterCounts[0]);
+
+
+
+
+//! the xmldiff runs: the base run and each setting changed on its own, or with 'all' every combination
+vector<DiffScenario> makeScenarios(bool all)
+{
+   vector<DiffScenario> scenarios;
+   if (all)
+   {
+      for (size_t d = 0; d < NumDelimSets; ++d)
+         for (size_t f = 0; f < NumFilterCounts; ++f)
+            for (int side = 0; side < 2; ++side)
+               for (int caseSensitive = 0; caseSensitive < 2; ++caseSensitive)
+                  scenarios.push_back(DiffScenario(DelimSets[d], FilterCounts[f], side != 0, caseSensitive != 0));
+      return scenarios;
+   }
+
+   scenarios.push_back(DiffScenario(DelimSets[0], FilterCounts[0], false, false));
+   for (size_t d = 1; d < NumDelimSets; ++d)
+      scenarios.push_back(DiffScenario(DelimSets[d], FilterCounts[0], false, false));
+   for (size_t f = 1; f < NumFilterCounts; ++f)
+      scenarios.push_back(DiffScenario(DelimSets[0], FilterCounts[f], false, false));
+   scenarios.push_back(DiffScenario(DelimSets[0], FilterCounts[0], true, false));
+   scenarios.push_back(DiffScenario(DelimSets[0], FilterCounts[0], false, true));
+   return scenarios;
+}
+
+
+
+
+//! write a config file with 'count' filters, none of which match an element of the generated
+//! files, so every element is checked against all of them.  Returns true on error
+bool writeFilterConfig(const string& filename, unsigned int count)
+{
+   FILE* file = fopen(filename.c_str(), "w");
+   if (!file)
+      return true;
+   fprintf(file, "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<XmlDiff>\n   <Ignore>\n");
+   for (unsigned int i = 0; i < count; ++i)
+      fprintf(file, "      <var name=\"nomatch%u\" type=\"double\"/>\n", i);
+   fprintf(file, "   </Ignore>\n</XmlDiff>\n");
+   return fclose(file) != 0;
+}
+
+
+
+
+//! a string as a JSON string, in quotes
+string jsonString(const string& text)
+{
+   string out = "\"";
+   for (size_t i = 0; i < text.size(); ++i)
+   {
+      const char c = text[i];
+      if (c == '"' || c == '\\')
+      {
+         out += '\\';
+         out += c;
+      }
+      else if (c == '\t')
+         out += "\\t";
+      else if (c == '\n')
+         out += "\\n";
+      else if (static_cast<unsigned char>(c) < 0x20)
+      {
+         char buffer[8];
+         sprintf(buffer, "\\u%04x", c);
+         out += buffer;
+      }
+      else
+         out += c;
+   }
+   return out + "\"";
+}
+
+
+
+
+//! the first line (that is not blank) a program writes for --version, for the results
+string programVersion(const string& program)
+{
+   vector<string> args;
+   args.push_back(program);
+   args.push_back("--version");
+   RunResult result;
+   string output;
+   if (runProgram(args, result, &output))
+      return "";
+   const size_t start = output.find_first_not_of(" \r\n");
+   if (start == string::npos)
+      return "";
+   return output.substr(start, output.find_first_of("\r\n", start) - start);
+}
+
+
+
+
+/**
+ * @class ResultsFile
+ * @brief writes each result as a line of JSON as soon as it is measured, and a line to the screen
+ */
+class ResultsFile
+{
+public:
+   ResultsFile() : mFile(nullptr) {}
+   ~ResultsFile() { close(); }
+
+   //! open the file.  Returns true on error
+   bool open(const string& filename)
+   {
+      mFile = fopen(filename.c_str(), "w");
+      return mFile == nullptr;
+   }
+
+   //! close the file.  Returns true on error
+   bool close()
+   {
+      bool failed = false;
+      if (mFile)
+         failed = fclose(mFile) != 0;
+      mFile = nullptr;
+      return failed;
+   }
+
+   //! write one result.  'fields' are the JSON fields that tell what was run, each followed by ", "
+   void write(const string& program, const string& size, unsigned long long inputBytes, const string& fields,
+      const string& label, const RunResult& result)
+   {
+      printf("%-8s %6s %-40s %9.2f s %9.1f MB %10llu faults %12llu bytes out\n", program.c_str(), size.c_str(), label.c_str(),
+         result.wallSeconds, result.peakResidentBytes / 1.0e6, result.pageFaults, result.outputBytes);
+      fflush(stdout);
+      if (!mFile)
+         return;
+      fprintf(mFile, "{\"program\": %s, \"size\": %s, \"input_bytes\": %llu, %s\"exit_status\": %d, \"wall_seconds\": %.3f, "
+         "\"peak_rss_bytes\": %llu, \"page_faults\": %llu, \"output_bytes\": %llu}\n",
+         jsonString(program).c_str(), jsonString(size).c_str(), inputBytes, fields.c_str(), result.exitStatus, result.wallSeconds,
+         result.peakResidentBytes, result.pageFaults, result.outputBytes);
+      fflush(mFile);
+   }
+
+   //! write a line that is not a result, such as the versions of the programs
+   void writeLine(const string& line)
+   {
+      if (mFile)
+         fprintf(mFile, "%s\n", line.c_str());
+   }
+
+private:
+   ResultsFile(const ResultsFile&);               // not supported
+   void operator=(const ResultsFile&);            // not supported
+
+   FILE* mFile;
+};
+
+
+
+
+//! run xmlgen to make the pair of files of one size, unless they are there already.  Returns true on error
+bool makeCorpus(const MacroSettings& settings, const string& size, const string& file1, const string& file2, ResultsFile& results)
+{
+   if (fileExists(file1) && fileExists(file2))
+      return false;
+
+   // made under other names and renamed when complete, so a run that is stopped
+   // part way does not leave files that a later run would take as complete
+   const string temporary1 = file1 + ".part";
+   const string temporary2 = file2 + ".part";
+   vector<string> args;
+   args.push_back(settings.xmlgen);
+   args.push_back("--size");
+   args.push_back(size);
+   args.push_back(temporary1);
+   args.push_back(temporary2);
+   RunResult result;
+   if (runProgram(args, result) || result.exitStatus != 0)
+   {
+      printf("Error: unable to run %s to make '%s'\n", settings.xmlgen.c_str(), file1.c_str());
+      return true;
+   }
+   remove(file1.c_str());
+   remove(file2.c_str());
+   if (rename(temporary1.c_str(), file1.c_str()) != 0 || rename(temporary2.c_str(), file2.c_str()) != 0)
+   {
+      printf("Error: unable to rename '%s' to '%s'\n", temporary1.c_str(), file1.c_str());
+      return true;
+   }
+   results.write("xmlgen", size, 0, "", "generate", result);
+   return false;
+}
+
+
+
+
+//! run xmldiff and xmlsort on the files of one size.  Returns true if a program could not be run
+bool runSize(const MacroSettings& settings, const string& size, ResultsFile& results)
+{
+   const string file1 = settings.dir + "/macrobench_" + size + ".xml";
+   const string file2 = settings.dir + "/macrobench_" + size + "_candidate.xml";
+   if (makeCorpus(settings, size, file1, file2, results))
+      return true;
+   const unsigned long long bytes1 = fileSize(file1);
+   const unsigned long long bytes2 = fileSize(file2);
+
+   const vector<DiffScenario> scenarios = makeScenarios(settings.all);
+   for (size_t s = 0; s < scenarios.size(); ++s)
+   {
+      const DiffScenario& scenario = scenarios[s];
+      vector<string> args;
+      args.push_back(settings.xmldiff);
+      args.push_back("--delim");
+      args.push_back(scenario.delim);
+      args.push_back("--case");
+      args.push_back(scenario.caseSensitive ? "true" : "false");
+      if (scenario.side)
+         args.push_back("--side");
+      if (scenario.filters > 0)
+      {
+         const string config = settings.dir + "/macrobench_filters_" + to_string(scenario.filters) + ".xml";
+         if (writeFilterConfig(config, scenario.filters))
+         {
+            printf("Error: unable to write '%s'\n", config.c_str());
+            return true;
+         }
+         args.push_back("--config");
+         args.push_back(config);
+      }
+      args.push_back(file1);
+      args.push_back(file2);
+
+      RunResult result;
+      if (runProgram(args, result))
+      {
+         printf("Error: unable to run %s\n", settings.xmldiff.c_str());
+         return true;
+      }
+      const string fields = "\"delim\": " + jsonString(scenario.delim) + ", \"filters\": " + to_string(scenario.filters) +
+         ", \"side\": " + (scenario.side ? "true" : "false") + ", \"case\": " + (scenario.caseSensitive ? "true" : "false") + ", ";
+      const string label = "delim " + jsonString(scenario.delim) + " filters " + to_string(scenario.filters) +
+         (scenario.side ? " side" : "") + (scenario.caseSensitive ? " case" : "");
+      results.write("xmldiff", size, bytes1 + bytes2, fields, label, result);
+   }
+
+   vector<string> args;
+   args.push_back(settings.xmlsort);
+   args.push_back(file1);
+   RunResult result;
+   if (runProgram(args, result))
+   {
+      printf("Error: unable to run %s\n", settings.xmlsort.c_str());
+      return true;
+   }
+   results.write("xmlsort", size, bytes1, "", "sort", result);
+   return false;
+}
+
+
+
+
+void usage(const char* progName)
+{
+   printf("\n"
+      "%s - run xmldiff and xmlsort on generated files of several sizes and record\n"
+      "the time, peak memory, page faults and output of each run\n"
+      "\n"
+      "Usage:  %s [options]\n"
+      "\n"
+      "Optional arguments (not case sensitive) are:\n"
+      "   --all               -> Run xmldiff with every combination of the delimiters,\n"
+      "                          filters, --side and --case instead of changing one at a\n"
+      "                          time from the base run\n"
+      "   --dir <directory>   -> Keep the generated files here. They are made only if they\n"
+      "                          are not there already [.]\n"
+      "   --out <file>        -> Write the results here, one JSON object per line\n"
+      "                          [macrobench.jsonl]\n"
+      "   --sizes <list>      -> The sizes of the generated files, separated by commas, with\n"
+      "                          k, m or g after each [10m,1g,10g]\n"
+      "   --xmldiff <program> -> The xmldiff to run [XmlDiff]\n"
+      "   --xmlgen <program>  -> The xmlgen that makes the files [XmlGen]\n"
+      "   --xmlsort <program> -> The xmlsort to run [XmlSort]\n"
+      "\n"
+      "The programs are found on the PATH unless a directory is given.\n"
+      "\n", progName, progName);
+}
+
+
+
+
+int main(int argc, char** argv)
+{
+   const char* progName = argv[0];
+   MacroSettings settings;
+   string sizes = "10m,1g,10g";
+
+   for (int i = 1; i < argc; ++i)
+   {
+      const char* arg = argv[i];
+      if (MU_StringUtil::Strcasecmp(arg, "--all"))
+      {
+         settings.all = true;
+         continue;
+      }
+      if (MU_StringUtil::Strcasecmp(arg, "--help") || MU_StringUtil::Strcasecmp(arg, "-h") || i + 1 >= argc)
+      {
+         usage(progName);
+         return 1;
+      }
+      const char* value = argv[++i];
+      if (MU_StringUtil::Strcasecmp(arg, "--dir"))
+         settings.dir = value;
+      else if (MU_StringUtil::Strcasecmp(arg, "--out"))
+         settings.out = value;
+      else if (MU_StringUtil::Strcasecmp(arg, "--sizes"))
+         sizes = value;
+      else if (MU_StringUtil::Strcasecmp(arg, "--xmldiff"))
+         settings.xmldiff = value;
+      else if (MU_StringUtil::Strcasecmp(arg, "--xmlgen"))
+         settings.xmlgen = value;
+      else if (MU_StringUtil::Strcasecmp(arg, "--xmlsort"))
+         settings.xmlsort = value;
+      else
+      {
+         printf("Unknown option %s, try --help\n", arg);
+         return 1;
+      }
+   }
+   MU_StringUtil::Tokenize(sizes, settings.sizes, ",");
+   if (settings.sizes.empty())
+   {
+      usage(progName);
+      return 1;
+   }
+
+   ResultsFile results;
+   if (results.open(settings.out))
+   {
+      printf("Error: unable to open '%s' for writing\n", settings.out.c_str());
+      return 1;
+   }
+   results.writeLine("{\"versions\": {\"xmldiff\": " + jsonString(programVersion(settings.xmldiff)) +
+      ", \"xmlsort\": " + jsonString(programVersion(settings.xmlsort)) + "}}");
+
+   for (size_t s = 0; s < settings.sizes.size(); ++s)
+   {
+      if (runSize(settings, settings.sizes[s], results))
+         return 1;
+   }
+
+   if (results.close())
+   {
+      printf("Error: unable to write '%s'\n", settings.out.c_str());
+      return 1;
+   }
+   return 0;
+}
@@ -77,6 +77,14 @@ public:
    friend std::ostream& operator << ( std::ostream& o, const RunSettings* w );
 
 
+   // get or set the flag to load input files through a memory mapping instead of reading them
+   void setMemoryMapped(bool r) { mMemoryMapped = r; }
+   bool getMemoryMapped() const { return mMemoryMapped; }
+
+   // get or set the format of the run statistics written at the end: text or json, empty for none
+   void setStats(const std::string& aFormat) { mStats = aFormat; }
+   const std::string& getStats() const { return mStats; }
+
    // Get the value of flag that indicates if the version number is to be shown
    bool showVersion() const { return mShowVersion; }
    void showVersion( const bool p ) { mShowVersion = p; }
@@ -103,6 +111,8 @@ private:
    void destroy();
 
    // member variables
+   bool mMemoryMapped;              //!< load input file with a memory mapping
+   std::string mStats;              //!< write the run statistics in this format (text or json), empty for none
    bool mShowVersion;               //!< show version number and quit
    bool mShowUsage;                 //!< show program usage and quit
    std::vector<std::string> mUnswitched;      //!< unswitched arguments
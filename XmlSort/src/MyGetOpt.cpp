@@ -104,6 +104,21 @@ void MyGetOpt( int argc, char **argv, RunSettings& runSettings )
          {
             runSettings.showVersion(true);
          }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--mmap"))
+         {
+            runSettings.setMemoryMapped(true);
+         }
+         else if (MU_StringUtil::Strcasecmp(*argv, "--stats"))
+         {
+            if (MyOptArg(argc, argv, 1, 1, optlist) < 0)
+            {
+               exit(0);
+            }
+            else
+            {
+               runSettings.setStats(optlist[0]);
+            }
+         }
       }
       else
       {
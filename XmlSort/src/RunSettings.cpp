@@ -16,7 +16,9 @@ using namespace std;
 
 // ==========================================================================
 RunSettings::RunSettings()
-   : mShowVersion(false)
+   : mMemoryMapped(false)
+   , mStats()
+   , mShowVersion(false)
    , mShowUsage(false)
    , mUnswitched()
 {
@@ -27,7 +29,9 @@ RunSettings::RunSettings()
 
 // ==========================================================================
 RunSettings::RunSettings(bool aVersion, bool aUsage)
-   : mShowVersion(aVersion)
+   : mMemoryMapped(false)
+   , mStats()
+   , mShowVersion(aVersion)
    , mShowUsage(aUsage)
    , mUnswitched()
 {
@@ -47,7 +51,9 @@ RunSettings::~RunSettings()
 
 // ==========================================================================
 RunSettings::RunSettings(const RunSettings& p)
-   : mShowVersion(p.mShowVersion)
+   : mMemoryMapped(p.mMemoryMapped)
+   , mStats(p.mStats)
+   , mShowVersion(p.mShowVersion)
    , mShowUsage(p.mShowUsage)
    , mUnswitched(p.mUnswitched)
 {
@@ -66,6 +72,8 @@ RunSettings& RunSettings::operator = (const RunSettings& p)
       destroy();
 
       // now copy contents
+      mMemoryMapped  = p.mMemoryMapped;
+      mStats         = p.mStats;
       mShowVersion   = p.mShowVersion;
       mShowUsage     = p.mShowUsage;
       mUnswitched    = p.mUnswitched;
@@ -81,6 +89,8 @@ RunSettings& RunSettings::operator = (const RunSettings& p)
 void RunSettings::show(std::ostream& stream) const
 {
    stream << "<RunSettings>";
+   stream << "<mmap>" << (mMemoryMapped ? "true" : "false") << "</mmap>";
+   stream << "<stats>" << mStats << "</stats>";
    stream << "<version>" << mShowVersion << "</version>";
    stream << "<usage>" << mShowUsage << "</usage>";
    stream << "</RunSettings>";
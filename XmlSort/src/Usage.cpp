@@ -41,7 +41,16 @@ void Usage(const char* progName)
       << "\n"
       << "Usage:  " << progName << " [options] <XML file>\n"
       << "\n"
+      << "The XML file may also be a snapshot saved by xmldiff --snapshot, which is\n"
+      << "loaded without parsing.\n"
+      << "\n"
       << "Optional arguments (not case sensitive) are:\n"
+      << "   --mmap              -> Map the input file into memory instead of reading it\n"
+      << "                          into a buffer (less memory for very large files)\n"
+      << "   --stats text|json   -> When done, write where the time and memory went to\n"
+      << "                          stderr: the wall and CPU time of each phase (load,\n"
+      << "                          parse, sort, output), bytes and elements per second,\n"
+      << "                          the tinyxml2 memory pools and the peak resident memory\n"
       << "   --version           -> Print program version and exit\n"
       << "   -v                  -> Same as --version\n"
       << "   --help              -> output this help\n"
@@ -5,6 +5,7 @@
 
 
 
+#include "MU_RunStats.h"
 #include "MyGetOpt.h"
 #include "ProgramVersion.h"
 #include "Usage.h"
@@ -30,6 +31,31 @@ using namespace std;
 
 
 
+//! size of a file in bytes, 0 if it cannot be read
+unsigned long long fileSize(const char* filename)
+{
+   ifstream in(filename, ios::binary | ios::ate);
+   if (!in)
+      return 0;
+   return static_cast<unsigned long long>(in.tellg());
+}
+
+
+
+
+//! number of elements in a sorted tree, counting the top one
+unsigned long long countElements(const NXmlElem& elem)
+{
+   unsigned long long n = 1;
+   const std::list<NXmlElem>& children = elem.ChildElems();
+   for (std::list<NXmlElem>::const_iterator child = children.begin(); child != children.end(); ++child)
+      n += countElements(*child);
+   return n;
+}
+
+
+
+
 int main(int argc, char**argv)
 {
    const char* progName = *argv;  // name of executable
@@ -38,6 +64,8 @@ int main(int argc, char**argv)
    RunSettings runSettings(false, false);
    // modify run-time settings based on user command-line arguments
    MyGetOpt(argc, argv, runSettings);
+   // the whole run is timed from here
+   MU_RunStats runStats;
 
    if (runSettings.showVersion())
    {
@@ -59,18 +87,45 @@ int main(int argc, char**argv)
 
    const char* filename1 = runSettings.getUnswitched(0).c_str();
 
+   const std::string& statsFormat = runSettings.getStats();
+   if (!statsFormat.empty() && statsFormat != "text" && statsFormat != "json")
+   {
+      cout << "Error: unknown stats format '" << statsFormat << "', use text or json" << endl;
+      return 1;
+   }
 
+
+   // a snapshot saved by XmlDiff --snapshot is loaded without parsing.  a file is
+   // read, then parsed, so --stats can time them apart
    XMLDocument doc1;
-   doc1.LoadFile(filename1);
+   MU_RunStats::Times start = MU_RunStats::now();
+   const bool snapshot = XMLDocument::IsSnapshot(filename1);
+   if (snapshot)
+   {
+      doc1.LoadSnapshot(filename1);
+      start = runStats.addPhase("load", start);
+   }
+   else
+   {
+      doc1.ReadFile(filename1, runSettings.getMemoryMapped());
+      start = runStats.addPhase("load", start);
+      doc1.ParseLoaded();
+      start = runStats.addPhase("parse", start);
+   }
    if (doc1.Error())
    {
       cout << "Error opening file '" << filename1 << "': " << doc1.ErrorName() << endl;
       return 1;
    }
 
+   // a snapshot keeps the xml declaration as the first node instead
+   const XMLDeclaration* declarationNode = (doc1.FirstChild() ? doc1.FirstChild()->ToDeclaration() : nullptr);
+   if (snapshot && declarationNode)
+      cout << "<?" << declarationNode->Value() << "?>" << endl;
+
    // get first line of xml file which should be the xml declaration
    ifstream in(filename1);
-   if (in)
+   if (!snapshot && in)
    {
       // look for start of xml declaration.  if found, find end of it since there might be
       // more xml on that same physical line and output only up to that line
@@ -89,7 +144,22 @@ int main(int argc, char**argv)
    // load into NamedXml which will sort it
    XMLElement* element1 = doc1.FirstChildElement();
    NXmlElem elem(element1);
+   start = runStats.addPhase("sort", start);
    cout << elem;
+   cout.flush();
+   runStats.addPhase("output", start);
+
+   if (!statsFormat.empty())
+   {
+      runStats.addCount("bytes", fileSize(filename1), "");
+      if (element1)
+         runStats.addCount("elements", countElements(elem), "sort");
+      MemPoolStats pools[MEMPOOL_COUNT];
+      doc1.GetMemPoolStats(pools);
+      for (int i = 0; i < MEMPOOL_COUNT; ++i)
+         runStats.addPool(pools[i].name, pools[i].itemSize, pools[i].watermark, pools[i].blocks, pools[i].blockItems, pools[i].allocs);
+      runStats.write(cerr, statsFormat == "json");
+   }
 
    return 0;
 }
@@ -30,6 +30,21 @@ distribution.
 #   include <cstddef>
 #endif
 
+#if defined(_WIN32)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#endif
+
 static const char LINE_FEED				= (char)0x0a;			// all line endings are normalized to LF
 static const char LF = LINE_FEED;
 static const char CARRIAGE_RETURN		= (char)0x0d;			// CR gets filtered out
@@ -135,7 +150,7 @@ char* StrPair::ParseText( char* p, const char* endTag, int strFlags )
 }
 
 
-char* StrPair::ParseName( char* p )
+char* StrPair::ParseName( char* p, XMLAtomTable* atoms, XMLAtom* atom )
 {
     if ( !p || !(*p) ) {
         return 0;
@@ -151,6 +166,9 @@ char* StrPair::ParseName( char* p )
     }
 
     Set( start, p, 0 );
+    if ( atoms && atom ) {
+        *atom = atoms->Intern( start, (int)( p - start ) );
+    }
     return p;
 }
 
@@ -284,6 +302,151 @@ const char* StrPair::GetStr()
 
 
 
+// --------- XMLAtomTable ----------- //
+
+XMLAtomTable::XMLAtomTable() :
+    _slots( 0 ),
+    _slotCount( 0 )
+{
+}
+
+
+XMLAtomTable::~XMLAtomTable()
+{
+    delete [] _slots;
+}
+
+
+void XMLAtomTable::Clear()
+{
+    _entries.Clear();
+    _chars.Clear();
+    if ( _slots ) {
+        memset( _slots, 0, sizeof( int ) * _slotCount );
+    }
+}
+
+
+XMLAtom XMLAtomTable::Intern( const char* name, int length )
+{
+    XMLAtom atom;
+    if ( length <= 0 ) {
+        return atom;
+    }
+
+    // FNV-1a of the name as it is and in lower case
+    unsigned hash = 2166136261u;
+    unsigned foldedHash = 2166136261u;
+    bool upper = false;
+    for ( int i = 0; i < length; ++i ) {
+        const char lower = Lower( name[i] );
+        upper = upper || ( lower != name[i] );
+        hash = ( hash ^ (unsigned char)name[i] ) * 16777619u;
+        foldedHash = ( foldedHash ^ (unsigned char)lower ) * 16777619u;
+    }
+
+    atom.id = Find( name, length, hash, false );
+    if ( atom.id ) {
+        atom.folded = _entries[atom.id-1].folded;
+    }
+    else if ( upper ) {
+        // the lower case name is in the table too, for its id to be 'folded'
+        atom.folded = Find( name, length, foldedHash, true );
+        if ( !atom.folded ) {
+            atom.folded = Add( name, length, foldedHash, true, 0 );
+        }
+        atom.id = Add( name, length, hash, false, atom.folded );
+    }
+    else {
+        atom.id = Add( name, length, hash, false, 0 );
+        atom.folded = atom.id;
+    }
+    return atom;
+}
+
+
+int XMLAtomTable::Find( const char* name, int length, unsigned hash, bool fold ) const
+{
+    if ( _slotCount == 0 ) {
+        return 0;
+    }
+    const int mask = _slotCount - 1;
+    for( int slot = (int)( hash & mask ); _slots[slot]; slot = ( slot + 1 ) & mask ) {
+        const Entry& entry = _entries[_slots[slot]-1];
+        if ( entry.hash != hash || entry.length != length ) {
+            continue;
+        }
+        const char* chars = _chars.Mem() + entry.offset;
+        int i = 0;
+        if ( fold ) {
+            while ( i < length && chars[i] == Lower( name[i] ) ) {
+                ++i;
+            }
+        }
+        else {
+            while ( i < length && chars[i] == name[i] ) {
+                ++i;
+            }
+        }
+        if ( i == length ) {
+            return _slots[slot];
+        }
+    }
+    return 0;
+}
+
+
+int XMLAtomTable::Add( const char* name, int length, unsigned hash, bool fold, int folded )
+{
+    // at most half the slots are used, so a probe soon finds an empty one
+    if ( 2 * ( _entries.Size() + 1 ) > _slotCount ) {
+        Grow();
+    }
+
+    Entry entry;
+    entry.hash = hash;
+    entry.offset = _chars.Size();
+    entry.length = length;
+    entry.folded = folded;
+    char* chars = _chars.PushArr( length );
+    for ( int i = 0; i < length; ++i ) {
+        chars[i] = fold ? Lower( name[i] ) : name[i];
+    }
+    _entries.Push( entry );
+
+    const int id = _entries.Size();
+    if ( !folded ) {
+        _entries[id-1].folded = id;
+    }
+    const int mask = _slotCount - 1;
+    int slot = (int)( hash & mask );
+    while ( _slots[slot] ) {
+        slot = ( slot + 1 ) & mask;
+    }
+    _slots[slot] = id;
+    return id;
+}
+
+
+void XMLAtomTable::Grow()
+{
+    const int slotCount = _slotCount ? _slotCount * 2 : 256;
+    delete [] _slots;
+    _slots = new int[slotCount];
+    memset( _slots, 0, sizeof( int ) * slotCount );
+    _slotCount = slotCount;
+
+    const int mask = _slotCount - 1;
+    for ( int id = 1; id <= _entries.Size(); ++id ) {
+        int slot = (int)( _entries[id-1].hash & mask );
+        while ( _slots[slot] ) {
+            slot = ( slot + 1 ) & mask;
+        }
+        _slots[slot] = id;
+    }
+}
+
+
 // --------- XMLUtil ----------- //
 
 const char* XMLUtil::ReadBOM( const char* p, bool* bom )
@@ -629,6 +792,7 @@ XMLNode::XMLNode( XMLDocument* doc ) :
     _parent( 0 ),
     _firstChild( 0 ), _lastChild( 0 ),
     _prev( 0 ), _next( 0 ),
+    _userData( 0 ),
     _memPool( 0 )
 {
 }
@@ -655,6 +819,11 @@ void XMLNode::SetValue( const char* str, bool staticMem )
     else {
         _value.SetStr( str );
     }
+    // the name of an element is no longer the one that was interned
+    XMLElement* element = ToElement();
+    if ( element ) {
+        element->_nameAtom = XMLAtom();
+    }
 }
 
 
@@ -1158,10 +1327,10 @@ const char* XMLAttribute::Value() const
     return _value.GetStr();
 }
 
-char* XMLAttribute::ParseDeep( char* p, bool processEntities )
+char* XMLAttribute::ParseDeep( char* p, bool processEntities, XMLAtomTable* atoms )
 {
     // Parse using the name rules: bug fix, was using ParseText before
-    p = _name.ParseName( p );
+    p = _name.ParseName( p, atoms, &_nameAtom );
     if ( !p || !*p ) {
         return 0;
     }
@@ -1189,6 +1358,7 @@ char* XMLAttribute::ParseDeep( char* p, bool processEntities )
 void XMLAttribute::SetName( const char* n )
 {
     _name.SetStr( n );
+    _nameAtom = XMLAtom();
 }
 
 
@@ -1516,7 +1686,7 @@ char* XMLElement::ParseAttributes( char* p )
             attrib->_memPool = &_document->_attributePool;
 			attrib->_memPool->SetTracked();
 
-            p = attrib->ParseDeep( p, _document->ProcessEntities() );
+            p = attrib->ParseDeep( p, _document->ProcessEntities(), _document->_atoms );
             if ( !p || Attribute( attrib->Name() ) ) {
                 DeleteAttribute( attrib );
                 _document->SetError( XML_ERROR_PARSING_ATTRIBUTE, start, p );
@@ -1580,7 +1750,7 @@ char* XMLElement::ParseDeep( char* p, StrPair* strPair )
         ++p;
     }
 
-    p = _value.ParseName( p );
+    p = _value.ParseName( p, _document->_atoms, &_nameAtom );
     if ( _value.Empty() ) {
         return 0;
     }
@@ -1672,7 +1842,9 @@ const char* XMLDocument::_errorNames[XML_ERROR_COUNT] = {
     "XML_ERROR_MISMATCHED_ELEMENT",
     "XML_ERROR_PARSING",
     "XML_CAN_NOT_CONVERT_TEXT",
-    "XML_NO_TEXT_NODE"
+    "XML_NO_TEXT_NODE",
+    "XML_ERROR_FILE_WRITE_ERROR",
+    "XML_ERROR_SNAPSHOT_TOO_BIG"
 };
 
 
@@ -1684,7 +1856,10 @@ XMLDocument::XMLDocument( bool processEntities, Whitespace whitespace ) :
     _whitespace( whitespace ),
     _errorStr1( 0 ),
     _errorStr2( 0 ),
-    _charBuffer( 0 )
+    _charBuffer( 0 ),
+    _charBufferMapped( 0 ),
+    _charBufferSize( 0 ),
+    _atoms( 0 )
 {
     _document = this;	// avoid warning about 'this' in initializer list
 }
@@ -1707,8 +1882,7 @@ void XMLDocument::Clear()
     _errorStr1 = 0;
     _errorStr2 = 0;
 
-    delete [] _charBuffer;
-    _charBuffer = 0;
+    FreeCharBuffer();
 
 #if 0
     _textPool.Trace( "text" );
@@ -1813,14 +1987,9 @@ void XMLDocument::DeleteNode( XMLNode* node )	{
 
 XMLError XMLDocument::LoadFile( const char* filename )
 {
-    Clear();
-    FILE* fp = callfopen( filename, "rb" );
-    if ( !fp ) {
-        SetError( XML_ERROR_FILE_NOT_FOUND, filename, 0 );
-        return _errorID;
+    if ( ReadFile( filename ) == XML_NO_ERROR ) {
+        Parse();
     }
-    LoadFile( fp );
-    fclose( fp );
     return _errorID;
 }
 
@@ -1828,7 +1997,15 @@ XMLError XMLDocument::LoadFile( const char* filename )
 XMLError XMLDocument::LoadFile( FILE* fp )
 {
     Clear();
+    if ( ReadBuffer( fp ) == XML_NO_ERROR ) {
+        Parse();
+    }
+    return _errorID;
+}
+
 
+XMLError XMLDocument::ReadBuffer( FILE* fp )
+{
     fseek( fp, 0, SEEK_SET );
     if ( fgetc( fp ) == EOF && ferror( fp ) != 0 ) {
         SetError( XML_ERROR_FILE_READ_ERROR, 0, 0 );
@@ -1857,12 +2034,623 @@ XMLError XMLDocument::LoadFile( FILE* fp )
     }
 
     _charBuffer[size] = 0;
+    _charBufferSize = size;
+    return _errorID;
+}
+
+
+/*
+	Map a whole file into memory with a private (copy-on-write) mapping that
+	is followed by at least one zero byte, so the buffer is null terminated
+	just like the one LoadFile() reads. Returns 0 if the file can not be
+	mapped this way and should be read instead. 'size' is set to the file
+	length and 'mapLength' to the length to hand back to UnmapFileBuffer().
+*/
+static char* MapFileBuffer( const char* filename, size_t* size, size_t* mapLength, bool* notFound )
+{
+    *size = 0;
+    *mapLength = 0;
+    *notFound = false;
+#if defined(_WIN32)
+    HANDLE file = CreateFileA( filename, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                               FILE_FLAG_SEQUENTIAL_SCAN, 0 );
+    if ( file == INVALID_HANDLE_VALUE ) {
+        *notFound = true;
+        return 0;
+    }
+    LARGE_INTEGER fileSize;
+    SYSTEM_INFO info;
+    GetSystemInfo( &info );
+    if ( !GetFileSizeEx( file, &fileSize ) || fileSize.QuadPart == 0
+            || (unsigned long long)fileSize.QuadPart >= (size_t)(-1)
+            || fileSize.QuadPart % info.dwPageSize == 0 ) {
+        // no spare byte after the end of the file for the terminator
+        CloseHandle( file );
+        return 0;
+    }
+    HANDLE mapping = CreateFileMappingA( file, 0, PAGE_WRITECOPY, 0, 0, 0 );
+    CloseHandle( file );
+    if ( !mapping ) {
+        return 0;
+    }
+    // the view keeps the mapping object alive
+    char* buffer = static_cast<char*>( MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 ) );
+    CloseHandle( mapping );
+    if ( !buffer ) {
+        return 0;
+    }
+    *size = (size_t)fileSize.QuadPart;
+    *mapLength = *size + 1;
+    return buffer;
+#else
+    int fd = open( filename, O_RDONLY );
+    if ( fd < 0 ) {
+        *notFound = true;
+        return 0;
+    }
+    struct stat st;
+    if ( fstat( fd, &st ) != 0 || !S_ISREG( st.st_mode ) || st.st_size <= 0
+            || (unsigned long long)st.st_size >= (size_t)(-1) ) {
+        close( fd );
+        return 0;
+    }
+    const size_t fileSize = (size_t)st.st_size;
+    const size_t pageSize = (size_t)sysconf( _SC_PAGESIZE );
+    const size_t length = ( fileSize / pageSize + 1 ) * pageSize;
+
+    // Reserve zero filled pages one byte longer than the file, then map the
+    // file over the front of them. Whatever is past the end of the file is zero.
+    void* reserved = mmap( 0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if ( reserved == MAP_FAILED ) {
+        close( fd );
+        return 0;
+    }
+    void* mapped = mmap( reserved, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0 );
+    close( fd );
+    if ( mapped == MAP_FAILED ) {
+        munmap( reserved, length );
+        return 0;
+    }
+#if defined(MADV_SEQUENTIAL)
+    madvise( mapped, fileSize, MADV_SEQUENTIAL );
+#endif
+    *size = fileSize;
+    *mapLength = length;
+    return static_cast<char*>( mapped );
+#endif
+}
+
+
+static void UnmapFileBuffer( char* buffer, size_t mapLength )
+{
+#if defined(_WIN32)
+    (void)mapLength;
+    UnmapViewOfFile( buffer );
+#else
+    munmap( buffer, mapLength );
+#endif
+}
+
+
+void XMLDocument::FreeCharBuffer()
+{
+    if ( _charBufferMapped ) {
+        UnmapFileBuffer( _charBuffer, _charBufferMapped );
+    }
+    else {
+        delete [] _charBuffer;
+    }
+    _charBuffer = 0;
+    _charBufferMapped = 0;
+    _charBufferSize = 0;
+}
+
+
+XMLError XMLDocument::LoadFileMapped( const char* filename )
+{
+    if ( ReadFile( filename, true ) == XML_NO_ERROR ) {
+        Parse();
+    }
+    return _errorID;
+}
+
+
+XMLError XMLDocument::ReadFile( const char* filename, bool mapped )
+{
+    Clear();
+    if ( mapped ) {
+        size_t size = 0;
+        size_t mapLength = 0;
+        bool notFound = false;
+        char* buffer = MapFileBuffer( filename, &size, &mapLength, &notFound );
+        if ( buffer ) {
+            _charBuffer = buffer;
+            _charBufferMapped = mapLength;
+            _charBufferSize = size;
+            TIXMLASSERT( _charBuffer[size] == 0 );
+            return _errorID;
+        }
+        if ( notFound ) {
+            SetError( XML_ERROR_FILE_NOT_FOUND, filename, 0 );
+            return _errorID;
+        }
+        // empty files, pipes, etc. are handled (and reported) the usual way
+    }
+
+    FILE* fp = callfopen( filename, "rb" );
+    if ( !fp ) {
+        SetError( XML_ERROR_FILE_NOT_FOUND, filename, 0 );
+        return _errorID;
+    }
+    ReadBuffer( fp );
+    fclose( fp );
+    return _errorID;
+}
+
 
+XMLError XMLDocument::ParseLoaded()
+{
+    // nothing read, or parsed already
+    if ( Error() || !_charBuffer || !NoChildren() ) {
+        return _errorID;
+    }
     Parse();
     return _errorID;
 }
 
 
+void XMLDocument::GetMemPoolStats( MemPoolStats stats[MEMPOOL_COUNT] ) const
+{
+    _elementPool.GetStats( "element", &stats[0] );
+    _attributePool.GetStats( "attribute", &stats[1] );
+    _textPool.GetStats( "text", &stats[2] );
+    _commentPool.GetStats( "comment", &stats[3] );
+}
+
+/*
+	Snapshot layout. A header, then a record for each node (the document
+	first, then every node before its children, in document order), then
+	the attributes of the nodes in the same order, then the strings, each
+	null terminated. The string table starts with an empty string, which
+	empty values use. Everything is in the byte order of the machine that
+	saved it; another order does not match the version.
+*/
+static const char SNAPSHOT_MAGIC[8] = { 'T', 'X', '2', 'S', 'N', 'A', 'P', 0 };
+static const unsigned SNAPSHOT_VERSION = 1;
+static const unsigned SNAPSHOT_BOM = 0x01;
+
+enum {
+    SNAPSHOT_DOCUMENT,
+    SNAPSHOT_ELEMENT,
+    SNAPSHOT_TEXT,
+    SNAPSHOT_CDATA,
+    SNAPSHOT_COMMENT,
+    SNAPSHOT_DECLARATION,
+    SNAPSHOT_UNKNOWN
+};
+
+struct SnapshotHeader {
+    char                magic[8];
+    unsigned            version;
+    unsigned            flags;
+    unsigned long long  key;
+    unsigned long long  nodeCount;
+    unsigned long long  attributeCount;
+    unsigned long long  stringSize;
+};
+
+struct SnapshotNode {
+    unsigned char       type;
+    unsigned char       closingType;
+    unsigned short      unused;
+    unsigned            attributeCount;
+    unsigned            childCount;
+    unsigned            valueLength;
+    unsigned long long  value;
+};
+
+struct SnapshotAttribute {
+    unsigned long long  name;
+    unsigned long long  value;
+    unsigned            nameLength;
+    unsigned            valueLength;
+};
+
+
+/*
+	Writes a document as a snapshot. The nodes are visited once for each
+	part of the file, and the strings are given their places in the same
+	order every time, so each part can be written straight to the file.
+*/
+class SnapshotWriter
+{
+public:
+    enum Pass { COUNT, NODES, ATTRIBUTES, STRINGS };
+
+    SnapshotWriter( FILE* fp ) : _fp( fp ), _pass( COUNT ), _nodeCount( 0 ), _attributeCount( 0 ),
+        _stringSize( 0 ), _tooBig( false ) {}
+
+    void Run( Pass pass, const XMLDocument* doc ) {
+        _pass = pass;
+        _stringSize = 1;
+        if ( pass == STRINGS ) {
+            Write( "", 1 );
+        }
+        Visit( doc );
+    }
+
+    unsigned long long NodeCount() const		{ return _nodeCount; }
+    unsigned long long AttributeCount() const	{ return _attributeCount; }
+    unsigned long long StringSize() const		{ return _stringSize; }
+    bool TooBig() const							{ return _tooBig; }
+
+    void Write( const void* p, size_t n ) {
+        fwrite( p, 1, n, _fp );
+    }
+
+private:
+    void Visit( const XMLNode* node );
+
+    // where the string goes in the string table
+    unsigned long long Place( const char* str, unsigned* length ) {
+        const size_t len = str ? strlen( str ) : 0;
+        *length = (unsigned)len;
+        if ( len == 0 ) {
+            return 0;
+        }
+        if ( len != *length ) {
+            _tooBig = true;
+        }
+        if ( _pass == STRINGS ) {
+            Write( str, len+1 );
+        }
+        const unsigned long long offset = _stringSize;
+        _stringSize += len+1;
+        return offset;
+    }
+
+    FILE*               _fp;
+    Pass                _pass;
+    unsigned long long  _nodeCount;
+    unsigned long long  _attributeCount;
+    unsigned long long  _stringSize;
+    bool                _tooBig;
+};
+
+
+void SnapshotWriter::Visit( const XMLNode* node )
+{
+    SnapshotNode record;
+    memset( &record, 0, sizeof( record ) );
+    const XMLElement* element = node->ToElement();
+    if ( node->ToDocument() ) {
+        record.type = SNAPSHOT_DOCUMENT;
+    }
+    else if ( element ) {
+        record.type = SNAPSHOT_ELEMENT;
+        record.closingType = (unsigned char)element->ClosingType();
+    }
+    else if ( node->ToText() ) {
+        record.type = ( node->ToText()->CData() ? SNAPSHOT_CDATA : SNAPSHOT_TEXT );
+    }
+    else if ( node->ToComment() ) {
+        record.type = SNAPSHOT_COMMENT;
+    }
+    else if ( node->ToDeclaration() ) {
+        record.type = SNAPSHOT_DECLARATION;
+    }
+    else {
+        record.type = SNAPSHOT_UNKNOWN;
+    }
+    record.value = Place( node->ToDocument() ? 0 : node->Value(), &record.valueLength );
+
+    unsigned long long attributeCount = 0;
+    for ( const XMLAttribute* attrib = element ? element->FirstAttribute() : 0; attrib; attrib = attrib->Next() ) {
+        SnapshotAttribute attribRecord;
+        attribRecord.name = Place( attrib->Name(), &attribRecord.nameLength );
+        attribRecord.value = Place( attrib->Value(), &attribRecord.valueLength );
+        if ( _pass == ATTRIBUTES ) {
+            Write( &attribRecord, sizeof( attribRecord ) );
+        }
+        ++attributeCount;
+    }
+    unsigned long long childCount = 0;
+    for ( const XMLNode* child = node->FirstChild(); child; child = child->NextSibling() ) {
+        ++childCount;
+    }
+    record.attributeCount = (unsigned)attributeCount;
+    record.childCount = (unsigned)childCount;
+
+    if ( _pass == COUNT ) {
+        ++_nodeCount;
+        _attributeCount += attributeCount;
+        if ( record.attributeCount != attributeCount || record.childCount != childCount ) {
+            _tooBig = true;
+        }
+    }
+    else if ( _pass == NODES ) {
+        Write( &record, sizeof( record ) );
+    }
+
+    for ( const XMLNode* child = node->FirstChild(); child; child = child->NextSibling() ) {
+        Visit( child );
+    }
+}
+
+
+// Write the snapshot of 'doc' counted by 'writer' to 'fp'.
+static XMLError WriteSnapshot( const XMLDocument* doc, const SnapshotWriter& writer, FILE* fp, unsigned long long key )
+{
+    SnapshotHeader header;
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.magic, SNAPSHOT_MAGIC, sizeof( header.magic ) );
+    header.version = SNAPSHOT_VERSION;
+    header.flags = ( doc->HasBOM() ? SNAPSHOT_BOM : 0 );
+    header.key = key;
+    header.nodeCount = writer.NodeCount();
+    header.attributeCount = writer.AttributeCount();
+    header.stringSize = writer.StringSize();
+
+    SnapshotWriter fileWriter( fp );
+    fileWriter.Write( &header, sizeof( header ) );
+    fileWriter.Run( SnapshotWriter::NODES, doc );
+    fileWriter.Run( SnapshotWriter::ATTRIBUTES, doc );
+    fileWriter.Run( SnapshotWriter::STRINGS, doc );
+    return ( ferror( fp ) != 0 ) ? XML_ERROR_FILE_WRITE_ERROR : XML_NO_ERROR;
+}
+
+
+XMLError XMLDocument::SaveSnapshot( const char* filename, unsigned long long key )
+{
+    SnapshotWriter writer( 0 );
+    writer.Run( SnapshotWriter::COUNT, this );
+    if ( writer.TooBig() ) {
+        return XML_ERROR_SNAPSHOT_TOO_BIG;
+    }
+
+    FILE* fp = callfopen( filename, "wb" );
+    if ( !fp ) {
+        return XML_ERROR_FILE_COULD_NOT_BE_OPENED;
+    }
+
+    // a snapshot that could not be written completely is no use to anyone
+    XMLError error = WriteSnapshot( this, writer, fp, key );
+    if ( fclose( fp ) != 0 && error == XML_NO_ERROR ) {
+        error = XML_ERROR_FILE_WRITE_ERROR;
+    }
+    if ( error != XML_NO_ERROR ) {
+        remove( filename );
+    }
+    return error;
+}
+
+
+XMLError XMLDocument::SaveSnapshot( FILE* fp, unsigned long long key )
+{
+    SnapshotWriter writer( 0 );
+    writer.Run( SnapshotWriter::COUNT, this );
+    if ( writer.TooBig() ) {
+        return XML_ERROR_SNAPSHOT_TOO_BIG;
+    }
+    return WriteSnapshot( this, writer, fp, key );
+}
+
+
+XMLError XMLDocument::LoadSnapshot( const char* filename, unsigned long long* key )
+{
+    Clear();
+    size_t size = 0;
+    size_t mapLength = 0;
+    bool notFound = false;
+    char* buffer = MapFileBuffer( filename, &size, &mapLength, &notFound );
+    if ( buffer ) {
+        _charBuffer = buffer;
+        _charBufferMapped = mapLength;
+    }
+    else {
+        if ( notFound ) {
+            SetError( XML_ERROR_FILE_NOT_FOUND, filename, 0 );
+            return _errorID;
+        }
+        // could not be mapped, so read it instead
+        FILE* fp = callfopen( filename, "rb" );
+        if ( !fp ) {
+            SetError( XML_ERROR_FILE_NOT_FOUND, filename, 0 );
+            return _errorID;
+        }
+        fseek( fp, 0, SEEK_END );
+        const long filelength = ftell( fp );
+        fseek( fp, 0, SEEK_SET );
+        if ( filelength <= 0 ) {
+            fclose( fp );
+            SetError( XML_ERROR_FILE_READ_ERROR, filename, 0 );
+            return _errorID;
+        }
+        size = filelength;
+        _charBuffer = new char[size+1];
+        const size_t read = fread( _charBuffer, 1, size, fp );
+        fclose( fp );
+        if ( read != size ) {
+            SetError( XML_ERROR_FILE_READ_ERROR, filename, 0 );
+            return _errorID;
+        }
+        _charBuffer[size] = 0;
+    }
+    // the strings are not where they were in the XML file, so TextOffset() is always -1
+    _charBufferSize = 0;
+
+    if ( !LinkSnapshot( size ) ) {
+        DeleteChildren();
+        _elementPool.Clear();
+        _attributePool.Clear();
+        _textPool.Clear();
+        _commentPool.Clear();
+        SetError( XML_ERROR_FILE_READ_ERROR, filename, 0 );
+        return _errorID;
+    }
+    if ( key ) {
+        *key = reinterpret_cast<const SnapshotHeader*>( _charBuffer )->key;
+    }
+    return _errorID;
+}
+
+
+bool XMLDocument::IsSnapshot( const char* filename, unsigned long long* key )
+{
+    FILE* fp = callfopen( filename, "rb" );
+    if ( !fp ) {
+        return false;
+    }
+    SnapshotHeader header;
+    const bool read = ( fread( &header, 1, sizeof( header ), fp ) == sizeof( header ) );
+    fclose( fp );
+    if ( !read || memcmp( header.magic, SNAPSHOT_MAGIC, sizeof( header.magic ) ) != 0 || header.version != SNAPSHOT_VERSION ) {
+        return false;
+    }
+    if ( key ) {
+        *key = header.key;
+    }
+    return true;
+}
+
+
+/*
+	Make the nodes and attributes of the snapshot in _charBuffer, pointing
+	at the strings where they are. Only the node and attribute records are
+	read; the strings are not touched until they are used. Returns false if
+	the records do not fit together.
+*/
+bool XMLDocument::LinkSnapshot( size_t size )
+{
+    if ( size < sizeof( SnapshotHeader ) ) {
+        return false;
+    }
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>( _charBuffer );
+    if ( memcmp( header->magic, SNAPSHOT_MAGIC, sizeof( header->magic ) ) != 0 || header->version != SNAPSHOT_VERSION ) {
+        return false;
+    }
+
+    // the parts have to fill the file exactly (checked so that no sum can overflow)
+    const unsigned long long rest = size - sizeof( SnapshotHeader );
+    if ( header->nodeCount == 0 || header->nodeCount > rest / sizeof( SnapshotNode )
+            || header->attributeCount > rest / sizeof( SnapshotAttribute )
+            || header->stringSize == 0 || header->stringSize > rest
+            || header->nodeCount * sizeof( SnapshotNode ) + header->attributeCount * sizeof( SnapshotAttribute )
+                + header->stringSize != rest ) {
+        return false;
+    }
+    const SnapshotNode* nodes = reinterpret_cast<const SnapshotNode*>( _charBuffer + sizeof( SnapshotHeader ) );
+    const SnapshotAttribute* attribs = reinterpret_cast<const SnapshotAttribute*>( nodes + header->nodeCount );
+    char* strings = reinterpret_cast<char*>( const_cast<SnapshotAttribute*>( attribs + header->attributeCount ) );
+    const unsigned long long stringSize = header->stringSize;
+    // a string that runs past its length still stops at the end of the table
+    if ( strings[0] != 0 || strings[stringSize-1] != 0 ) {
+        return false;
+    }
+    if ( nodes[0].type != SNAPSHOT_DOCUMENT || nodes[0].attributeCount != 0 ) {
+        return false;
+    }
+    _writeBOM = ( header->flags & SNAPSHOT_BOM ) != 0;
+
+    // the nodes still waiting for children, and how many each still has to get
+    DynArray< XMLNode*, 32 > parents;
+    DynArray< unsigned, 32 > waiting;
+    if ( nodes[0].childCount > 0 ) {
+        parents.Push( this );
+        waiting.Push( nodes[0].childCount );
+    }
+
+    unsigned long long nextAttribute = 0;
+    for ( unsigned long long i = 1; i < header->nodeCount; ++i ) {
+        const SnapshotNode& record = nodes[i];
+        if ( parents.Empty() || record.value >= stringSize || record.valueLength >= stringSize - record.value ) {
+            return false;
+        }
+
+        XMLNode* node = 0;
+        XMLElement* element = 0;
+        switch ( record.type ) {
+            case SNAPSHOT_ELEMENT:
+                element = new (_elementPool.Alloc()) XMLElement( this );
+                element->_closingType = record.closingType;
+                node = element;
+                node->_memPool = &_elementPool;
+                break;
+            case SNAPSHOT_TEXT:
+            case SNAPSHOT_CDATA:
+                {
+                    XMLText* text = new (_textPool.Alloc()) XMLText( this );
+                    text->SetCData( record.type == SNAPSHOT_CDATA );
+                    node = text;
+                    node->_memPool = &_textPool;
+                }
+                break;
+            case SNAPSHOT_COMMENT:
+                node = new (_commentPool.Alloc()) XMLComment( this );
+                node->_memPool = &_commentPool;
+                break;
+            case SNAPSHOT_DECLARATION:
+                node = new (_commentPool.Alloc()) XMLDeclaration( this );
+                node->_memPool = &_commentPool;
+                break;
+            case SNAPSHOT_UNKNOWN:
+                node = new (_commentPool.Alloc()) XMLUnknown( this );
+                node->_memPool = &_commentPool;
+                break;
+            default:
+                return false;
+        }
+        node->_value.SetProcessed( strings + record.value, strings + record.value + record.valueLength );
+        if ( element && _atoms ) {
+            element->_nameAtom = _atoms->Intern( strings + record.value, (int)record.valueLength );
+        }
+        parents[parents.Size()-1]->InsertEndChild( node );
+        if ( --waiting[waiting.Size()-1] == 0 ) {
+            parents.Pop();
+            waiting.Pop();
+        }
+
+        if ( record.attributeCount > 0 ) {
+            if ( !element || record.attributeCount > header->attributeCount - nextAttribute ) {
+                return false;
+            }
+            XMLAttribute* prevAttribute = 0;
+            for ( unsigned k = 0; k < record.attributeCount; ++k ) {
+                const SnapshotAttribute& attribRecord = attribs[nextAttribute++];
+                if ( attribRecord.name >= stringSize || attribRecord.nameLength >= stringSize - attribRecord.name
+                        || attribRecord.value >= stringSize || attribRecord.valueLength >= stringSize - attribRecord.value ) {
+                    return false;
+                }
+                XMLAttribute* attrib = new (_attributePool.Alloc() ) XMLAttribute();
+                attrib->_memPool = &_attributePool;
+                attrib->_memPool->SetTracked();
+                attrib->_name.SetProcessed( strings + attribRecord.name, strings + attribRecord.name + attribRecord.nameLength );
+                if ( _atoms ) {
+                    attrib->_nameAtom = _atoms->Intern( strings + attribRecord.name, (int)attribRecord.nameLength );
+                }
+                attrib->_value.SetProcessed( strings + attribRecord.value, strings + attribRecord.value + attribRecord.valueLength );
+                if ( prevAttribute ) {
+                    prevAttribute->_next = attrib;
+                }
+                else {
+                    element->_rootAttribute = attrib;
+                }
+                prevAttribute = attrib;
+            }
+        }
+
+        if ( record.childCount > 0 ) {
+            if ( !element ) {
+                return false;
+            }
+            parents.Push( node );
+            waiting.Push( record.childCount );
+        }
+    }
+    return parents.Empty() && nextAttribute == header->attributeCount;
+}
+
+
 XMLError XMLDocument::SaveFile( const char* filename, bool compact )
 {
     FILE* fp = callfopen( filename, "w" );
@@ -1898,6 +2686,7 @@ XMLError XMLDocument::Parse( const char* p, size_t len )
     _charBuffer = new char[ len+1 ];
     memcpy( _charBuffer, p, len );
     _charBuffer[len] = 0;
+    _charBufferSize = len;
 
     Parse();
     if ( Error() ) {
@@ -136,6 +136,8 @@ class XMLText;
 class XMLDeclaration;
 class XMLUnknown;
 class XMLPrinter;
+class XMLAtomTable;
+struct XMLAtom;
 
 /*
 	A class that wraps strings. Normally stores the start and end
@@ -180,10 +182,19 @@ public:
         _start = const_cast<char*>(str);
     }
 
+    // A string that is already null terminated and processed, and
+    // lives as long as the document (such as one in a snapshot).
+    void SetProcessed( char* start, char* end ) {
+        Reset();
+        _start = start;
+        _end = end;
+    }
+
     void SetStr( const char* str, int flags=0 );
 
     char* ParseText( char* in, const char* endTag, int strFlags );
-    char* ParseName( char* in );
+    // If 'atoms' is not null the name is interned in it and its atoms set in 'atom'.
+    char* ParseName( char* in, XMLAtomTable* atoms=0, XMLAtom* atom=0 );
 
     void TransferTo( StrPair* other );
 
@@ -318,6 +329,23 @@ private:
 };
 
 
+/*
+	The counts of one memory pool, from MemPoolT::GetStats().
+*/
+struct MemPoolStats
+{
+    const char* name;       // the kind of node the pool holds
+    int itemSize;           // bytes in one item
+    int current;            // items in use now
+    int watermark;          // most items in use at one time
+    int allocs;             // items allocated since the pool was cleared
+    int blocks;             // blocks allocated, each holding blockItems items
+    int blockItems;
+};
+
+enum { MEMPOOL_COUNT = 4 };
+
+
 /*
 	Parent virtual class of a pool for fast allocation
 	and deallocation of objects.
@@ -404,6 +432,15 @@ public:
         chunk->next = _root;
         _root = chunk;
     }
+    void GetStats( const char* name, MemPoolStats* stats ) const {
+        stats->name = name;
+        stats->itemSize = SIZE;
+        stats->current = _currentAllocs;
+        stats->watermark = _maxAllocs;
+        stats->allocs = _nAllocs;
+        stats->blocks = _blockPtrs.Size();
+        stats->blockItems = COUNT;
+    }
     void Trace( const char* name ) {
         printf( "Mempool %s watermark=%d [%dk] current=%d size=%d nAlloc=%d blocks=%d\n",
                 name, _maxAllocs, _maxAllocs*SIZE/1024, _currentAllocs, SIZE, _nAllocs, _blockPtrs.Size() );
@@ -449,6 +486,79 @@ private:
 };
 
 
+/*
+	The atoms of a name interned in an XMLAtomTable. Names that are the
+	same have the same 'id', and names that differ only in the case of
+	ASCII letters have the same 'folded'. Both are 0 if the name was not
+	interned. Atoms from different tables must not be compared.
+*/
+struct XMLAtom
+{
+    XMLAtom() : id( 0 ), folded( 0 ) {}
+
+    int id;
+    int folded;     // the id of the name in lower case
+};
+
+
+/*
+	A table of the names of elements and attributes. A few hundred names
+	are repeated over and over in a large document, so when a document has
+	a table (see XMLDocument::SetAtomTable()) each name is interned as it
+	is parsed, and two names can be compared by their atoms instead of by
+	their characters.
+
+	The table may be shared by several documents so that their atoms can
+	be compared with each other. Interning is not locked: the documents
+	sharing a table must be parsed one at a time. The atoms are only
+	read once the documents are parsed, so that may be done from any
+	number of threads.
+*/
+class TINYXML2_LIB XMLAtomTable
+{
+public:
+    XMLAtomTable();
+    ~XMLAtomTable();
+
+    /// Intern the 'length' characters of 'name' (which need not be null terminated.)
+    XMLAtom Intern( const char* name, int length );
+
+    /// The number of names in the table, counting the lower case ones added for 'folded'.
+    int Count() const {
+        return _entries.Size();
+    }
+
+    /// Remove every name. Atoms handed out before must no longer be compared.
+    void Clear();
+
+private:
+    XMLAtomTable( const XMLAtomTable& );	// not supported
+    void operator=( const XMLAtomTable& );	// not supported
+
+    struct Entry {
+        unsigned hash;
+        int      offset;    // of the characters in _chars
+        int      length;
+        int      folded;
+    };
+
+    // The id of the name, 0 if it is not in the table. With 'fold' the
+    // name is looked up as if it were in lower case.
+    int Find( const char* name, int length, unsigned hash, bool fold ) const;
+    int Add( const char* name, int length, unsigned hash, bool fold, int folded );
+    void Grow();
+
+    static char Lower( char c ) {
+        return ( c >= 'A' && c <= 'Z' ) ? (char)( c - 'A' + 'a' ) : c;
+    }
+
+    DynArray< Entry, 64 >  _entries;   // entry id-1
+    DynArray< char, 1024 > _chars;
+    int*                   _slots;     // open addressed, each an id or 0
+    int                    _slotCount; // a power of 2
+};
+
+
 
 /**
 	Implements the interface to the "Visitor pattern" (see the Accept() method.)
@@ -533,6 +643,8 @@ enum XMLError {
     XML_ERROR_PARSING,
     XML_CAN_NOT_CONVERT_TEXT,
     XML_NO_TEXT_NODE,
+    XML_ERROR_FILE_WRITE_ERROR,
+    XML_ERROR_SNAPSHOT_TOO_BIG,
 
 	XML_ERROR_COUNT
 };
@@ -887,6 +999,20 @@ public:
     */
     virtual bool Accept( XMLVisitor* visitor ) const = 0;
 
+    /**
+    	Set user data into the XMLNode. TinyXML-2 in
+    	no way processes or interprets user data.
+    	It is initially 0.
+    */
+    void SetUserData(void* userData)	{ _userData = userData; }
+
+    /**
+    	Get user data set into the XMLNode. TinyXML-2 in
+    	no way processes or interprets user data.
+    	It is initially 0.
+    */
+    void* GetUserData() const			{ return _userData; }
+
     // internal
     virtual char* ParseDeep( char*, StrPair* );
 
@@ -904,6 +1030,8 @@ protected:
     XMLNode*		_prev;
     XMLNode*		_next;
 
+    void*			_userData;
+
 private:
     MemPool*		_memPool;
     void Unlink( XMLNode* child );
@@ -1076,6 +1204,7 @@ private:
 class TINYXML2_LIB XMLAttribute
 {
     friend class XMLElement;
+    friend class XMLDocument;
 public:
     /// The name of the attribute.
     const char* Name() const;
@@ -1088,6 +1217,11 @@ public:
         return _next;
     }
 
+    /// The atoms of the name, if it was interned in the atom table of the document when parsed.
+    const XMLAtom& NameAtom() const {
+        return _nameAtom;
+    }
+
     /** IntValue interprets the attribute as an integer, and returns the value.
         If the value isn't an integer, 0 will be returned. There is no error checking;
     	use QueryIntValue() if you need error checking.
@@ -1159,10 +1293,11 @@ private:
     void operator=( const XMLAttribute& );	// not supported
     void SetName( const char* name );
 
-    char* ParseDeep( char* p, bool processEntities );
+    char* ParseDeep( char* p, bool processEntities, XMLAtomTable* atoms );
 
     mutable StrPair _name;
     mutable StrPair _value;
+    XMLAtom         _nameAtom;
     XMLAttribute*   _next;
     MemPool*        _memPool;
 };
@@ -1175,6 +1310,7 @@ private:
 class TINYXML2_LIB XMLElement : public XMLNode
 {
     friend class XMLBase;
+    friend class XMLNode;
     friend class XMLDocument;
 public:
     /// Get the name of an element (which is the Value() of the node.)
@@ -1185,6 +1321,10 @@ public:
     void SetName( const char* str, bool staticMem=false )	{
         SetValue( str, staticMem );
     }
+    /// The atoms of the name, if it was interned in the atom table of the document when parsed.
+    const XMLAtom& NameAtom() const {
+        return _nameAtom;
+    }
 
     virtual XMLElement* ToElement()				{
         return this;
@@ -1529,6 +1669,7 @@ private:
 
     enum { BUF_SIZE = 200 };
     int _closingType;
+    XMLAtom _nameAtom;
     // The attribute list is ordered; there is no 'lastAttribute'
     // because the list needs to be scanned for dupes before adding
     // a new attribute.
@@ -1594,6 +1735,88 @@ public:
     */
     XMLError LoadFile( FILE* );
 
+    /**
+    	Load an XML file from disk by mapping it into memory
+    	instead of copying it into a newly allocated buffer.
+    	The mapping is private (copy-on-write), so the in-place
+    	string processing done while parsing still works, and
+    	the pages that are never written stay shared with the
+    	operating system file cache. If the file can not be
+    	mapped, the normal LoadFile() path is used instead.
+
+    	Returns XML_NO_ERROR (0) on success, or
+    	an errorID.
+    */
+    XMLError LoadFileMapped( const char* filename );
+
+    /**
+    	Read an XML file into the document without parsing it,
+    	or with 'mapped' map it as LoadFileMapped() does. Call
+    	ParseLoaded() next. LoadFile() does both steps; doing
+    	them one at a time lets the caller time them apart.
+
+    	Returns XML_NO_ERROR (0) on success, or
+    	an errorID.
+    */
+    XMLError ReadFile( const char* filename, bool mapped = false );
+
+    /**
+    	Parse the file read by ReadFile().
+    	Returns XML_NO_ERROR (0) on success, or
+    	an errorID.
+    */
+    XMLError ParseLoaded();
+
+    /**
+    	Save the document as a snapshot: a binary file holding
+    	its nodes as a flat array, the attributes of each node
+    	and a table of the processed strings, so that
+    	LoadSnapshot() can map it into memory and link the nodes
+    	without parsing anything. 'key' is saved with it for the
+    	caller, for example to tell which version of the XML file
+    	the snapshot was made from.
+
+    	Returns XML_NO_ERROR (0) on success,
+    	XML_ERROR_SNAPSHOT_TOO_BIG if the document has more
+    	nodes or string bytes than a snapshot can hold,
+    	XML_ERROR_FILE_COULD_NOT_BE_OPENED or
+    	XML_ERROR_FILE_WRITE_ERROR. The document's own error
+    	state (Error(), ErrorID()) is not changed, so a document
+    	that loaded fine stays that way if its snapshot cannot
+    	be saved.
+    */
+    XMLError SaveSnapshot( const char* filename, unsigned long long key = 0 );
+
+    /**
+    	Save the document as a snapshot to an open file (see
+    	above), which is not closed. The caller is responsible
+    	for flushing and closing it, and for removing it if
+    	this returns an error.
+    */
+    XMLError SaveSnapshot( FILE* fp, unsigned long long key = 0 );
+
+    /**
+    	Load a document saved by SaveSnapshot(). The file is
+    	mapped into memory (or read if it can not be) and the
+    	names, values and text are used where they are in it.
+    	TextOffset() is -1 for all of them, since they are not
+    	where they were in the XML file. If 'key' is not null
+    	it is set to the key the snapshot was saved with.
+
+    	Returns XML_NO_ERROR (0) on success,
+    	XML_ERROR_FILE_READ_ERROR if the file is not a snapshot
+    	from this version of TinyXML-2 on this kind of machine,
+    	or another errorID.
+    */
+    XMLError LoadSnapshot( const char* filename, unsigned long long* key = 0 );
+
+    /**
+    	Returns true if the file is a snapshot LoadSnapshot()
+    	can load, and if 'key' is not null sets it to the key the
+    	snapshot was saved with. Only the start of the file is read.
+    */
+    static bool IsSnapshot( const char* filename, unsigned long long* key = 0 );
+
     /**
     	Save the XML file to disk.
     	Returns XML_NO_ERROR (0) on success, or
@@ -1617,6 +1840,19 @@ public:
         return _whitespace;
     }
 
+    /** Sets the table the names of elements and attributes are interned
+        in when the document is loaded, so that they can be compared by
+        XMLElement::NameAtom() and XMLAttribute::NameAtom(). The table is
+        not owned by the document and may be shared with other documents;
+        null (the default) interns nothing.
+    */
+    void SetAtomTable( XMLAtomTable* atoms ) {
+        _atoms = atoms;
+    }
+    XMLAtomTable* AtomTable() const {
+        return _atoms;
+    }
+
     /**
     	Returns true if this document has a leading Byte Order Mark of UTF8.
     */
@@ -1721,6 +1957,27 @@ public:
     }
     /// If there is an error, print it to stdout.
     void PrintError() const;
+
+    /**
+    	Fill 'stats' with the counts of the pools the element,
+    	attribute, text and comment nodes are allocated from, in
+    	that order: what MemPoolT::Trace() prints, as numbers.
+    */
+    void GetMemPoolStats( MemPoolStats stats[MEMPOOL_COUNT] ) const;
+
+    /**
+    	Where p is in the text the document was loaded from, as
+    	the number of bytes from the start, or -1 if p does not
+    	point into that text. Names, values and text point into
+    	it, so this is where they are in the file. (Text changed
+    	while parsing, such as entities, is moved up a little.)
+    */
+    long long TextOffset( const char* p ) const {
+        if ( !_charBuffer || p < _charBuffer || p >= _charBuffer + _charBufferSize ) {
+            return -1;
+        }
+        return p - _charBuffer;
+    }
     
     /// Clear the document, resetting it to the initial state.
     void Clear();
@@ -1746,6 +2003,9 @@ private:
     const char* _errorStr1;
     const char* _errorStr2;
     char*       _charBuffer;
+    size_t      _charBufferMapped;	// length of the mapping if _charBuffer is a mapped file, else 0
+    size_t      _charBufferSize;	// number of characters loaded into _charBuffer
+    XMLAtomTable* _atoms;		// not owned, may be null
 
     MemPoolT< sizeof(XMLElement) >	 _elementPool;
     MemPoolT< sizeof(XMLAttribute) > _attributePool;
@@ -1755,6 +2015,9 @@ private:
 	static const char* _errorNames[XML_ERROR_COUNT];
 
     void Parse();
+    XMLError ReadBuffer( FILE* fp );
+    void FreeCharBuffer();
+    bool LinkSnapshot( size_t size );
 };
 
 